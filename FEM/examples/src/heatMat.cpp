@@ -125,6 +125,8 @@ bool HeatMat<dim>::preMatVec(const VECType* in,VECType* out,double scale)
 
     for(unsigned int i=0;i<bdyIndex.size();i++)
         out[bdyIndex[i]]=0.0;
+
+    return true;
 }
 
 template <unsigned int dim>
@@ -136,6 +138,8 @@ bool HeatMat<dim>::postMatVec(const VECType* in,VECType* out,double scale) {
 
     for(unsigned int i=0;i<bdyIndex.size();i++)
         out[bdyIndex[i]]=0.0;
+
+    return true;
 }
 
 
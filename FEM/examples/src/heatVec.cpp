@@ -90,6 +90,8 @@ bool HeatVec<dim>::preComputeVec(const VECType* in,VECType* out, double scale)
 
     for(unsigned int i=0;i<bdyIndex.size();i++)
         out[bdyIndex[i]]=0.0;
+
+    return true;
 }
 
 template <unsigned int dim>
@@ -101,6 +103,8 @@ bool HeatVec<dim>::postComputeVec(const VECType* in,VECType* out, double scale)
 
     for(unsigned int i=0;i<bdyIndex.size();i++)
         out[bdyIndex[i]]=0.0;
+
+    return true;
 }
 
 
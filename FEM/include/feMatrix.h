@@ -191,6 +191,8 @@ void feMatrix<LeafT,dim>::matVec(const VECType *in, VECType *out, double scale)
 {
   using namespace std::placeholders;   // Convenience for std::bind().
 
+  DENDRO_PROF_SCOPE("feMatrix::matVec");
+
   // Shorter way to refer to our member DA.
   ot::DA<dim> * &m_oda = feMat<dim>::m_uiOctDA;
 
@@ -208,47 +210,31 @@ void feMatrix<LeafT,dim>::matVec(const VECType *in, VECType *out, double scale)
   preMatVec(in, inGhostedPtr + m_oda->getLocalNodeBegin(), scale);
   // TODO what is the return value supposed to represent?
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-  bench::t_ghostexchange.start();
-#endif
+  DENDRO_PROF_BEGIN("ghostExchange");
 
   // 2. Upstream->downstream ghost exchange.
   m_oda->template readFromGhostBegin<VECType>(inGhostedPtr, m_uiDof);
   m_oda->template readFromGhostEnd<VECType>(inGhostedPtr, m_uiDof);
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-  bench::t_ghostexchange.stop();
-#endif
+  DENDRO_PROF_END();
 
   // 3. Local matvec().
   const auto * tnCoords = m_oda->getTNCoords();
   std::function<void(const VECType *, VECType *, double *, double)> eleOp =
       std::bind(&feMatrix<LeafT,dim>::elementalMatVec, this, _1, _2, _3, _4);
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-  bench::t_matvec.start();
-#endif
   fem::matvec(inGhostedPtr, outGhostedPtr, tnCoords, m_oda->getTotalNodalSz(),
       *m_oda->getTreePartFront(), *m_oda->getTreePartBack(),
       eleOp, scale, m_oda->getReferenceElement());
   //TODO I think refel won't always be provided by oda.
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-  bench::t_matvec.stop();
-#endif
-
-
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-  bench::t_ghostexchange.start();
-#endif
+  DENDRO_PROF_BEGIN("ghostExchange");
 
   // 4. Downstream->Upstream ghost exchange.
   m_oda->template writeToGhostsBegin<VECType>(outGhostedPtr, m_uiDof);
   m_oda->template writeToGhostsEnd<VECType>(outGhostedPtr, m_uiDof);
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-  bench::t_ghostexchange.stop();
-#endif
+  DENDRO_PROF_END();
 
   // 5. Copy output data from ghosted buffer.
   m_oda->template ghostedNodalToNodalVec<VECType>(outGhostedPtr, out, true, m_uiDof);
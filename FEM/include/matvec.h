@@ -12,9 +12,14 @@
 
 #include "tsort.h"    // RankI, ChildI, LevI, RotI
 #include "nsort.h"    // TNPoint
+#include "profRegistry.h"
 
 #include<iostream>
 #include<functional>
+#include<vector>
+#ifdef DENDRO_KT_PROFILE
+#include<omp.h>
+#endif
 
 
 namespace fem
@@ -94,9 +99,8 @@ namespace fem
 
       LevI pLev = subtreeRoot.getLevel();
       const unsigned int numChildren=1u<<dim;
-      constexpr unsigned int rotOffset = 2*(1u<<dim);  // num columns in rotations[].
-      const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren]; // child_m = rot_perm[child_sfc]
-      const ChildI * const rot_inv =  &rotations[pRot*rotOffset + 1*numChildren]; // child_sfc = rot_inv[child_m]
+      const ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot); // child_m = rot_perm[child_sfc]
+      const ChildI * const rot_inv =  SFC_Tables<dim>::rotInv(pRot); // child_sfc = rot_inv[child_m]
 
       // 0. Check if this is a leaf element. If so, return true immediately.
       bool isLeaf = true;
@@ -217,6 +221,43 @@ namespace fem
 
 
 
+#ifdef DENDRO_KT_PROFILE
+    /**
+     * @brief : time spent in the passes of matvec_rec(), summed per level of the tree.
+     *          One matvec() visits every tree node, so these are reported once per matvec()
+     *          as the regions top_down, elemental and bottom_up, each traced once per level.
+     */
+    struct MatvecLevelTimes
+    {
+      std::vector<double> m_topDown, m_elemental, m_bottomUp;
+      std::vector<long long> m_nodes, m_leaves;
+
+      static MatvecLevelTimes & get() { static MatvecLevelTimes times; return times; }
+
+      void reset(unsigned int numLevels)
+      {
+        m_topDown.assign(numLevels, 0.0);
+        m_elemental.assign(numLevels, 0.0);
+        m_bottomUp.assign(numLevels, 0.0);
+        m_nodes.assign(numLevels, 0);
+        m_leaves.assign(numLevels, 0);
+      }
+
+      void report() const
+      {
+        for (unsigned int lev = 0; lev < m_nodes.size(); lev++)
+          if (m_nodes[lev] > 0)
+          {
+            DENDRO_PROF_ADD("top_down", m_topDown[lev], m_nodes[lev], lev);
+            DENDRO_PROF_ADD("bottom_up", m_bottomUp[lev], m_nodes[lev], lev);
+          }
+        for (unsigned int lev = 0; lev < m_leaves.size(); lev++)
+          if (m_leaves[lev] > 0)
+            DENDRO_PROF_ADD("elemental", m_elemental[lev], m_leaves[lev], lev);
+      }
+    };
+#endif
+
     /**
      * @brief : mesh-free matvec
      * @param [in] vecIn: input vector (local vector)
@@ -231,12 +272,22 @@ namespace fem
     template<typename T,typename TN, typename RE>
     void matvec(const T* vecIn, T* vecOut, const TN* coords, unsigned int sz, const TN &partFront, const TN &partBack, EleOpT<T> eleOp, double scale, const RE* refElement)
     {
+      DENDRO_PROF_SCOPE("matvec");
+
       // Initialize output vector to 0.
       std::fill(vecOut, vecOut + sz, 0);
 
+#ifdef DENDRO_KT_PROFILE
+      MatvecLevelTimes::get().reset(m_uiMaxDepth + 1);
+#endif
+
       // Top level of recursion.
       TN treeRoot;  // Default constructor constructs root cell.
       matvec_rec<T,TN,RE>(vecIn, vecOut, coords, treeRoot, 0, sz, partFront, partBack, eleOp, scale, refElement, nullptr, nullptr, nullptr, 0, true);
+
+#ifdef DENDRO_KT_PROFILE
+      MatvecLevelTimes::get().report();
+#endif
     }
 
     // Recursive implementation.
@@ -299,31 +350,28 @@ namespace fem
         }
 
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-        bench::t_topdown.start();
+#ifdef DENDRO_KT_PROFILE
+        MatvecLevelTimes &levelTimes = MatvecLevelTimes::get();
+        double tic = omp_get_wtime();
 #endif
 
         // For now, this may increase the size of coords_dup and vec_in_dup.
         // We can get the proper size for vec_out_contrib from the result.
         bool isLeaf = top_down<T,TN,dim>(coords, ibufs[pLev].coords_dup, vecIn, ibufs[pLev].vec_in_dup, sz, offset, counts, ibufs[pLev].smap, subtreeRoot, pRot);
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-        bench::t_topdown.stop();
+#ifdef DENDRO_KT_PROFILE
+        levelTimes.m_topDown[pLev] += omp_get_wtime() - tic;
+        levelTimes.m_nodes[pLev]++;
 #endif
 
         if(!isLeaf)
         {
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-          bench::t_treeinterior.start();
-#endif
-
             ibufs[pLev].vec_out_contrib.resize(ibufs[pLev].vec_in_dup.size());
             std::fill(ibufs[pLev].vec_out_contrib.begin(), ibufs[pLev].vec_out_contrib.end(), 0);
 
-            constexpr unsigned int rotOffset = 2*(1u<<dim);  // num columns in rotations[].
-            const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren]; // child_m = rot_perm[child_sfc]
-            const ChildI * const rot_inv =  &rotations[pRot*rotOffset + 1*numChildren]; // child_sfc = rot_inv[child_m]
-            const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+            const ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot); // child_m = rot_perm[child_sfc]
+            const ChildI * const rot_inv =  SFC_Tables<dim>::rotInv(pRot); // child_sfc = rot_inv[child_m]
+            const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
 
             // As descend subtrees in sfc order, check their intersection with the local partition:
             // Partially contained, disjointly contained, or disjointly uncontained.
@@ -361,15 +409,11 @@ namespace fem
                 childIsFirst = false;
             }
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-            bench::t_treeinterior.stop();
-#endif
-
         }else
         {
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-          bench::t_elemental.start();
+#ifdef DENDRO_KT_PROFILE
+            tic = omp_get_wtime();
 #endif
 
             /// // DEBUG print the leaft element.
@@ -521,21 +565,22 @@ namespace fem
                 }
             }
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-            bench::t_elemental.stop();
+#ifdef DENDRO_KT_PROFILE
+            levelTimes.m_elemental[pLev] += omp_get_wtime() - tic;
+            levelTimes.m_leaves[pLev]++;
 #endif
 
         }
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-        bench::t_bottomup.start();
+#ifdef DENDRO_KT_PROFILE
+        tic = omp_get_wtime();
 #endif
 
         if (!isLeaf)
           bottom_up<T,TN,dim>(vecOut, ibufs[pLev].vec_out_contrib, sz, offset, ibufs[pLev].smap);
 
-#ifdef DENDRO_KT_MATVEC_BENCH_H
-        bench::t_bottomup.stop();
+#ifdef DENDRO_KT_PROFILE
+        levelTimes.m_bottomUp[pLev] += omp_get_wtime() - tic;
 #endif
 
         delete [] offset;
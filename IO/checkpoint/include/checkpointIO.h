@@ -0,0 +1,198 @@
+/**
+ * @file:checkpointIO.h
+ * @brief: Collective checkpoint/restart of distributed trees and DA nodal vectors.
+ *
+ * @description A checkpoint is one shared file, written and read by all procs
+ *              of a communicator with MPI-IO. The file is a sequence of sections,
+ *              each a CheckpointHeader followed by fixed-size records:
+ *                - tree section:   coords[dim] (T), level (unsigned int).
+ *                - nodal section:  coords[dim], level (unsigned int), dof values (V).
+ *              Each proc writes its records with MPI_File_write_at_all() at the
+ *              offset given by a prefix sum of the local counts. Sections must be
+ *              read back in the order they were written.
+ *
+ *              Nothing in the file depends on the number of procs that wrote it.
+ *              On restart each proc reads an even range of the records: a tree
+ *              written in SFC order is then repartitioned with distTreeSort().
+ *              Nodal values are matched to the owned nodes of the (new) DA by
+ *              coordinates and level (hanging nodes share coordinates with the
+ *              nodes of the finer side), so the tree must be the same but the DA
+ *              may have been built on a different number of procs.
+ *
+ *              Writes can be asynchronous (CheckpointFile::setMaxPending()): the
+ *              section is then staged in a buffer owned by the file, written with
+ *              MPI_File_iwrite_at_all(), and the writer returns without waiting for
+ *              the filesystem. The number of staged sections is bounded; a writer
+ *              that would exceed the bound waits for the oldest ones to complete.
+ *
+ * @note: Replaces the per-rank fwrite() files of IO/vtk/include/checkPoint.h (Dendro5 ot::Mesh).
+ */
+
+#ifndef DENDRO_KT_CHECKPOINT_IO_H
+#define DENDRO_KT_CHECKPOINT_IO_H
+
+#include "treeNode.h"
+#include "tsort.h"
+#include "oda.h"
+#include "parUtils.h"
+
+#include <mpi.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+namespace io
+{
+namespace checkpoint
+{
+    enum SectionKind { SECTION_TREE = 1, SECTION_NODAL_VEC = 2 };
+
+    /**@brief: fixed-size (64 byte) header in front of every section of a checkpoint file. */
+    struct CheckpointHeader
+    {
+      char m_magic[8];             // "DKTCKPT"
+      uint32_t m_kind;             // SectionKind
+      uint32_t m_dim;
+      uint32_t m_coordBytes;       // sizeof coordinate type
+      uint32_t m_valueBytes;       // sizeof value type (0 for trees)
+      uint32_t m_dof;              // values per record (0 for trees)
+      uint32_t m_recordBytes;
+      uint64_t m_numRecords;       // global
+      char m_name[24];             // user label, zero-padded
+    };
+
+    /**
+     * @brief: a checkpoint file opened collectively on comm, for writing or for reading.
+     * @note: all member functions and the section read/write functions are collective on comm.
+     *        Functions return 0 on success; errors are reported on the first proc of comm.
+     */
+    class CheckpointFile
+    {
+      public:
+        enum Mode { WRITE, READ };
+
+        CheckpointFile(const char *fName, Mode mode, MPI_Comm comm);
+
+        /**@brief: close()s the file, unless MPI is finalized already; then pending writes are lost. */
+        ~CheckpointFile();
+
+        bool isOpen() const { return m_isOpen; }
+        Mode getMode() const { return m_mode; }
+        MPI_Comm getComm() const { return m_comm; }
+
+        /**@brief: completes the pending writes (see flush()) and closes the file. */
+        void close();
+
+        /**
+         * @brief: bounds the number of sections in flight.
+         * @param [in] maxPending: 0 (default) writes synchronously. Otherwise up to maxPending
+         *             sections are staged and written in the background; writing one more
+         *             first waits for the oldest to complete (back-pressure).
+         * @note: write errors of staged sections are returned by flush().
+         */
+        void setMaxPending(unsigned int maxPending) { m_maxPending = maxPending; }
+        unsigned int getMaxPending() const { return m_maxPending; }
+        size_t getNumPending() const { return m_pending.size(); }
+
+        /**@brief: writes a section of numLocal records; offsets from a prefix sum of numLocal over comm. */
+        int writeSection(CheckpointHeader header, const char *localRecords, uint64_t numLocal);
+
+        /**@brief: as above, but the records are staged without a copy if the writes are asynchronous. */
+        int writeSection(CheckpointHeader header, std::vector<char> &&localRecords, uint64_t numLocal);
+
+        /**@brief: waits for all staged sections. Returns nonzero if any of them failed on any proc. */
+        int flush();
+
+        /**@brief: releases the staged sections that have been written, without blocking. */
+        void progress();
+
+        /**
+         * @brief: reads the next section. Proc r of p gets records [N*r/p, N*(r+1)/p).
+         * @param [in] expected: header fields the section must match (all except m_numRecords and m_name).
+         */
+        int readSection(const CheckpointHeader &expected, std::vector<char> &localRecords, uint64_t &numLocal, CheckpointHeader *found = NULL);
+
+      private:
+        /**@brief: a staged section; the requests refer to m_header (first proc) and m_records. */
+        struct PendingWrite
+        {
+          CheckpointHeader m_header;
+          std::vector<char> m_records;
+          MPI_Request m_requests[2];
+        };
+
+        /**@brief: Exscan and sum of numLocal over comm. */
+        void sectionRange(uint64_t numLocal, uint64_t &globBegin, uint64_t &globTotal) const;
+
+        void waitOldest();
+
+        MPI_File m_file;
+        MPI_Comm m_comm;
+        Mode m_mode;
+        bool m_isOpen;
+        MPI_Offset m_offset;       // Start of the next section, same on all procs.
+        unsigned int m_maxPending;
+        std::deque<PendingWrite> m_pending;    // Oldest first; push_back() keeps the buffers in place.
+        int m_pendingFailed;       // Local, since the last flush().
+    };
+
+    /**@brief: fills magic, kind and the record layout of a header; name may be NULL. */
+    CheckpointHeader makeHeader(SectionKind kind, unsigned int dim, unsigned int coordBytes,
+                                unsigned int valueBytes, unsigned int dof, const char *name);
+
+
+    namespace detail
+    {
+      /**@brief: sorts item indices by dest; destProc (ascending) and destCnt list the destinations and their item counts. */
+      void groupByDest(const std::vector<int> &dest, std::vector<size_t> &order,
+                       std::vector<int> &destProc, std::vector<int> &destCnt);
+
+      /**@brief: sparse Alltoallv of bytes. sendBuf is grouped by sendProc (ascending); recvProc (ascending),
+       *         recvCnt and recvBuf are resized. Uses tags tag and tag+1. */
+      void alltoallvBytes(const std::vector<char> &sendBuf, const std::vector<int> &sendProc, const std::vector<int> &sendCnt,
+                          std::vector<char> &recvBuf, std::vector<int> &recvProc, std::vector<int> &recvCnt,
+                          int tag, MPI_Comm comm);
+
+      /**@brief: identifies a node across DAs: key[0..dim) are the coordinates, key[dim] the level. */
+      template <typename C, unsigned int dim>
+      void nodeKey(const ot::TreeNode<C,dim> &node, C *key);
+
+      /**@brief: rendezvous proc of the node with the given nodeKey(). */
+      template <typename C, unsigned int dim>
+      int rendezvousProc(const C *key, int npes);
+    }
+
+
+    /**@brief: writes the local part of a tree. Procs should hold consecutive SFC ranges. Asynchronous if the file is. */
+    template <typename T, unsigned int dim>
+    int writeTree(CheckpointFile &file, const ot::TreeNode<T,dim> *tree, size_t numLocal, const char *name = NULL);
+
+    /**@brief: reads a tree and partitions it with distTreeSort() over the comm of the file. */
+    template <typename T, unsigned int dim>
+    int readTree(CheckpointFile &file, std::vector<ot::TreeNode<T,dim>> &tree, double loadFlexibility = 0.3);
+
+    /**
+     * @brief: writes the owned nodes of a DA nodal vector, with their coordinates.
+     * @param [in] vec: nodal vector of da (interleaved dofs), ghosted or not.
+     * @note: the comm of the file should be the global comm of da; inactive procs write nothing.
+     *        If the writes of the file are asynchronous, returns once the owned nodes and their
+     *        values have been copied: vec may be modified right away.
+     */
+    template <unsigned int dim, typename V>
+    int writeNodalVec(CheckpointFile &file, const ot::DA<dim> &da, const V *vec, unsigned int dof, bool isGhosted = false, const char *name = NULL);
+
+    /**
+     * @brief: reads a nodal vector into the owned nodes of da, matching nodes by nodeKey().
+     * @description Records are sent to a rendezvous proc chosen by hashing the key,
+     *              where they are looked up by the owners of the nodes.
+     *              Returns nonzero if any owned node of da has no record in the file.
+     */
+    template <unsigned int dim, typename V>
+    int readNodalVec(CheckpointFile &file, const ot::DA<dim> &da, V *vec, unsigned int dof, bool isGhosted = false);
+
+}// end of namespace checkpoint
+}// end of namespace io
+
+#include "checkpointIO.tcc"
+
+#endif //DENDRO_KT_CHECKPOINT_IO_H
@@ -0,0 +1,252 @@
+/**
+ * @file:checkpointIO.tcc
+ * @brief: Collective checkpoint/restart of distributed trees and DA nodal vectors.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+#include <utility>
+
+namespace io
+{
+namespace checkpoint
+{
+    namespace detail
+    {
+      template <typename C, unsigned int dim>
+      int rendezvousProc(const C *key, int npes)
+      {
+        // FNV-1a over the coordinates and level, then a final avalanche
+        // so that neighbouring nodes land on different procs.
+        uint64_t h = 14695981039346656037ull;
+        for (unsigned int d = 0; d < dim + 1; d++)
+        {
+          h ^= (uint64_t) key[d];
+          h *= 1099511628211ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return (int) (h % (uint64_t) npes);
+      }
+
+      template <typename C, unsigned int dim>
+      void nodeKey(const ot::TreeNode<C,dim> &node, C *key)
+      {
+        for (unsigned int d = 0; d < dim; d++)
+          key[d] = node.getX(d);
+        key[dim] = node.getLevel();
+      }
+    }
+
+
+    //
+    // writeTree()
+    //
+    template <typename T, unsigned int dim>
+    int writeTree(CheckpointFile &file, const ot::TreeNode<T,dim> *tree, size_t numLocal, const char *name)
+    {
+      const CheckpointHeader header = makeHeader(SECTION_TREE, dim, sizeof(T), 0, 0, name);
+      const size_t coordBytes = dim * sizeof(T);
+
+      std::vector<char> records(numLocal * header.m_recordBytes);
+      for (size_t ii = 0; ii < numLocal; ii++)
+      {
+        char *rec = &records[ii * header.m_recordBytes];
+        T coords[dim];
+        for (unsigned int d = 0; d < dim; d++)
+          coords[d] = tree[ii].getX(d);
+        const unsigned int lev = tree[ii].getLevel();
+        memcpy(rec, coords, coordBytes);
+        memcpy(rec + coordBytes, &lev, sizeof(lev));
+      }
+
+      return file.writeSection(header, std::move(records), numLocal);
+    }
+
+
+    //
+    // readTree()
+    //
+    template <typename T, unsigned int dim>
+    int readTree(CheckpointFile &file, std::vector<ot::TreeNode<T,dim>> &tree, double loadFlexibility)
+    {
+      const CheckpointHeader expected = makeHeader(SECTION_TREE, dim, sizeof(T), 0, 0, NULL);
+      const size_t coordBytes = dim * sizeof(T);
+
+      tree.clear();
+      std::vector<char> records;
+      uint64_t numLocal;
+      int err = file.readSection(expected, records, numLocal);
+      if (err)
+        return err;
+
+      tree.reserve(numLocal);
+      for (uint64_t ii = 0; ii < numLocal; ii++)
+      {
+        const char *rec = &records[ii * expected.m_recordBytes];
+        std::array<T,dim> coords;
+        unsigned int lev;
+        memcpy(coords.data(), rec, coordBytes);
+        memcpy(&lev, rec + coordBytes, sizeof(lev));
+        tree.push_back(ot::TreeNode<T,dim>(coords, lev));
+      }
+
+      // The ranges are SFC-ordered if the writers held SFC-ordered partitions,
+      // but distTreeSort() also restores the order of any other tree.
+      ot::SFC_Tree<T,dim>::distTreeSort(tree, loadFlexibility, file.getComm());
+      return 0;
+    }
+
+
+    //
+    // writeNodalVec()
+    //
+    template <unsigned int dim, typename V>
+    int writeNodalVec(CheckpointFile &file, const ot::DA<dim> &da, const V *vec, unsigned int dof, bool isGhosted, const char *name)
+    {
+      using C = unsigned int;
+      const CheckpointHeader header = makeHeader(SECTION_NODAL_VEC, dim, sizeof(C), sizeof(V), dof, name);
+      const size_t keyBytes = (dim + 1) * sizeof(C);
+      const size_t valueBytes = dof * sizeof(V);
+
+      const size_t numLocal = da.getLocalNodalSz();
+      const ot::TreeNode<C,dim> *coords = (numLocal ? da.getTNCoords() + da.getLocalNodeBegin() : NULL);
+      const V *values = (isGhosted ? vec + dof * da.getLocalNodeBegin() : vec);
+
+      std::vector<char> records(numLocal * header.m_recordBytes);
+      for (size_t ii = 0; ii < numLocal; ii++)
+      {
+        char *rec = &records[ii * header.m_recordBytes];
+        C key[dim + 1];
+        detail::nodeKey(coords[ii], key);
+        memcpy(rec, key, keyBytes);
+        memcpy(rec + keyBytes, values + dof * ii, valueBytes);
+      }
+
+      return file.writeSection(header, std::move(records), numLocal);
+    }
+
+
+    //
+    // readNodalVec()
+    //
+    template <unsigned int dim, typename V>
+    int readNodalVec(CheckpointFile &file, const ot::DA<dim> &da, V *vec, unsigned int dof, bool isGhosted)
+    {
+      using C = unsigned int;
+      const CheckpointHeader expected = makeHeader(SECTION_NODAL_VEC, dim, sizeof(C), sizeof(V), dof, NULL);
+      const size_t keyBytes = (dim + 1) * sizeof(C);
+      const size_t valueBytes = dof * sizeof(V);
+      const size_t recordBytes = expected.m_recordBytes;
+
+      MPI_Comm comm = file.getComm();
+      int rank, npes;
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_size(comm, &npes);
+
+      std::vector<char> fileRecords;
+      uint64_t numFile;
+      int err = file.readSection(expected, fileRecords, numFile);
+      if (err)
+        return err;
+
+      // 1. Send the records we read to their rendezvous procs.
+      std::vector<int> recDest(numFile);
+      for (uint64_t ii = 0; ii < numFile; ii++)
+      {
+        C key[dim + 1];
+        memcpy(key, &fileRecords[ii * recordBytes], keyBytes);
+        recDest[ii] = detail::rendezvousProc<C,dim>(key, npes);
+      }
+      std::vector<size_t> recOrder;
+      std::vector<int> sendProc, sendCnt;
+      detail::groupByDest(recDest, recOrder, sendProc, sendCnt);
+
+      std::vector<char> sendBuf(fileRecords.size());
+      for (uint64_t jj = 0; jj < numFile; jj++)
+        memcpy(&sendBuf[jj * recordBytes], &fileRecords[recOrder[jj] * recordBytes], recordBytes);
+      for (int &cnt : sendCnt)
+        cnt *= recordBytes;
+      fileRecords.clear();
+
+      std::vector<char> rdvRecords;
+      std::vector<int> rdvProc, rdvCnt;
+      detail::alltoallvBytes(sendBuf, sendProc, sendCnt, rdvRecords, rdvProc, rdvCnt, 1, comm);
+
+      // 2. Send the coordinates of our owned nodes to the same rendezvous procs.
+      const size_t numOwned = da.getLocalNodalSz();
+      const ot::TreeNode<C,dim> *coords = (numOwned ? da.getTNCoords() + da.getLocalNodeBegin() : NULL);
+
+      std::vector<int> nodeDest(numOwned);
+      std::vector<C> ownedKeys(numOwned * (dim + 1));
+      for (size_t ii = 0; ii < numOwned; ii++)
+      {
+        detail::nodeKey(coords[ii], &ownedKeys[ii * (dim + 1)]);
+        nodeDest[ii] = detail::rendezvousProc<C,dim>(&ownedKeys[ii * (dim + 1)], npes);
+      }
+
+      // Requests grouped by destination; reqOrder[j] is the owned node of the j-th request.
+      std::vector<size_t> reqOrder;
+      std::vector<int> reqProc, reqCnt;
+      detail::groupByDest(nodeDest, reqOrder, reqProc, reqCnt);
+
+      std::vector<char> reqBuf(numOwned * keyBytes);
+      for (size_t jj = 0; jj < numOwned; jj++)
+        memcpy(&reqBuf[jj * keyBytes], &ownedKeys[reqOrder[jj] * (dim + 1)], keyBytes);
+      for (int &cnt : reqCnt)
+        cnt *= keyBytes;
+
+      std::vector<char> rdvReqs;
+      std::vector<int> rdvReqProc, rdvReqCnt;
+      detail::alltoallvBytes(reqBuf, reqProc, reqCnt, rdvReqs, rdvReqProc, rdvReqCnt, 3, comm);
+
+      // 3. Look up the requests among the records at the rendezvous proc.
+      const size_t numRdvRecords = rdvRecords.size() / recordBytes;
+      std::vector<size_t> rdvIdx(numRdvRecords);
+      for (size_t ii = 0; ii < numRdvRecords; ii++)
+        rdvIdx[ii] = ii;
+      const char *rdvBase = rdvRecords.data();
+      std::sort(rdvIdx.begin(), rdvIdx.end(), [rdvBase, recordBytes, keyBytes](size_t a, size_t b)
+          { return memcmp(rdvBase + a * recordBytes, rdvBase + b * recordBytes, keyBytes) < 0; });
+
+      const size_t numRdvReqs = rdvReqs.size() / keyBytes;
+      std::vector<char> replyBuf(numRdvReqs * valueBytes, 0);
+      DendroIntL numMissing = 0;
+      for (size_t jj = 0; jj < numRdvReqs; jj++)
+      {
+        const char *key = &rdvReqs[jj * keyBytes];
+        std::vector<size_t>::const_iterator it = std::lower_bound(rdvIdx.begin(), rdvIdx.end(), key,
+            [rdvBase, recordBytes, keyBytes](size_t a, const char *k)
+            { return memcmp(rdvBase + a * recordBytes, k, keyBytes) < 0; });
+        if (it != rdvIdx.end() && memcmp(rdvBase + *it * recordBytes, key, keyBytes) == 0)
+          memcpy(&replyBuf[jj * valueBytes], rdvBase + *it * recordBytes + keyBytes, valueBytes);
+        else
+          numMissing++;
+      }
+
+      std::vector<int> replyCnt(rdvReqCnt.size());
+      for (size_t rIdx = 0; rIdx < rdvReqCnt.size(); rIdx++)
+        replyCnt[rIdx] = rdvReqCnt[rIdx] / keyBytes * valueBytes;
+
+      // 4. Return the values to the owners. Both sides list procs in rank order,
+      //    so the replies arrive in the order they were requested.
+      std::vector<char> replies;
+      std::vector<int> repliesProc, repliesCnt;
+      detail::alltoallvBytes(replyBuf, rdvReqProc, replyCnt, replies, repliesProc, repliesCnt, 5, comm);
+
+      V *values = (isGhosted ? vec + dof * da.getLocalNodeBegin() : vec);
+      for (size_t jj = 0; jj < numOwned; jj++)
+        memcpy(values + dof * reqOrder[jj], &replies[jj * valueBytes], valueBytes);
+
+      DendroIntL globMissing = 0;
+      par::Mpi_Allreduce<DendroIntL>(&numMissing, &globMissing, 1, MPI_SUM, comm);
+      if (globMissing && !rank)
+        std::cout << "checkpoint: " << globMissing << " nodes not found in nodal vector section " << std::endl;
+
+      return (globMissing != 0);
+    }
+
+}// end of namespace checkpoint
+}// end of namespace io
@@ -0,0 +1,178 @@
+/**
+ * @file:checkpointView.h
+ * @brief: Read-only, memory-mapped views of checkpoint files, for serial post-processing.
+ *
+ * @description A CheckpointMap maps a whole checkpoint file (checkpointIO.h) with
+ *              mmap() and indexes its sections; nothing is read until it is used.
+ *              TreeView and NodalVecView decode single records on access, so
+ *              tools can scan files larger than memory without MPI or a DA.
+ *
+ *              A tree section written from an SFC-partitioned tree (see writeTree())
+ *              is in SFC order, which TreeView uses for range queries by SFC key.
+ *              Nodal vector sections are in the order of the DA nodes of the writers.
+ */
+
+#ifndef DENDRO_KT_CHECKPOINT_VIEW_H
+#define DENDRO_KT_CHECKPOINT_VIEW_H
+
+#include "checkpointIO.h"
+#include "treeNode.h"
+#include "tsort.h"
+
+#include <cstddef>
+#include <iterator>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace io
+{
+namespace checkpoint
+{
+    /**@brief: a checkpoint file mapped read-only into memory. */
+    class CheckpointMap
+    {
+      public:
+        enum Access { SEQUENTIAL, RANDOM };
+
+        explicit CheckpointMap(const char *fName);
+        ~CheckpointMap();
+
+        CheckpointMap(const CheckpointMap &) = delete;
+        CheckpointMap &operator=(const CheckpointMap &) = delete;
+
+        bool isOpen() const { return m_base != NULL; }
+
+        size_t getNumSections() const { return m_sections.size(); }
+
+        /**@brief: a copy of the header of a section (the header in the mapping may be misaligned). */
+        const CheckpointHeader &getHeader(size_t section) const
+        { return m_sections[section].m_header; }
+
+        /**@brief: the records of a section, in the mapping (not aligned for the value type). */
+        const char *getRecords(size_t section) const
+        { return m_base + m_sections[section].m_offset + sizeof(CheckpointHeader); }
+
+        /**@brief: index of the first section of kind (and name, if not NULL), or -1. */
+        long findSection(SectionKind kind, const char *name = NULL) const;
+
+        /**@brief: hints the expected access pattern to the kernel (madvise()). */
+        void advise(Access access) const;
+
+      private:
+        int m_fd;
+        const char *m_base;
+        size_t m_size;
+        struct Section { size_t m_offset; CheckpointHeader m_header; };
+        std::vector<Section> m_sections;   // Offset and header of each section.
+    };
+
+
+    /**@brief: the leaves of a tree section, decoded on access. */
+    template <typename T, unsigned int dim>
+    class TreeView
+    {
+      public:
+        /**@brief: lazy random-access iterator; dereferencing decodes the record. */
+        class const_iterator
+        {
+          public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = ot::TreeNode<T,dim>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const ot::TreeNode<T,dim> *;
+            using reference = ot::TreeNode<T,dim>;
+
+            const_iterator() : m_view(NULL), m_idx(0) {}
+            const_iterator(const TreeView *view, size_t idx) : m_view(view), m_idx(idx) {}
+
+            ot::TreeNode<T,dim> operator*() const { return (*m_view)[m_idx]; }
+            ot::TreeNode<T,dim> operator[](std::ptrdiff_t n) const { return (*m_view)[m_idx + n]; }
+
+            const_iterator &operator++() { ++m_idx; return *this; }
+            const_iterator &operator--() { --m_idx; return *this; }
+            const_iterator operator++(int) { const_iterator it = *this; ++m_idx; return it; }
+            const_iterator operator--(int) { const_iterator it = *this; --m_idx; return it; }
+            const_iterator &operator+=(std::ptrdiff_t n) { m_idx += n; return *this; }
+            const_iterator &operator-=(std::ptrdiff_t n) { m_idx -= n; return *this; }
+            const_iterator operator+(std::ptrdiff_t n) const { return const_iterator(m_view, m_idx + n); }
+            const_iterator operator-(std::ptrdiff_t n) const { return const_iterator(m_view, m_idx - n); }
+            std::ptrdiff_t operator-(const const_iterator &other) const { return (std::ptrdiff_t) m_idx - (std::ptrdiff_t) other.m_idx; }
+
+            bool operator==(const const_iterator &other) const { return m_idx == other.m_idx; }
+            bool operator!=(const const_iterator &other) const { return m_idx != other.m_idx; }
+            bool operator< (const const_iterator &other) const { return m_idx <  other.m_idx; }
+            bool operator<=(const const_iterator &other) const { return m_idx <= other.m_idx; }
+            bool operator> (const const_iterator &other) const { return m_idx >  other.m_idx; }
+            bool operator>=(const const_iterator &other) const { return m_idx >= other.m_idx; }
+
+            size_t index() const { return m_idx; }
+
+          private:
+            const TreeView *m_view;
+            size_t m_idx;
+        };
+
+        /**@brief: views section of map; isValid() is false if it is not a tree of this T and dim. */
+        TreeView(const CheckpointMap &map, size_t section);
+
+        bool isValid() const { return m_records != NULL; }
+        size_t size() const { return m_size; }
+
+        ot::TreeNode<T,dim> operator[](size_t idx) const;
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+
+        /**@brief: first leaf that does not precede key in the SFC order of locTreeSort() (ot::SFC_CachedKey). */
+        size_t lowerBound(const ot::TreeNode<T,dim> &key) const;
+
+        /**
+         * @brief: the range [first, second) of leaves that overlap region: its descendants,
+         *         region itself, or the one leaf containing it.
+         * @pre: the section is in SFC order.
+         */
+        std::pair<size_t, size_t> overlapping(const ot::TreeNode<T,dim> &region) const;
+
+      private:
+        const char *m_records;
+        size_t m_size;
+        size_t m_recordBytes;
+    };
+
+
+    /**@brief: the nodes and values of a nodal vector section, decoded on access. */
+    template <unsigned int dim, typename V>
+    class NodalVecView
+    {
+      public:
+        using C = unsigned int;
+
+        /**@brief: views section of map; isValid() is false if it is not a nodal vector of this dim and V. */
+        NodalVecView(const CheckpointMap &map, size_t section);
+
+        bool isValid() const { return m_records != NULL; }
+        size_t size() const { return m_size; }
+        unsigned int getDof() const { return m_dof; }
+
+        /**@brief: coordinates and level of a node. */
+        ot::TreeNode<C,dim> getNode(size_t idx) const;
+
+        V getValue(size_t idx, unsigned int var) const;
+
+        /**@brief: copies the dof values of a node to values. */
+        void getValues(size_t idx, V *values) const;
+
+      private:
+        const char *m_records;
+        size_t m_size;
+        size_t m_recordBytes;
+        unsigned int m_dof;
+    };
+
+}// end of namespace checkpoint
+}// end of namespace io
+
+#include "checkpointView.tcc"
+
+#endif //DENDRO_KT_CHECKPOINT_VIEW_H
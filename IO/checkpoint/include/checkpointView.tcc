@@ -0,0 +1,122 @@
+/**
+ * @file:checkpointView.tcc
+ * @brief: Read-only, memory-mapped views of checkpoint files, for serial post-processing.
+ */
+
+#include <algorithm>
+#include <array>
+#include <string.h>
+
+namespace io
+{
+namespace checkpoint
+{
+    //
+    // TreeView
+    //
+    template <typename T, unsigned int dim>
+    TreeView<T,dim>::TreeView(const CheckpointMap &map, size_t section)
+      : m_records(NULL), m_size(0), m_recordBytes(0)
+    {
+      if (!map.isOpen() || section >= map.getNumSections())
+        return;
+
+      const CheckpointHeader &header = map.getHeader(section);
+      if (header.m_kind == SECTION_TREE && header.m_dim == dim && header.m_coordBytes == sizeof(T))
+      {
+        m_records = map.getRecords(section);
+        m_size = header.m_numRecords;
+        m_recordBytes = header.m_recordBytes;
+      }
+    }
+
+
+    template <typename T, unsigned int dim>
+    ot::TreeNode<T,dim> TreeView<T,dim>::operator[](size_t idx) const
+    {
+      const char *rec = m_records + idx * m_recordBytes;
+      std::array<T,dim> coords;
+      unsigned int lev;
+      memcpy(coords.data(), rec, dim * sizeof(T));
+      memcpy(&lev, rec + dim * sizeof(T), sizeof(lev));
+      return ot::TreeNode<T,dim>(coords, lev);
+    }
+
+
+    template <typename T, unsigned int dim>
+    size_t TreeView<T,dim>::lowerBound(const ot::TreeNode<T,dim> &key) const
+    {
+      // The key's orientations are computed once; each probe decodes one record.
+      const ot::SFC_CachedKey<T,dim> cachedKey(key);
+      return std::partition_point(begin(), end(),
+          [&cachedKey](const ot::TreeNode<T,dim> &leaf) { return cachedKey.compare(leaf) < 0; }).index();
+    }
+
+
+    template <typename T, unsigned int dim>
+    std::pair<size_t, size_t> TreeView<T,dim>::overlapping(const ot::TreeNode<T,dim> &region) const
+    {
+      const size_t first = lowerBound(region);
+
+      // A coarser leaf containing region precedes it.
+      if (first > 0 && (*this)[first - 1].isAncestor(region))
+        return std::make_pair(first - 1, first);
+
+      // Otherwise region and its descendants follow contiguously.
+      const size_t last = std::partition_point(begin() + first, end(),
+          [&region](const ot::TreeNode<T,dim> &leaf) { return leaf == region || region.isAncestor(leaf); }).index();
+      return std::make_pair(first, last);
+    }
+
+
+    //
+    // NodalVecView
+    //
+    template <unsigned int dim, typename V>
+    NodalVecView<dim,V>::NodalVecView(const CheckpointMap &map, size_t section)
+      : m_records(NULL), m_size(0), m_recordBytes(0), m_dof(0)
+    {
+      if (!map.isOpen() || section >= map.getNumSections())
+        return;
+
+      const CheckpointHeader &header = map.getHeader(section);
+      if (header.m_kind == SECTION_NODAL_VEC && header.m_dim == dim &&
+          header.m_coordBytes == sizeof(C) && header.m_valueBytes == sizeof(V))
+      {
+        m_records = map.getRecords(section);
+        m_size = header.m_numRecords;
+        m_recordBytes = header.m_recordBytes;
+        m_dof = header.m_dof;
+      }
+    }
+
+
+    template <unsigned int dim, typename V>
+    ot::TreeNode<typename NodalVecView<dim,V>::C, dim> NodalVecView<dim,V>::getNode(size_t idx) const
+    {
+      const char *rec = m_records + idx * m_recordBytes;
+      std::array<C,dim> coords;
+      unsigned int lev;
+      memcpy(coords.data(), rec, dim * sizeof(C));
+      memcpy(&lev, rec + dim * sizeof(C), sizeof(lev));
+      return ot::TreeNode<C,dim>(coords, lev);
+    }
+
+
+    template <unsigned int dim, typename V>
+    V NodalVecView<dim,V>::getValue(size_t idx, unsigned int var) const
+    {
+      V value;
+      memcpy(&value, m_records + idx * m_recordBytes + (dim + 1) * sizeof(C) + var * sizeof(V), sizeof(V));
+      return value;
+    }
+
+
+    template <unsigned int dim, typename V>
+    void NodalVecView<dim,V>::getValues(size_t idx, V *values) const
+    {
+      memcpy(values, m_records + idx * m_recordBytes + (dim + 1) * sizeof(C), m_dof * sizeof(V));
+    }
+
+}// end of namespace checkpoint
+}// end of namespace io
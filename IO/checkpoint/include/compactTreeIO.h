@@ -0,0 +1,113 @@
+/**
+ * @file:compactTreeIO.h
+ * @brief: Compact files of SFC-sorted trees: level runs and anchors, varint-coded.
+ *
+ * @description A linearized complete tree is determined by its first leaf and
+ *              the sequence of leaf levels: each leaf starts where the previous
+ *              one ends on the SFC (see CompressedTree in tsearchCmpx.h). The
+ *              tree is stored as blocks of at most m_blockLeaves leaves; a block
+ *              is an anchor (the full first leaf) followed by level segments
+ *              (level change, number of leaves). Where a leaf does not follow
+ *              its predecessor (an incomplete tree, or the end of the curve),
+ *              a new block begins, so any sorted tree can be stored.
+ *
+ *              All integers in a block are LEB128 varints, level changes zigzag-coded:
+ *                  block   := lev, coords[dim], numSegments, segment*
+ *                  segment := zigzag(lev - prevLev), numLeaves
+ *
+ *              File: CompactTreeHeader | CompactBlockIndex[m_numBlocks] | blocks.
+ *              The index allows procs to decode disjoint ranges of blocks.
+ */
+
+#ifndef DENDRO_KT_COMPACT_TREE_IO_H
+#define DENDRO_KT_COMPACT_TREE_IO_H
+
+#include "treeNode.h"
+#include "tsort.h"
+#include "tsearchCmpx.h"
+
+#include <mpi.h>
+#include <stdint.h>
+#include <vector>
+
+namespace io
+{
+namespace checkpoint
+{
+    /**@brief: the SFC that orders the leaves of a compact tree file (HILBERT_ORDERING or not). */
+    enum CompactTreeCurve : uint32_t { CompactCurveMorton = 1, CompactCurveHilbert = 2 };
+
+    /**@brief: fixed-size (64 byte) header of a compact tree file. */
+    struct CompactTreeHeader
+    {
+      char m_magic[8];             // "DKTCTRE"
+      uint32_t m_dim;
+      uint32_t m_coordBytes;       // sizeof coordinate type
+      uint32_t m_maxDepth;         // m_uiMaxDepth of the writer; coordinates are relative to it.
+      uint32_t m_blockLeaves;
+      uint64_t m_numLeaves;
+      uint64_t m_numBlocks;
+      uint64_t m_numBytes;         // Sum of the block sizes.
+      uint32_t m_curve;            // CompactTreeCurve; blocks decode only on the same curve.
+      char m_reserved[12];
+    };
+
+    /**@brief: where a block begins, in leaves and in bytes from the start of the blocks. */
+    struct CompactBlockIndex
+    {
+      uint64_t m_leafBegin;
+      uint64_t m_byteBegin;
+    };
+
+    template <typename T, unsigned int dim>
+    struct CompactTreeIO
+    {
+      static constexpr unsigned int defaultBlockLeaves = 4096;
+
+      /**
+       * @brief: encodes a sorted tree as blocks, appended to blocks and index.
+       * @note: index offsets are relative to the size of blocks on entry, leaf ranks start at 0.
+       * @return: 0, or 1 if a leaf is outside the unit domain.
+       */
+      static int encode(const ot::TreeNode<T,dim> *tree, size_t numLeaves, unsigned int blockLeaves,
+                        std::vector<char> &blocks, std::vector<CompactBlockIndex> &index);
+
+      /**
+       * @brief: decodes the blocks in [begin, end), appending the leaves to tree.
+       * @return: 0, or 1 if the data is truncated.
+       */
+      static int decode(const char *begin, const char *end, std::vector<ot::TreeNode<T,dim>> &tree);
+
+      /**@brief: writes a tree to a compact tree file with stdio. */
+      static int write(const char *fName, const ot::TreeNode<T,dim> *tree, size_t numLeaves,
+                       unsigned int blockLeaves = defaultBlockLeaves);
+
+      /**@brief: reads a whole compact tree file with stdio. */
+      static int read(const char *fName, std::vector<ot::TreeNode<T,dim>> &tree);
+
+      /**
+       * @brief: writes a distributed tree to one compact tree file with MPI-IO. Collective on comm.
+       * @note: procs should hold consecutive SFC ranges; blocks do not cross procs.
+       */
+      static int dist_write(const char *fName, const ot::TreeNode<T,dim> *tree, size_t numLocal,
+                            MPI_Comm comm, unsigned int blockLeaves = defaultBlockLeaves);
+
+      /**
+       * @brief: reads a compact tree file with MPI-IO. Collective on comm.
+       *         Proc r of p decodes blocks [B*r/p, B*(r+1)/p), then the tree is
+       *         partitioned with distTreeSort().
+       */
+      static int dist_read(const char *fName, std::vector<ot::TreeNode<T,dim>> &tree,
+                           MPI_Comm comm, double loadFlexibility = 0.3);
+    };
+
+
+    // Template instantiations.
+    template struct CompactTreeIO<unsigned int, 2>;
+    template struct CompactTreeIO<unsigned int, 3>;
+    template struct CompactTreeIO<unsigned int, 4>;
+
+}// end of namespace checkpoint
+}// end of namespace io
+
+#endif //DENDRO_KT_COMPACT_TREE_IO_H
@@ -0,0 +1,344 @@
+/**
+ * @file:checkpointIO.cpp
+ * @brief: Collective checkpoint/restart of distributed trees and DA nodal vectors.
+ */
+
+#include "checkpointIO.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+#include <utility>
+
+namespace io
+{
+namespace checkpoint
+{
+    static_assert(sizeof(CheckpointHeader) == 64, "CheckpointHeader must not be padded.");
+
+    static const char checkpointMagic[8] = "DKTCKPT";
+
+
+    CheckpointHeader makeHeader(SectionKind kind, unsigned int dim, unsigned int coordBytes,
+                                unsigned int valueBytes, unsigned int dof, const char *name)
+    {
+      CheckpointHeader header;
+      memset(&header, 0, sizeof(header));
+      memcpy(header.m_magic, checkpointMagic, sizeof(header.m_magic));
+      header.m_kind = kind;
+      header.m_dim = dim;
+      header.m_coordBytes = coordBytes;
+      header.m_valueBytes = valueBytes;
+      header.m_dof = dof;
+      header.m_recordBytes = dim * coordBytes + sizeof(unsigned int) + dof * valueBytes;
+      header.m_numRecords = 0;
+      if (name != NULL)
+        strncpy(header.m_name, name, sizeof(header.m_name) - 1);
+      return header;
+    }
+
+
+    CheckpointFile::CheckpointFile(const char *fName, Mode mode, MPI_Comm comm)
+      : m_comm(comm), m_mode(mode), m_isOpen(false), m_offset(0), m_maxPending(0), m_pendingFailed(0)
+    {
+      int rank;
+      MPI_Comm_rank(comm, &rank);
+
+      int amode = (mode == WRITE ? MPI_MODE_CREATE | MPI_MODE_WRONLY : MPI_MODE_RDONLY);
+
+      // An existing, longer file would keep its tail after we write.
+      if (mode == WRITE && !rank)
+        MPI_File_delete(fName, MPI_INFO_NULL);
+      MPI_Barrier(comm);
+
+      m_isOpen = (MPI_File_open(comm, fName, amode, MPI_INFO_NULL, &m_file) == MPI_SUCCESS);
+      if (!m_isOpen && !rank)
+        std::cout << fName << " checkpoint file open failed " << std::endl;
+    }
+
+
+    CheckpointFile::~CheckpointFile()
+    {
+      // close() is collective and cannot run once MPI is finalized.
+      int finalized;
+      MPI_Finalized(&finalized);
+      if (finalized)
+        return;
+
+      close();
+    }
+
+
+    void CheckpointFile::close()
+    {
+      if (m_isOpen)
+      {
+        if (m_mode == WRITE)
+          flush();
+        MPI_File_close(&m_file);
+      }
+      m_isOpen = false;
+    }
+
+
+    void CheckpointFile::sectionRange(uint64_t numLocal, uint64_t &globBegin, uint64_t &globTotal) const
+    {
+      int rank;
+      MPI_Comm_rank(m_comm, &rank);
+
+      globBegin = 0;
+      globTotal = 0;
+      MPI_Exscan(&numLocal, &globBegin, 1, MPI_UINT64_T, MPI_SUM, m_comm);
+      if (!rank)
+        globBegin = 0;   // Undefined after MPI_Exscan().
+      MPI_Allreduce(&numLocal, &globTotal, 1, MPI_UINT64_T, MPI_SUM, m_comm);
+    }
+
+
+    int CheckpointFile::writeSection(CheckpointHeader header, const char *localRecords, uint64_t numLocal)
+    {
+      if (!m_isOpen || m_mode != WRITE)
+        return 1;
+
+      // Asynchronous: stage a copy, the caller may reuse localRecords.
+      if (m_maxPending > 0)
+        return writeSection(header, std::vector<char>(localRecords, localRecords + numLocal * header.m_recordBytes), numLocal);
+
+      int rank;
+      MPI_Comm_rank(m_comm, &rank);
+
+      uint64_t globBegin, globTotal;
+      sectionRange(numLocal, globBegin, globTotal);
+
+      header.m_numRecords = globTotal;
+
+      int err = MPI_SUCCESS;
+      if (!rank)
+        err = MPI_File_write_at(m_file, m_offset, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+
+      MPI_Datatype recordType;
+      MPI_Type_contiguous(header.m_recordBytes, MPI_BYTE, &recordType);
+      MPI_Type_commit(&recordType);
+
+      const MPI_Offset recordsOffset = m_offset + sizeof(header) + (MPI_Offset) globBegin * header.m_recordBytes;
+      int errRecords = MPI_File_write_at_all(m_file, recordsOffset, localRecords, (int) numLocal, recordType, MPI_STATUS_IGNORE);
+      MPI_Type_free(&recordType);
+
+      int localFailed = (err != MPI_SUCCESS || errRecords != MPI_SUCCESS), globFailed = 0;
+      MPI_Allreduce(&localFailed, &globFailed, 1, MPI_INT, MPI_MAX, m_comm);
+      if (globFailed && !rank)
+        std::cout << "checkpoint: writing section failed " << std::endl;
+
+      m_offset += sizeof(header) + (MPI_Offset) globTotal * header.m_recordBytes;
+      return globFailed;
+    }
+
+
+    int CheckpointFile::writeSection(CheckpointHeader header, std::vector<char> &&localRecords, uint64_t numLocal)
+    {
+      if (!m_isOpen || m_mode != WRITE)
+        return 1;
+
+      if (m_maxPending == 0)
+        return writeSection(header, (const char *) localRecords.data(), numLocal);
+
+      int rank;
+      MPI_Comm_rank(m_comm, &rank);
+
+      uint64_t globBegin, globTotal;
+      sectionRange(numLocal, globBegin, globTotal);
+
+      header.m_numRecords = globTotal;
+
+      // Back-pressure: make room by waiting for the oldest sections.
+      progress();
+      while (m_pending.size() >= m_maxPending)
+        waitOldest();
+
+      m_pending.emplace_back();
+      PendingWrite &pw = m_pending.back();
+      pw.m_header = header;
+      pw.m_records = std::move(localRecords);
+      pw.m_requests[0] = MPI_REQUEST_NULL;
+      pw.m_requests[1] = MPI_REQUEST_NULL;
+
+      int err = MPI_SUCCESS;
+      if (!rank)
+        err = MPI_File_iwrite_at(m_file, m_offset, &pw.m_header, sizeof(header), MPI_BYTE, &pw.m_requests[0]);
+
+      MPI_Datatype recordType;
+      MPI_Type_contiguous(header.m_recordBytes, MPI_BYTE, &recordType);
+      MPI_Type_commit(&recordType);
+
+      const MPI_Offset recordsOffset = m_offset + sizeof(header) + (MPI_Offset) globBegin * header.m_recordBytes;
+      int errRecords = MPI_File_iwrite_at_all(m_file, recordsOffset, pw.m_records.data(), (int) numLocal, recordType, &pw.m_requests[1]);
+      MPI_Type_free(&recordType);   // Freed once the write completes.
+
+      if (err != MPI_SUCCESS || errRecords != MPI_SUCCESS)
+        m_pendingFailed = 1;
+
+      m_offset += sizeof(header) + (MPI_Offset) globTotal * header.m_recordBytes;
+      return 0;
+    }
+
+
+    void CheckpointFile::progress()
+    {
+      // Sections are released in the order they were written.
+      while (!m_pending.empty())
+      {
+        int done = 0;
+        if (MPI_Testall(2, m_pending.front().m_requests, &done, MPI_STATUSES_IGNORE) != MPI_SUCCESS)
+        {
+          m_pendingFailed = 1;
+          done = 1;
+        }
+        if (!done)
+          break;
+        m_pending.pop_front();
+      }
+    }
+
+
+    void CheckpointFile::waitOldest()
+    {
+      if (MPI_Waitall(2, m_pending.front().m_requests, MPI_STATUSES_IGNORE) != MPI_SUCCESS)
+        m_pendingFailed = 1;
+      m_pending.pop_front();
+    }
+
+
+    int CheckpointFile::flush()
+    {
+      while (!m_pending.empty())
+        waitOldest();
+
+      int rank;
+      MPI_Comm_rank(m_comm, &rank);
+
+      int globFailed = 0;
+      MPI_Allreduce(&m_pendingFailed, &globFailed, 1, MPI_INT, MPI_MAX, m_comm);
+      if (globFailed && !rank)
+        std::cout << "checkpoint: writing staged section failed " << std::endl;
+
+      m_pendingFailed = 0;
+      return globFailed;
+    }
+
+
+    int CheckpointFile::readSection(const CheckpointHeader &expected, std::vector<char> &localRecords, uint64_t &numLocal, CheckpointHeader *found)
+    {
+      numLocal = 0;
+      localRecords.clear();
+      if (!m_isOpen || m_mode != READ)
+        return 1;
+
+      int rank, npes;
+      MPI_Comm_rank(m_comm, &rank);
+      MPI_Comm_size(m_comm, &npes);
+
+      CheckpointHeader header;
+      memset(&header, 0, sizeof(header));
+      if (MPI_File_read_at_all(m_file, m_offset, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+        memset(&header, 0, sizeof(header));
+
+      if (found != NULL)
+        *found = header;
+
+      // Every proc read the same header, so they agree on the outcome.
+      if (memcmp(header.m_magic, checkpointMagic, sizeof(header.m_magic)) != 0 ||
+          header.m_kind != expected.m_kind ||
+          header.m_dim != expected.m_dim ||
+          header.m_coordBytes != expected.m_coordBytes ||
+          header.m_valueBytes != expected.m_valueBytes ||
+          header.m_dof != expected.m_dof ||
+          header.m_recordBytes != expected.m_recordBytes)
+      {
+        if (!rank)
+          std::cout << "checkpoint: section does not match (kind " << header.m_kind
+                    << ", dim " << header.m_dim << ", dof " << header.m_dof << ")" << std::endl;
+        return 1;
+      }
+
+      const uint64_t globTotal = header.m_numRecords;
+      const uint64_t globBegin = globTotal * rank / npes;
+      const uint64_t globEnd = globTotal * (rank + 1) / npes;
+      numLocal = globEnd - globBegin;
+      localRecords.resize(numLocal * header.m_recordBytes);
+
+      MPI_Datatype recordType;
+      MPI_Type_contiguous(header.m_recordBytes, MPI_BYTE, &recordType);
+      MPI_Type_commit(&recordType);
+
+      const MPI_Offset recordsOffset = m_offset + sizeof(header) + (MPI_Offset) globBegin * header.m_recordBytes;
+      int err = MPI_File_read_at_all(m_file, recordsOffset, localRecords.data(), (int) numLocal, recordType, MPI_STATUS_IGNORE);
+      MPI_Type_free(&recordType);
+
+      int localFailed = (err != MPI_SUCCESS), globFailed = 0;
+      MPI_Allreduce(&localFailed, &globFailed, 1, MPI_INT, MPI_MAX, m_comm);
+      if (globFailed && !rank)
+        std::cout << "checkpoint: reading section failed " << std::endl;
+
+      m_offset += sizeof(header) + (MPI_Offset) globTotal * header.m_recordBytes;
+      return globFailed;
+    }
+
+
+    namespace detail
+    {
+      void groupByDest(const std::vector<int> &dest, std::vector<size_t> &order,
+                       std::vector<int> &destProc, std::vector<int> &destCnt)
+      {
+        order.resize(dest.size());
+        for (size_t ii = 0; ii < dest.size(); ii++)
+          order[ii] = ii;
+        std::stable_sort(order.begin(), order.end(),
+            [&dest](size_t a, size_t b) { return dest[a] < dest[b]; });
+
+        destProc.clear();
+        destCnt.clear();
+        for (size_t jj = 0; jj < order.size(); jj++)
+        {
+          if (destProc.empty() || destProc.back() != dest[order[jj]])
+          {
+            destProc.push_back(dest[order[jj]]);
+            destCnt.push_back(0);
+          }
+          destCnt.back()++;
+        }
+      }
+
+
+      void alltoallvBytes(const std::vector<char> &sendBuf, const std::vector<int> &sendProc, const std::vector<int> &sendCnt,
+                          std::vector<char> &recvBuf, std::vector<int> &recvProc, std::vector<int> &recvCnt,
+                          int tag, MPI_Comm comm)
+      {
+        // Only the procs we exchange with are listed, so nothing here is O(npes).
+        par::Mpi_Alltoall_NBX<int>(sendProc.data(), sendCnt.data(), (int) sendProc.size(),
+                                   recvProc, recvCnt, tag, comm);
+
+        size_t recvTotal = 0;
+        for (int cnt : recvCnt)
+          recvTotal += cnt;
+        recvBuf.resize(recvTotal);
+
+        std::vector<MPI_Request> requests(sendProc.size() + recvProc.size());
+        size_t sendOffset = 0, recvOffset = 0;
+        for (size_t sIdx = 0; sIdx < sendProc.size(); sIdx++)
+        {
+          par::Mpi_Isend<char>(const_cast<char *>(sendBuf.data()) + sendOffset, sendCnt[sIdx],
+                               sendProc[sIdx], tag + 1, comm, &requests[sIdx]);
+          sendOffset += sendCnt[sIdx];
+        }
+        for (size_t rIdx = 0; rIdx < recvProc.size(); rIdx++)
+        {
+          par::Mpi_Irecv<char>(recvBuf.data() + recvOffset, recvCnt[rIdx],
+                               recvProc[rIdx], tag + 1, comm, &requests[sendProc.size() + rIdx]);
+          recvOffset += recvCnt[rIdx];
+        }
+        MPI_Waitall((int) requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+      }
+    }
+
+}// end of namespace checkpoint
+}// end of namespace io
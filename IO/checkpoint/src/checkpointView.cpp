@@ -0,0 +1,89 @@
+/**
+ * @file:checkpointView.cpp
+ * @brief: Read-only, memory-mapped views of checkpoint files, for serial post-processing.
+ */
+
+#include "checkpointView.h"
+
+#include <fcntl.h>
+#include <iostream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace io
+{
+namespace checkpoint
+{
+    CheckpointMap::CheckpointMap(const char *fName)
+      : m_fd(-1), m_base(NULL), m_size(0)
+    {
+      m_fd = open(fName, O_RDONLY);
+      struct stat st;
+      if (m_fd < 0 || fstat(m_fd, &st) != 0 || st.st_size == 0)
+      {
+        std::cout << fName << " checkpoint file open failed " << std::endl;
+        return;
+      }
+
+      m_size = st.st_size;
+      void *base = mmap(NULL, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+      if (base == MAP_FAILED)
+      {
+        std::cout << fName << " checkpoint file mmap failed " << std::endl;
+        return;
+      }
+      m_base = (const char *) base;
+
+      // Index the sections; a truncated last section is dropped.
+      // Headers are copied out, since a section may end at any byte offset.
+      const CheckpointHeader magic = makeHeader(SECTION_TREE, 0, 0, 0, 0, NULL);
+      size_t offset = 0;
+      while (offset + sizeof(CheckpointHeader) <= m_size)
+      {
+        CheckpointHeader header;
+        memcpy(&header, m_base + offset, sizeof(header));
+        if (memcmp(header.m_magic, magic.m_magic, sizeof(header.m_magic)) != 0)
+          break;
+        const size_t sectionBytes = sizeof(CheckpointHeader) + header.m_numRecords * header.m_recordBytes;
+        if (offset + sectionBytes > m_size)
+          break;
+        m_sections.push_back({offset, header});
+        offset += sectionBytes;
+      }
+      if (offset != m_size)
+        std::cout << fName << ": ignoring " << (m_size - offset) << " bytes after the last complete section " << std::endl;
+    }
+
+
+    CheckpointMap::~CheckpointMap()
+    {
+      if (m_base != NULL)
+        munmap((void *) m_base, m_size);
+      if (m_fd >= 0)
+        close(m_fd);
+    }
+
+
+    long CheckpointMap::findSection(SectionKind kind, const char *name) const
+    {
+      for (size_t s = 0; s < m_sections.size(); s++)
+      {
+        const CheckpointHeader &header = getHeader(s);
+        if (header.m_kind == (uint32_t) kind &&
+            (name == NULL || strncmp(header.m_name, name, sizeof(header.m_name)) == 0))
+          return (long) s;
+      }
+      return -1;
+    }
+
+
+    void CheckpointMap::advise(Access access) const
+    {
+      if (m_base != NULL)
+        madvise((void *) m_base, m_size, (access == SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM));
+    }
+
+}// end of namespace checkpoint
+}// end of namespace io
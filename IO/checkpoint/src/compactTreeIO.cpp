@@ -0,0 +1,481 @@
+/**
+ * @file:compactTreeIO.cpp
+ * @brief: Compact files of SFC-sorted trees: level runs and anchors, varint-coded.
+ */
+
+#include "compactTreeIO.h"
+#include "hcurvedata.h"
+#include "parUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+
+namespace io
+{
+namespace checkpoint
+{
+    static_assert(sizeof(CompactTreeHeader) == 64, "CompactTreeHeader must not be padded.");
+    static_assert(sizeof(CompactBlockIndex) == 16, "CompactBlockIndex must not be padded.");
+
+    static const char compactTreeMagic[8] = "DKTCTRE";
+
+#ifdef HILBERT_ORDERING
+    static const uint32_t compactTreeCurve = CompactCurveHilbert;
+#else
+    static const uint32_t compactTreeCurve = CompactCurveMorton;
+#endif
+
+    namespace
+    {
+      inline void putVarint(std::vector<char> &buf, uint64_t v)
+      {
+        while (v >= 0x80)
+        {
+          buf.push_back((char) ((v & 0x7f) | 0x80));
+          v >>= 7;
+        }
+        buf.push_back((char) v);
+      }
+
+      /**@brief: returns false if the varint does not end before end. */
+      inline bool getVarint(const char *&p, const char *end, uint64_t &v)
+      {
+        v = 0;
+        for (unsigned int shift = 0; p < end && shift < 64; shift += 7)
+        {
+          const unsigned char byte = (unsigned char) *p++;
+          v |= (uint64_t) (byte & 0x7f) << shift;
+          if (!(byte & 0x80))
+            return true;
+        }
+        return false;
+      }
+
+      inline uint64_t zigzag(int64_t v) { return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63); }
+      inline int64_t unzigzag(uint64_t v) { return (int64_t) (v >> 1) ^ -(int64_t) (v & 1); }
+
+      /**@brief: next cell at level lev in SFC digits[1..lev]. Returns false at the end of the curve. */
+      inline bool advanceSFCDigits(ot::ChildI *digits, ot::LevI lev, ot::RankI numChildren)
+      {
+        for (ot::LevI l = lev; l >= 1; l--)
+        {
+          if (digits[l] + 1 < numChildren)
+          {
+            digits[l]++;
+            return true;
+          }
+          digits[l] = 0;
+        }
+        return false;
+      }
+
+      /**@brief: the cell at level lev with SFC digits[1..lev] (inverse of SFC_Search::getSFCDigits()). */
+      template <typename T, unsigned int dim>
+      ot::TreeNode<T,dim> cellFromSFCDigits(const ot::ChildI *digits, ot::LevI lev)
+      {
+        std::array<T,dim> coords;
+        coords.fill(0);
+        ot::RotI pRot = 0;
+        for (ot::LevI l = 1; l <= lev; l++)
+        {
+          const ot::ChildI child_m = SFC_Tables<dim>::rotPerm(pRot)[digits[l]];
+          for (unsigned int d = 0; d < dim; d++)
+            if ((child_m >> d) & 1u)
+              coords[d] |= (T) 1 << (m_uiMaxDepth - l);
+          pRot = SFC_Tables<dim>::orientLookup(pRot)[child_m];
+        }
+        return ot::TreeNode<T,dim>(coords, lev);
+      }
+
+      template <typename T, unsigned int dim>
+      CompactTreeHeader makeCompactHeader(uint64_t numLeaves, uint64_t numBlocks, uint64_t numBytes, unsigned int blockLeaves)
+      {
+        CompactTreeHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.m_magic, compactTreeMagic, sizeof(header.m_magic));
+        header.m_dim = dim;
+        header.m_coordBytes = sizeof(T);
+        header.m_maxDepth = m_uiMaxDepth;
+        header.m_blockLeaves = blockLeaves;
+        header.m_numLeaves = numLeaves;
+        header.m_numBlocks = numBlocks;
+        header.m_numBytes = numBytes;
+        header.m_curve = compactTreeCurve;
+        return header;
+      }
+
+      template <typename T, unsigned int dim>
+      bool checkCompactHeader(const CompactTreeHeader &header, const char *fName)
+      {
+        if (memcmp(header.m_magic, compactTreeMagic, sizeof(header.m_magic)) != 0 ||
+            header.m_dim != dim ||
+            header.m_coordBytes != sizeof(T) ||
+            header.m_maxDepth != m_uiMaxDepth)
+        {
+          std::cout << fName << " is not a compact tree file of this dim and max depth (dim "
+                    << header.m_dim << ", max depth " << header.m_maxDepth << ")" << std::endl;
+          return false;
+        }
+        if (header.m_curve != compactTreeCurve)
+        {
+          std::cout << fName << " was written in the " << (header.m_curve == CompactCurveHilbert ? "Hilbert" : "Morton")
+                    << " order, which this build (HILBERT_ORDERING " << (compactTreeCurve == CompactCurveHilbert ? "on" : "off")
+                    << ") cannot decode" << std::endl;
+          return false;
+        }
+        return true;
+      }
+    }
+
+
+    //
+    // encode()
+    //
+    template <typename T, unsigned int dim>
+    int CompactTreeIO<T,dim>::encode(const ot::TreeNode<T,dim> *tree, size_t numLeaves, unsigned int blockLeaves,
+                                     std::vector<char> &blocks, std::vector<CompactBlockIndex> &index)
+    {
+      constexpr ot::RankI numChildren = ot::TreeNode<T,dim>::numChildren;
+      const size_t blocksBegin = blocks.size();
+      blockLeaves = std::max(blockLeaves, 1u);
+
+      std::vector<ot::ChildI> cur(m_uiMaxDepth + 1), next(m_uiMaxDepth + 1);
+      std::vector<ot::LevI> segLev;
+      std::vector<uint64_t> segLeaves;
+
+      size_t ii = 0;
+      while (ii < numLeaves)
+      {
+        // Anchor.
+        const ot::TreeNode<T,dim> &anchor = tree[ii];
+        ot::LevI lev = anchor.getLevel();
+        if (!ot::SFC_Search<T,dim>::getSFCDigits(anchor, lev, cur.data()))
+          return 1;
+
+        index.push_back({(uint64_t) ii, (uint64_t) (blocks.size() - blocksBegin)});
+        putVarint(blocks, lev);
+        for (unsigned int d = 0; d < dim; d++)
+          putVarint(blocks, anchor.getX(d));
+
+        segLev.assign(1, lev);
+        segLeaves.assign(1, 1);
+        const size_t blockEnd = std::min(numLeaves, ii + blockLeaves);
+        ii++;
+
+        // Extend the block while each leaf begins where the previous one ends.
+        while (ii < blockEnd)
+        {
+          const ot::LevI nextLev = tree[ii].getLevel();
+          if (!advanceSFCDigits(cur.data(), lev, numChildren))
+            break;
+
+          bool follows = true;
+          for (ot::LevI l = nextLev + 1; l <= lev; l++)
+            follows &= (cur[l] == 0);
+          for (ot::LevI l = lev + 1; l <= nextLev; l++)
+            cur[l] = 0;
+          follows = follows && ot::SFC_Search<T,dim>::getSFCDigits(tree[ii], nextLev, next.data())
+                            && std::equal(cur.begin() + 1, cur.begin() + 1 + nextLev, next.begin() + 1);
+          if (!follows)
+            break;
+
+          if (nextLev == lev)
+            segLeaves.back()++;
+          else
+          {
+            segLev.push_back(nextLev);
+            segLeaves.push_back(1);
+          }
+          lev = nextLev;
+          ii++;
+        }
+
+        putVarint(blocks, segLev.size());
+        ot::LevI prevLev = anchor.getLevel();
+        for (size_t s = 0; s < segLev.size(); s++)
+        {
+          putVarint(blocks, zigzag((int64_t) segLev[s] - (int64_t) prevLev));
+          putVarint(blocks, segLeaves[s]);
+          prevLev = segLev[s];
+        }
+      }
+
+      return 0;
+    }
+
+
+    //
+    // decode()
+    //
+    template <typename T, unsigned int dim>
+    int CompactTreeIO<T,dim>::decode(const char *begin, const char *end, std::vector<ot::TreeNode<T,dim>> &tree)
+    {
+      constexpr ot::RankI numChildren = ot::TreeNode<T,dim>::numChildren;
+      std::vector<ot::ChildI> cur(m_uiMaxDepth + 1);
+
+      const char *p = begin;
+      while (p < end)
+      {
+        uint64_t anchorLev, numSegments;
+        std::array<T,dim> coords;
+        if (!getVarint(p, end, anchorLev) || anchorLev > m_uiMaxDepth)
+          return 1;
+        for (unsigned int d = 0; d < dim; d++)
+        {
+          uint64_t x;
+          if (!getVarint(p, end, x))
+            return 1;
+          coords[d] = (T) x;
+        }
+        const ot::TreeNode<T,dim> anchor(coords, (unsigned int) anchorLev);
+        if (!ot::SFC_Search<T,dim>::getSFCDigits(anchor, anchorLev, cur.data()))
+          return 1;
+        if (!getVarint(p, end, numSegments))
+          return 1;
+
+        ot::LevI lev = anchorLev;
+        bool isAnchor = true;
+        for (uint64_t s = 0; s < numSegments; s++)
+        {
+          uint64_t levDelta, segLeaves;
+          if (!getVarint(p, end, levDelta) || !getVarint(p, end, segLeaves))
+            return 1;
+          const int64_t segLev = (int64_t) lev + unzigzag(levDelta);
+          if (segLev < 0 || segLev > (int64_t) m_uiMaxDepth)
+            return 1;
+
+          for (uint64_t k = 0; k < segLeaves; k++)
+          {
+            if (isAnchor)
+            {
+              tree.push_back(anchor);
+              isAnchor = false;
+              continue;
+            }
+            advanceSFCDigits(cur.data(), lev, numChildren);
+            for (ot::LevI l = lev + 1; l <= (ot::LevI) segLev; l++)
+              cur[l] = 0;
+            lev = segLev;
+            tree.push_back(cellFromSFCDigits<T,dim>(cur.data(), lev));
+          }
+        }
+      }
+
+      return 0;
+    }
+
+
+    //
+    // write()
+    //
+    template <typename T, unsigned int dim>
+    int CompactTreeIO<T,dim>::write(const char *fName, const ot::TreeNode<T,dim> *tree, size_t numLeaves, unsigned int blockLeaves)
+    {
+      std::vector<char> blocks;
+      std::vector<CompactBlockIndex> index;
+      if (encode(tree, numLeaves, blockLeaves, blocks, index))
+        return 1;
+
+      const CompactTreeHeader header = makeCompactHeader<T,dim>(numLeaves, index.size(), blocks.size(), blockLeaves);
+
+      FILE *outfile = fopen(fName, "wb");
+      if (outfile == NULL)
+      {
+        std::cout << fName << " file open failed " << std::endl;
+        return 1;
+      }
+      fwrite(&header, sizeof(header), 1, outfile);
+      fwrite(index.data(), sizeof(CompactBlockIndex), index.size(), outfile);
+      fwrite(blocks.data(), 1, blocks.size(), outfile);
+      const int err = ferror(outfile);
+      fclose(outfile);
+      return (err != 0);
+    }
+
+
+    //
+    // read()
+    //
+    template <typename T, unsigned int dim>
+    int CompactTreeIO<T,dim>::read(const char *fName, std::vector<ot::TreeNode<T,dim>> &tree)
+    {
+      tree.clear();
+
+      FILE *infile = fopen(fName, "rb");
+      if (infile == NULL)
+      {
+        std::cout << fName << " file open failed " << std::endl;
+        return 1;
+      }
+
+      CompactTreeHeader header;
+      memset(&header, 0, sizeof(header));
+      int err = (fread(&header, sizeof(header), 1, infile) != 1);
+      err = err || !checkCompactHeader<T,dim>(header, fName);
+
+      std::vector<char> blocks;
+      if (!err)
+      {
+        blocks.resize(header.m_numBytes);
+        err = fseek(infile, sizeof(header) + header.m_numBlocks * sizeof(CompactBlockIndex), SEEK_SET) != 0;
+        err = err || (fread(blocks.data(), 1, blocks.size(), infile) != blocks.size());
+      }
+      fclose(infile);
+
+      if (!err)
+      {
+        tree.reserve(header.m_numLeaves);
+        err = decode(blocks.data(), blocks.data() + blocks.size(), tree);
+        err = err || (tree.size() != header.m_numLeaves);
+      }
+      if (err)
+        std::cout << fName << " compact tree read failed " << std::endl;
+      return err;
+    }
+
+
+    //
+    // dist_write()
+    //
+    template <typename T, unsigned int dim>
+    int CompactTreeIO<T,dim>::dist_write(const char *fName, const ot::TreeNode<T,dim> *tree, size_t numLocal,
+                                         MPI_Comm comm, unsigned int blockLeaves)
+    {
+      int rank;
+      MPI_Comm_rank(comm, &rank);
+
+      std::vector<char> blocks;
+      std::vector<CompactBlockIndex> index;
+      int localFailed = encode(tree, numLocal, blockLeaves, blocks, index);
+
+      // Leaves, blocks, bytes.
+      uint64_t counts[3] = {numLocal, index.size(), blocks.size()};
+      uint64_t begins[3] = {0, 0, 0}, totals[3] = {0, 0, 0};
+      MPI_Exscan(counts, begins, 3, MPI_UINT64_T, MPI_SUM, comm);
+      if (!rank)
+        begins[0] = begins[1] = begins[2] = 0;   // Undefined after MPI_Exscan().
+      MPI_Allreduce(counts, totals, 3, MPI_UINT64_T, MPI_SUM, comm);
+
+      for (CompactBlockIndex &entry : index)
+      {
+        entry.m_leafBegin += begins[0];
+        entry.m_byteBegin += begins[2];
+      }
+
+      const CompactTreeHeader header = makeCompactHeader<T,dim>(totals[0], totals[1], totals[2], blockLeaves);
+      const MPI_Offset indexOffset = sizeof(header) + (MPI_Offset) begins[1] * sizeof(CompactBlockIndex);
+      const MPI_Offset blocksOffset = sizeof(header) + (MPI_Offset) totals[1] * sizeof(CompactBlockIndex) + begins[2];
+
+      // An existing, longer file would keep its tail after we write.
+      if (!rank)
+        MPI_File_delete(fName, MPI_INFO_NULL);
+      MPI_Barrier(comm);
+
+      MPI_File file;
+      if (MPI_File_open(comm, fName, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+      {
+        if (!rank)
+          std::cout << fName << " file open failed " << std::endl;
+        return 1;
+      }
+
+      if (!rank)
+        localFailed |= (MPI_File_write_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+      localFailed |= (MPI_File_write_at_all(file, indexOffset, index.data(), (int) (index.size() * sizeof(CompactBlockIndex)),
+                                            MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+      localFailed |= (MPI_File_write_at_all(file, blocksOffset, blocks.data(), (int) blocks.size(),
+                                            MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+      MPI_File_close(&file);
+
+      int globFailed = 0;
+      MPI_Allreduce(&localFailed, &globFailed, 1, MPI_INT, MPI_MAX, comm);
+      if (globFailed && !rank)
+        std::cout << fName << " compact tree write failed " << std::endl;
+      return globFailed;
+    }
+
+
+    //
+    // dist_read()
+    //
+    template <typename T, unsigned int dim>
+    int CompactTreeIO<T,dim>::dist_read(const char *fName, std::vector<ot::TreeNode<T,dim>> &tree,
+                                        MPI_Comm comm, double loadFlexibility)
+    {
+      int rank, npes;
+      MPI_Comm_rank(comm, &rank);
+      MPI_Comm_size(comm, &npes);
+
+      tree.clear();
+
+      MPI_File file;
+      if (MPI_File_open(comm, fName, MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+      {
+        if (!rank)
+          std::cout << fName << " file open failed " << std::endl;
+        return 1;
+      }
+
+      // Every proc reads the same header, so they agree on its validity.
+      CompactTreeHeader header;
+      memset(&header, 0, sizeof(header));
+      MPI_File_read_at_all(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+      if (!checkCompactHeader<T,dim>(header, fName))
+      {
+        MPI_File_close(&file);
+        return 1;
+      }
+
+      // Our blocks, and the index entry after them for where they end.
+      const uint64_t numBlocks = header.m_numBlocks;
+      const uint64_t blockBegin = numBlocks * rank / npes;
+      const uint64_t blockEnd = numBlocks * (rank + 1) / npes;
+      const uint64_t numEntries = (blockBegin < blockEnd ? blockEnd - blockBegin + (blockEnd < numBlocks) : 0);
+
+      std::vector<CompactBlockIndex> index(numEntries);
+      int localFailed = 0;
+      localFailed |= (MPI_File_read_at_all(file, sizeof(header) + (MPI_Offset) blockBegin * sizeof(CompactBlockIndex),
+                                           index.data(), (int) (numEntries * sizeof(CompactBlockIndex)),
+                                           MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+
+      uint64_t byteBegin = 0, byteEnd = 0, leafBegin = 0, leafEnd = 0;
+      if (numEntries > 0)
+      {
+        byteBegin = index.front().m_byteBegin;
+        leafBegin = index.front().m_leafBegin;
+        byteEnd = (blockEnd < numBlocks ? index.back().m_byteBegin : header.m_numBytes);
+        leafEnd = (blockEnd < numBlocks ? index.back().m_leafBegin : header.m_numLeaves);
+      }
+
+      std::vector<char> blocks(byteEnd - byteBegin);
+      localFailed |= (MPI_File_read_at_all(file, sizeof(header) + (MPI_Offset) numBlocks * sizeof(CompactBlockIndex) + byteBegin,
+                                           blocks.data(), (int) blocks.size(),
+                                           MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+      MPI_File_close(&file);
+
+      if (!localFailed)
+      {
+        tree.reserve(leafEnd - leafBegin);
+        localFailed = decode(blocks.data(), blocks.data() + blocks.size(), tree);
+        localFailed = localFailed || (tree.size() != leafEnd - leafBegin);
+      }
+
+      int globFailed = 0;
+      MPI_Allreduce(&localFailed, &globFailed, 1, MPI_INT, MPI_MAX, comm);
+      if (globFailed)
+      {
+        if (!rank)
+          std::cout << fName << " compact tree read failed " << std::endl;
+        tree.clear();
+        return globFailed;
+      }
+
+      ot::SFC_Tree<T,dim>::distTreeSort(tree, loadFlexibility, comm);
+      return 0;
+    }
+
+}// end of namespace checkpoint
+}// end of namespace io
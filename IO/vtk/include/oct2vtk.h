@@ -12,6 +12,7 @@
 #define SFCSORTBENCH_OCT2VTK_H
 
 #define FNAME_LENGTH 256
+#define VTK_QUAD 9
 #define VTK_HEXAHEDRON 12
 
 #define DENDRO_NODE_COORD_TYPE "UInt32"
@@ -35,6 +36,10 @@
 #include "zlib.h"
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+#include <stdint.h>
 
 namespace io
 {
@@ -58,18 +63,27 @@ namespace io
 
 
 #ifdef DENDRO_VTU_ZLIB
-        static int vtk_write_compressed (FILE * vtkfile, char *numeric_data,size_t byte_length)
+#ifndef DENDRO_VTU_ZLIB_LEVEL
+#define DENDRO_VTU_ZLIB_LEVEL Z_BEST_COMPRESSION
+#endif
+
+        /**
+         * @brief writes numeric_data as zlib-compressed 32 KiB blocks, in the vtk compressed format
+         *        (header: number of blocks, block size, last block size, compressed block sizes).
+         * @param [in] level: zlib level, Z_BEST_SPEED (1) .. Z_BEST_COMPRESSION (9).
+         * @param [in] encode_base64: false writes header and blocks as raw binary (appended encoding="raw").
+         * @note The blocks are compressed concurrently with OpenMP, then written in order.
+         * */
+        static int vtk_write_compressed (FILE * vtkfile, char *numeric_data,size_t byte_length, int level = DENDRO_VTU_ZLIB_LEVEL, bool encode_base64 = true)
         {
-            int                 retval, fseek1, fseek2;
             size_t              iz;
             size_t              blocksize, lastsize;
-            size_t              theblock, numregularblocks, numfullblocks;
+            size_t              numregularblocks, numfullblocks;
             size_t              header_entries, header_size;
             size_t              code_length, base_length;
-            long                header_pos, final_pos;
-            char               *comp_data, *base_data;
-            uint32_t           *compression_header;
-            uLongf              comp_length;
+            uLong               bound;
+            int                 failed = 0;
+            char               *base_data;
             base64_encodestate  encode_state;
 
             /* compute block sizes */
@@ -80,88 +94,62 @@ namespace io
             header_entries = 3 + numfullblocks;
             header_size = header_entries * sizeof (uint32_t);
 
-            /* allocate compression and base64 arrays */
-            code_length = 2 * std::max (blocksize, header_size) + 4 + 1;
-            comp_data =(char*) malloc (code_length*sizeof(char));
-            base_data =(char*) malloc(code_length*sizeof(char));
+            /* compress all blocks, each into its own slot */
+            bound = compressBound ((uLong) blocksize);
+            std::vector<Bytef> comp_data (numfullblocks * bound);
+            std::vector<uLongf> comp_length (numfullblocks, bound);
+
+            #pragma omp parallel for schedule(dynamic) reduction(+:failed) if(numfullblocks > 1)
+            for (long theblock = 0; theblock < (long) numfullblocks; ++theblock) {
+                const size_t thissize = ((size_t) theblock < numregularblocks ? blocksize : lastsize);
+                failed += (compress2 (&comp_data[theblock * bound], &comp_length[theblock],
+                                      (const Bytef *) (numeric_data + theblock * blocksize),
+                                      (uLong) thissize, level) != Z_OK);
+            }
+            if (failed)
+                return -1;
 
-            /* figure out the size of the header and write a dummy */
-            compression_header = (uint32_t*)malloc (header_entries*sizeof(uint32_t));
+            std::vector<uint32_t> compression_header (header_entries);
             compression_header[0] = (uint32_t) numfullblocks;
             compression_header[1] = (uint32_t) blocksize;
             compression_header[2] = (uint32_t)
                     (lastsize > 0 || byte_length == 0 ? lastsize : blocksize);
             for (iz = 3; iz < header_entries; ++iz) {
-                compression_header[iz] = 0;
+                compression_header[iz] = (uint32_t) comp_length[iz - 3];
             }
+
+            if (!encode_base64) {
+                (void) fwrite (compression_header.data(), 1, header_size, vtkfile);
+                for (iz = 0; iz < numfullblocks; ++iz)
+                    (void) fwrite (&comp_data[iz * bound], 1, comp_length[iz], vtkfile);
+                return (ferror (vtkfile) ? -1 : 0);
+            }
+
+            /* header and data are base64-encoded separately */
+            code_length = 2 * std::max ((size_t) bound, header_size) + 4 + 1;
+            base_data = (char*) malloc (code_length*sizeof(char));
+
             base64_init_encodestate (&encode_state);
-            base_length = base64_encode_block ((char *) compression_header,
+            base_length = base64_encode_block ((char *) compression_header.data(),
                                                header_size, base_data, &encode_state);
             base_length +=
                     base64_encode_blockend (base_data + base_length, &encode_state);
             assert (base_length < code_length);
-            base_data[base_length] = '\0';
-            header_pos = ftell (vtkfile);
             (void) fwrite (base_data, 1, base_length, vtkfile);
 
-            /* write the regular data blocks */
             base64_init_encodestate (&encode_state);
-            for (theblock = 0; theblock < numregularblocks; ++theblock) {
-                comp_length = code_length;
-                retval = compress2 ((Bytef *) comp_data, &comp_length,
-                                    (const Bytef *) (numeric_data + theblock * blocksize),
-                                    (uLong) blocksize, Z_BEST_COMPRESSION);
-                assert (retval == Z_OK);
-                compression_header[3 + theblock] = comp_length;
-                base_length = base64_encode_block (comp_data, comp_length,
-                                                   base_data, &encode_state);
-                assert (base_length < code_length);
-                base_data[base_length] = '\0';
-                (void) fwrite (base_data, 1, base_length, vtkfile);
-            }
-
-            /* write odd-sized last block if necessary */
-            if (lastsize > 0) {
-                comp_length = code_length;
-                retval = compress2 ((Bytef *) comp_data, &comp_length,
-                                    (const Bytef *) (numeric_data + theblock * blocksize),
-                                    (uLong) lastsize, Z_BEST_COMPRESSION);
-                assert (retval == Z_OK);
-                compression_header[3 + theblock] = comp_length;
-                base_length = base64_encode_block (comp_data, comp_length,
+            for (iz = 0; iz < numfullblocks; ++iz) {
+                base_length = base64_encode_block ((char *) &comp_data[iz * bound], comp_length[iz],
                                                    base_data, &encode_state);
                 assert (base_length < code_length);
-                base_data[base_length] = '\0';
                 (void) fwrite (base_data, 1, base_length, vtkfile);
             }
-
-            /* write base64 end block */
             base_length = base64_encode_blockend (base_data, &encode_state);
             assert (base_length < code_length);
-            base_data[base_length] = '\0';
-            (void) fwrite (base_data, 1, base_length, vtkfile);
-
-            /* seek back, write header block, seek forward */
-            final_pos = ftell (vtkfile);
-            base64_init_encodestate (&encode_state);
-            base_length = base64_encode_block ((char *) compression_header,
-                                               header_size, base_data, &encode_state);
-            base_length +=
-                    base64_encode_blockend (base_data + base_length, &encode_state);
-            assert (base_length < code_length);
-            base_data[base_length] = '\0';
-            fseek1 = fseek (vtkfile, header_pos, SEEK_SET);
             (void) fwrite (base_data, 1, base_length, vtkfile);
-            fseek2 = fseek (vtkfile, final_pos, SEEK_SET);
 
-            /* clean up and return */
-            free (compression_header);
-            free (comp_data);
             free (base_data);
-            if (fseek1 != 0 || fseek2 != 0 || ferror (vtkfile)) {
-                return -1;
-            }
-            return 0;
+            return (ferror (vtkfile) ? -1 : 0);
         }
 #endif
 
@@ -264,8 +252,52 @@ namespace io
 
 
         /**
-        *@breif Writes the given octree to a binary vtu (in xml format) file.
-        * @param [in] pNodes: input nodes (must be 2- or 3-dimensional).
+         * @brief VTK orders the corners of quads and hexahedra counter-clockwise in each z-layer.
+         * @returns for VTK corner k, bit d set iff the corner is on the upper side of axis d.
+         * */
+        inline unsigned int vtk_corner_bits(unsigned int k)
+        {
+            return (((k & 1u) ^ ((k >> 1) & 1u)) | (k & 2u) | (k & 4u));
+        }
+
+
+        /**
+        *@brief Writes linear cells (quads or hexahedra) with point data to vtu files, one per rank, and a .pvtu index on rank 0.
+        * Arrays are written as appended data, zlib-compressed (vtk_write_compressed()) if DENDRO_VTU_ZLIB is defined.
+        * The appended data is raw binary, unless compressed without DENDRO_VTU_RAW (then base64).
+        * The file is assembled in memory and written with a few buffered writes.
+        * @param [in] fPrefix: vtu file prefix
+        * @param [in] cellDim: 2 (VTK_QUAD) or 3 (VTK_HEXAHEDRON).
+        * @param [in] numCells: number of local cells.
+        * @param [in] pointCoords: 3 coordinates for each of the (1<<cellDim) corners of each cell, corners in VTK order.
+        * @param [in] cellLevels: level of each cell, written as cell data (may be NULL).
+        * @param [in] numPointData: number of point variables.
+        * @param [in] pointDataNames: list of variable names.
+        * @param [in] pointData: per variable, one value for each corner of each cell.
+        * @param [in] comm : mpi communicator.
+        * */
+        template <typename T>
+        void cells2vtu(const char *fPrefix, unsigned int cellDim, unsigned int numCells, const double *pointCoords, const unsigned int *cellLevels,
+                       unsigned int numPointData, const char **pointDataNames, const T **pointData, MPI_Comm comm);
+
+
+        /**
+        *@brief Writes the same cells and point data as cells2vtu() to a single binary file <fPrefix>.bin with MPI-IO.
+        * The file holds one array after another (Position, connectivity, cell_level, mpi_rank, point data),
+        * each contiguous over all ranks; rank r writes its slab at the offset given by a prefix sum of numCells.
+        * Rank 0 writes <fPrefix>.json, listing the type, shape and byte offset of each array and the cells per rank,
+        * and <fPrefix>.xmf, an XDMF description of the same file.
+        * @param [in] cellLevels: as in cells2vtu(), but not optional.
+        * @return 0 on success. Collective on comm.
+        * */
+        template <typename T>
+        int cells2mpiio(const char *fPrefix, unsigned int cellDim, unsigned int numCells, const double *pointCoords, const unsigned int *cellLevels,
+                        unsigned int numPointData, const char **pointDataNames, const T **pointData, MPI_Comm comm);
+
+
+        /**
+        *@brief Writes the given octree to a binary vtu (in xml format) file.
+        * @param [in] pNodes: input nodes (must be 2- or 3-dimensional; see projectSliceKTree() for 4D).
         * @param [in] fPrefix: vtk file prefix
         * @param [in] comm : mpi communicator.
         * */
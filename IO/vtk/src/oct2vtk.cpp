@@ -10,6 +10,15 @@
 
 #include "oct2vtk.h"
 
+#include "json.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits.h>
+#include <stdio.h>
+#include <vector>
+
 // @masado (I don't know where these were defined in other versions of Dendro)
 #define m_uiDim 3
 #define NUM_CHILDREN (1 << m_uiDim)
@@ -1527,368 +1536,376 @@ namespace io
 ///         }
 
 
-        template <typename T, unsigned int D>
-        void oct2vtu(const ot::TreeNode<T,D> *pNodes,const unsigned int nSize,const char* fPrefix, MPI_Comm comm)
+        /** @brief VTK name of the scalar type of point data. */
+        static const char * vtk_type_name(const float *) { return DENDRO_NODE_VAR_FLOAT; }
+        static const char * vtk_type_name(const double *) { return DENDRO_NODE_VAR_DOUBLE; }
+
+        /**
+         * @brief Appends one data array (header and data) to the appended-data section.
+         * @returns the offset of the array within the section.
+         * */
+        static long vtk_append_array(FILE *appended, const char *numeric_data, size_t byte_length)
         {
-            using TreeNode = ot::TreeNode<T,D>;
+            const long offset = ftell(appended);
+#if defined(DENDRO_VTU_ZLIB) && defined(DENDRO_VTU_RAW)
+            vtk_write_compressed(appended, (char *) numeric_data, byte_length, DENDRO_VTU_ZLIB_LEVEL, false);
+#elif defined(DENDRO_VTU_ZLIB)
+            vtk_write_compressed(appended, (char *) numeric_data, byte_length, DENDRO_VTU_ZLIB_LEVEL, true);
+#else
+            /* VTK format used 32bit header info */
+            assert (byte_length <= (size_t) UINT32_MAX);
+            const uint32_t int_header = (uint32_t) byte_length;
+            (void) fwrite(&int_header, sizeof(int_header), 1, appended);
+            (void) fwrite(numeric_data, 1, byte_length, appended);
+#endif
+            return offset;
+        }
+
 
+        template <typename T>
+        void cells2vtu(const char *fPrefix, unsigned int cellDim, unsigned int numCells, const double *pointCoords, const unsigned int *cellLevels,
+                       unsigned int numPointData, const char **pointDataNames, const T **pointData, MPI_Comm comm)
+        {
             int rank,npes;
             MPI_Comm_rank(comm,&rank);
             MPI_Comm_size(comm,&npes);
 
-            unsigned int retval;
-
+            const unsigned int numCorners = 1u << cellDim;
+            const size_t num_vertices = (size_t) numCells * numCorners;
+            const uint8_t cellType = (cellDim == 2 ? VTK_QUAD : VTK_HEXAHEDRON);
 
-            char fname[FNAME_LENGTH];
-            char str[2048];
-            sprintf(fname,"%s_%d_%d.vtu",fPrefix,rank,npes);
-
-            fp=fopen(fname,"w+");
-            if(fp==NULL) {
-                std::cout << "rank: " << rank << "[IO Error]: Could not open the vtk file. " << std::endl;
+            // Assemble the appended data in memory, so that the offsets are known before the xml header.
+            char *appendedBuf = NULL;
+            size_t appendedSz = 0;
+            FILE *appended = open_memstream(&appendedBuf, &appendedSz);
+            if (appended == NULL) {
+                std::cout << "rank: " << rank << "[IO Error]: Could not allocate the vtu buffer. " << std::endl;
                 return ;
             }
 
-
-            unsigned int dim=D;
-            DendroIntL num_vertices=nSize*NUM_CHILDREN;
-            unsigned int num_cells=nSize;
-            unsigned int sz;
-
-            fprintf(fp,"<?xml version=\"1.0\"?>\n");
-            fprintf(fp,"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
-#ifdef DENDRO_VTU_ZLIB
-            fprintf(fp," compressor=\"vtkZLibDataCompressor\"");
-#endif
-            fprintf(fp," byte_order=\"LittleEndian\">\n");
-            fprintf(fp,"  <UnstructuredGrid>\n");
-
-
-            fprintf(fp,"    <Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%d\">\n",(long long) num_vertices,num_cells);
-
-            fprintf(fp,"      <Points>\n");
-
-
-#ifdef DENDRO_VTU_ASCII
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"Position\""" NumberOfComponents=\"3\" format=\"%s\">\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_ASCII);
-#else
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"Position\""" NumberOfComponents=\"3\" format=\"%s\">\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_BINARY);
-#endif
-
-
-            fprintf(fp,"          ");
-
-            const unsigned int nx=2;
-            const unsigned int ny=2;
-            const unsigned int nz=2;
-
-
-#ifdef DENDRO_VTU_ASCII
-            for(unsigned int ele=0;ele<nSize;ele++) {
-                sz = 1u << (m_uiMaxDepth - pNodes[ele].getLevel());
-                /// assert((sz % eleOrder) == 0);    // @masado: eleOrder was not defined, but I think it would be 1 anyway.
-                std::array<T,D> eleCoords;
-                pNodes[ele].getAnchor(eleCoords);
-                if (D < 3)
-                  eleCoords.back() = 0;
-                for(unsigned int k=0;k<nz;k++)
-                   for(unsigned int j=0;j<ny;j++)
-                     for(unsigned int i=0;i<nx;i++) {
-                            fprintf(fp, "          %d %d %d\n", (eleCoords[0] + i * sz), (eleCoords[1] + j * sz), (eleCoords[2] + k * sz));
-                        }
-            }
-#else
-
-            unsigned int* coord_data = new unsigned int[num_vertices*m_uiDim];
-
-
-            for(unsigned int ele=0;ele<nSize;ele++) {
-
-                sz = 1u << (m_uiMaxDepth - pNodes[ele].getLevel());
-
-                std::array<T,D> eleCoords;
-                pNodes[ele].getAnchor(eleCoords);
-                if (D < 3)
-                  eleCoords.back() = 0;
-
-                for(unsigned int k=0;k<nz;k++)
-                   for(unsigned int j=0;j<ny;j++)
-                     for(unsigned int i=0;i<nx;i++)
-                     {
-                         coord_data[((ele)*NUM_CHILDREN+k*ny*nx+j*nx+i)*m_uiDim + 0]=(eleCoords[0]+i*sz);
-                         coord_data[((ele)*NUM_CHILDREN+k*ny*nx+j*nx+i)*m_uiDim + 1]=(eleCoords[1]+j*sz);
-                         coord_data[((ele)*NUM_CHILDREN+k*ny*nx+j*nx+i)*m_uiDim + 2]=(eleCoords[2]+k*sz);
-                     }
-
-
-            }
-
-            retval = vtk_write_binary (fp, (char *) coord_data, sizeof (*coord_data) * m_uiDim * num_vertices);
-            if (retval) {
-
-                std::cout<<rank<<": [VTU Error]: "<<"base64 encode point data failed"<<std::endl;
-                fclose(fp);
-
-            }
-            delete [] coord_data;
-#endif
-
-            fprintf(fp,"\n");
-
-            fprintf(fp,"        </DataArray>\n");
-            fprintf(fp,"      </Points>\n");
-            fprintf(fp,"      <Cells>\n");
-
-
-#ifdef  DENDRO_VTU_ASCII
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"connectivity\""  " format=\"%s\">\n",DENDRO_NODE_ID_TYPE,DENDRO_FORMAT_ASCII);
-#else
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"connectivity\""  " format=\"%s\">\n",DENDRO_NODE_ID_TYPE,DENDRO_FORMAT_BINARY);
-#endif
-
-
-
-            for (unsigned int i = 0 ; i < num_cells ; i++)
+            long offPoints, offConnectivity, offOffsets, offTypes, offRank, offLevel = 0;
+            std::vector<long> offPointData(numPointData);
+            offPoints = vtk_append_array(appended, (const char *) pointCoords, sizeof(double) * 3 * num_vertices);
             {
-
-
-#ifdef  DENDRO_VTU_ASCII
-                fprintf(fp,"          %lld %lld %lld %lld %lld %lld %lld %lld\n",
-                        (DendroIntL)(i * nx*ny*nz + 0*ny*nx+0*nx+0),
-                        (DendroIntL)(i * nx*ny*nz + 0*ny*nx+0*nx+1),
-                        (DendroIntL)(i * nx*ny*nz + 0*ny*nx+1*nx+1),
-                        (DendroIntL)(i * nx*ny*nz + 0*ny*nx+1*nx+0),
-                        (DendroIntL)(i * nx*ny*nz + 1*ny*nx+0*nx+0),
-                        (DendroIntL)(i * nx*ny*nz + 1*ny*nx+0*nx+1),
-                        (DendroIntL)(i * nx*ny*nz + 1*ny*nx+1*nx+1),
-                        (DendroIntL)(i * nx*ny*nz + 1*ny*nx+1*nx+0));
-
-#else
-
-
-                DendroIntL * locidx_data =new DendroIntL [num_cells*NUM_CHILDREN];
-                for (unsigned int i = 0 ; i < num_cells ; i++)
-                {
-                    locidx_data[i*NUM_CHILDREN+0]=(DendroIntL)(i * nx*ny*nz + 0*ny*nx+0*nx+0);
-                    locidx_data[i*NUM_CHILDREN+1]=(DendroIntL)(i * nx*ny*nz + 0*ny*nx+0*nx+1);
-                    locidx_data[i*NUM_CHILDREN+2]=(DendroIntL)(i * nx*ny*nz + 0*ny*nx+1*nx+1);
-                    locidx_data[i*NUM_CHILDREN+3]=(DendroIntL)(i * nx*ny*nz + 0*ny*nx+1*nx+0);
-                    locidx_data[i*NUM_CHILDREN+4]=(DendroIntL)(i * nx*ny*nz + 1*ny*nx+0*nx+0);
-                    locidx_data[i*NUM_CHILDREN+5]=(DendroIntL)(i * nx*ny*nz + 1*ny*nx+0*nx+1);
-                    locidx_data[i*NUM_CHILDREN+6]=(DendroIntL)(i * nx*ny*nz + 1*ny*nx+1*nx+1);
-                    locidx_data[i*NUM_CHILDREN+7]=(DendroIntL)(i * nx*ny*nz + 1*ny*nx+1*nx+0);
-
-                }
-                retval = vtk_write_binary (fp, (char *) locidx_data, sizeof (*locidx_data) * NUM_CHILDREN * num_cells);
-                if (retval) {
-
-                    std::cout<<rank<<": [VTU Error]: "<<"base64 encode connectivity data failed"<<std::endl;
-                    fclose(fp);
-
-                }
-                delete [] locidx_data;
-
-
-#endif
-
-            }
-
-            fprintf(fp,"\n");
-            fprintf(fp,"        </DataArray>\n");
-
-
-
-#ifdef DENDRO_VTU_ASCII
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"offsets\"" " format=\"%s\">\n",DENDRO_NODE_ID_TYPE,DENDRO_FORMAT_ASCII);
-            fprintf(fp,"         ");
-            for (unsigned int il = 1,sk = 1; il <= num_cells; ++il, ++sk) {
-                fprintf(fp," %lld",(NUM_CHILDREN*il));
-                if (!(sk % 8) && il != num_cells)
-                    fprintf(fp,"\n         ");
+                std::vector<DendroIntL> locidx_data(num_vertices);
+                for (size_t ii = 0; ii < num_vertices; ii++)
+                    locidx_data[ii] = ii;
+                offConnectivity = vtk_append_array(appended, (const char *) locidx_data.data(), sizeof(DendroIntL) * num_vertices);
+
+                std::vector<DendroIntL> loc_offset(numCells);
+                for (unsigned int il = 0; il < numCells; il++)
+                    loc_offset[il] = (DendroIntL) numCorners * (il + 1);
+                offOffsets = vtk_append_array(appended, (const char *) loc_offset.data(), sizeof(DendroIntL) * numCells);
+
+                std::vector<uint8_t> loc_type(numCells, cellType);
+                offTypes = vtk_append_array(appended, (const char *) loc_type.data(), numCells);
             }
-            fprintf(fp,"\n");
-#else
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"offsets\"" " format=\"%s\">\n",DENDRO_NODE_ID_TYPE,DENDRO_FORMAT_BINARY);
-
-            DendroIntL * loc_offset=new DendroIntL [num_cells];
-            for (unsigned int il = 1; il <= (num_cells); il++)
-                loc_offset[il-1]=NUM_CHILDREN*il;
-
-            retval = vtk_write_binary (fp, (char *) loc_offset, sizeof (*loc_offset) *(num_cells));
-            if (retval) {
-
-                std::cout<<rank<<": [VTU Error]: "<<"base64 encode offset data failed"<<std::endl;
-                fclose(fp);
+            {
+                std::vector<unsigned int> loc_rank(numCells, rank);
+                offRank = vtk_append_array(appended, (const char *) loc_rank.data(), sizeof(unsigned int) * numCells);
+                if (cellLevels != NULL)
+                    offLevel = vtk_append_array(appended, (const char *) cellLevels, sizeof(unsigned int) * numCells);
             }
-            delete [] loc_offset;
-
-#endif
-
-
-
-            fprintf(fp,"\n        </DataArray>\n");
-
+            for (unsigned int v = 0; v < numPointData; v++)
+                offPointData[v] = vtk_append_array(appended, (const char *) pointData[v], sizeof(T) * num_vertices);
 
+            fclose(appended);
 
-#ifdef DENDRO_VTU_ASCII
-            fprintf (fp, "        <DataArray type=\"UInt8\" Name=\"types\"" " format=\"%s\">\n", DENDRO_FORMAT_ASCII);
-            fprintf(fp,"         ");
-            for (unsigned int il = 0, sk = 1; il < num_cells; ++il, ++sk) {
-                fprintf (fp, " %d",VTK_HEXAHEDRON);
-                if (!(sk % 20) && il != (num_cells - 1))
-                    fprintf(fp,"\n         ");
-            }
-            fprintf(fp,"\n");
+#if defined(DENDRO_VTU_ZLIB) && !defined(DENDRO_VTU_RAW)
+            const char *encoding = "base64";
 #else
-            fprintf (fp, "        <DataArray type=\"UInt8\" Name=\"types\"" " format=\"%s\">\n", DENDRO_FORMAT_BINARY);
-            uint8_t  * loc_type=new uint8_t [num_cells];
-            for (unsigned int il = 0; il < num_cells; ++il)
-                loc_type[il]=VTK_HEXAHEDRON;
-
-            retval = vtk_write_binary (fp, (char *) loc_type, sizeof (*loc_type) *num_cells);
-            if (retval) {
-
-                std::cout<<rank<<": [VTU Error]: "<<"base64 encode element type data failed"<<std::endl;
-                fclose(fp);
-            }
-            delete [] loc_type;
-
+            const char *encoding = "raw";
 #endif
 
-            fprintf(fp,"        </DataArray>\n");
-            fprintf(fp,"      </Cells>\n");
-
-            // writing cell data
-            fprintf(fp,"      <CellData>\n");
-
-#ifdef DENDRO_VTU_ASCII
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"mpi_rank\"" " format=\"%s\">\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_ASCII);
-            fprintf (fp,"         ");
-            for (unsigned int il = 0; il < num_cells; ++il) {
-                fprintf(fp,"%d ",rank);
-            }
-            fprintf(fp,"\n");
-#else
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"mpi_rank\"" " format=\"%s\">\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_BINARY);
-
-            unsigned int * loc_rank=new unsigned int [num_cells];
-            for (unsigned int il = 0; il < num_cells; ++il)
-                loc_rank[il]=rank;
-
-            retval = vtk_write_binary (fp, (char *) loc_rank, sizeof (*loc_rank)*num_cells);
-            if (retval) {
-
-                std::cout<<rank<<": [VTU Error]: "<<"base64 encode element rank data failed"<<std::endl;
-                fclose(fp);
-            }
-            delete [] loc_rank;
-#endif
-
-            fprintf(fp,"        </DataArray>\n");
-
+            char fname[FNAME_LENGTH];
+            sprintf(fname,"%s_%d_%d.vtu",fPrefix,rank,npes);
 
-#ifdef DENDRO_VTU_ASCII
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"cell_level\"" " format=\"%s\">\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_ASCII);
-            fprintf(fp,"         ");
-            for (unsigned int il = 0; il < num_cells; ++il) {
-                fprintf(fp,"%d ",pNodes[il].getLevel());
+            FILE *vtu = fopen(fname,"w");
+            if(vtu==NULL) {
+                std::cout << "rank: " << rank << "[IO Error]: Could not open the vtk file. " << std::endl;
+                free(appendedBuf);
+                return ;
             }
-            fprintf(fp,"\n");
-#else
-            fprintf(fp,"        <DataArray type=\"%s\" Name=\"cell_level\"" " format=\"%s\">\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_BINARY);
-
-            unsigned int * loc_level=new unsigned int [num_cells];
-            for (unsigned int il = 0; il < num_cells; ++il)
-                loc_level[il]=pNodes[il].getLevel();
-
-            retval = vtk_write_binary (fp, (char *) loc_level, sizeof (*loc_level)*num_cells);
-            if (retval) {
+            std::vector<char> ioBuf(1u << 20);
+            setvbuf(vtu, ioBuf.data(), _IOFBF, ioBuf.size());
 
-                std::cout<<rank<<": [VTU Error]: "<<"base64 encode element level data failed"<<std::endl;
-                fclose(fp);
-            }
-            delete [] loc_level;
+            fprintf(vtu,"<?xml version=\"1.0\"?>\n");
+            fprintf(vtu,"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\"");
+#ifdef DENDRO_VTU_ZLIB
+            fprintf(vtu," compressor=\"vtkZLibDataCompressor\"");
 #endif
-
-
-            fprintf(fp,"        </DataArray>\n");
-            fprintf(fp,"      </CellData>\n");
-            fprintf(fp,"</Piece>\n");
-            fprintf(fp,"</UnstructuredGrid>\n");
-            fprintf(fp,"</VTKFile>\n");
-
-            fclose(fp);
-            fp=NULL;
+            fprintf(vtu," byte_order=\"LittleEndian\" header_type=\"UInt32\">\n");
+            fprintf(vtu,"  <UnstructuredGrid>\n");
+            fprintf(vtu,"    <Piece NumberOfPoints=\"%llu\" NumberOfCells=\"%u\">\n",(unsigned long long) num_vertices,numCells);
+            fprintf(vtu,"      <Points>\n");
+            fprintf(vtu,"        <DataArray type=\"%s\" Name=\"Position\" NumberOfComponents=\"3\" format=\"appended\" offset=\"%ld\"/>\n",DENDRO_NODE_VAR_DOUBLE,offPoints);
+            fprintf(vtu,"      </Points>\n");
+            fprintf(vtu,"      <Cells>\n");
+            fprintf(vtu,"        <DataArray type=\"%s\" Name=\"connectivity\" format=\"appended\" offset=\"%ld\"/>\n",DENDRO_NODE_ID_TYPE,offConnectivity);
+            fprintf(vtu,"        <DataArray type=\"%s\" Name=\"offsets\" format=\"appended\" offset=\"%ld\"/>\n",DENDRO_NODE_ID_TYPE,offOffsets);
+            fprintf(vtu,"        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\"%ld\"/>\n",offTypes);
+            fprintf(vtu,"      </Cells>\n");
+            fprintf(vtu,"      <CellData>\n");
+            fprintf(vtu,"        <DataArray type=\"%s\" Name=\"mpi_rank\" format=\"appended\" offset=\"%ld\"/>\n",DENDRO_NODE_VAR_INT,offRank);
+            if (cellLevels != NULL)
+                fprintf(vtu,"        <DataArray type=\"%s\" Name=\"cell_level\" format=\"appended\" offset=\"%ld\"/>\n",DENDRO_NODE_VAR_INT,offLevel);
+            fprintf(vtu,"      </CellData>\n");
+            fprintf(vtu,"      <PointData>\n");
+            for (unsigned int v = 0; v < numPointData; v++)
+                fprintf(vtu,"        <DataArray type=\"%s\" Name=\"%s\" format=\"appended\" offset=\"%ld\"/>\n",vtk_type_name(pointData[v]),pointDataNames[v],offPointData[v]);
+            fprintf(vtu,"      </PointData>\n");
+            fprintf(vtu,"    </Piece>\n");
+            fprintf(vtu,"  </UnstructuredGrid>\n");
+            fprintf(vtu,"  <AppendedData encoding=\"%s\">\n_",encoding);
+            (void) fwrite(appendedBuf, 1, appendedSz, vtu);
+            fprintf(vtu,"\n  </AppendedData>\n");
+            fprintf(vtu,"</VTKFile>\n");
+
+            if (ferror(vtu))
+                std::cout<<rank<<": [VTU Error]: "<<"writing "<<fname<<" failed"<<std::endl;
+            fclose(vtu);
+            free(appendedBuf);
 
             if(!rank) {
                 sprintf(fname, "%s.pvtu", fPrefix);
 
-                fp = fopen(fname, "w+");
-                if (fp == NULL) {
+                FILE *pvtu = fopen(fname, "w");
+                if (pvtu == NULL) {
                     std::cout << "rank: " << rank << "[IO Error]: Could not open the pvtu file. " << std::endl;
                     return;
                 }
 
-
-                fprintf(fp,"<?xml version=\"1.0\"?>\n");
-                fprintf(fp,"<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\"");
+                fprintf(pvtu,"<?xml version=\"1.0\"?>\n");
+                fprintf(pvtu,"<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\"");
 #ifdef DENDRO_VTU_ZLIB
-                fprintf(fp," compressor=\"vtkZLibDataCompressor\"");
+                fprintf(pvtu," compressor=\"vtkZLibDataCompressor\"");
 #endif
-                fprintf(fp," byte_order=\"LittleEndian\">\n");
-
-                fprintf(fp,"  <PUnstructuredGrid GhostLevel=\"0\">\n");
+                fprintf(pvtu," byte_order=\"LittleEndian\" header_type=\"UInt32\">\n");
+                fprintf(pvtu,"  <PUnstructuredGrid GhostLevel=\"0\">\n");
+                fprintf(pvtu,"    <PPoints>\n");
+                fprintf(pvtu,"      <PDataArray type=\"%s\" Name=\"Position\" NumberOfComponents=\"3\"/>\n",DENDRO_NODE_VAR_DOUBLE);
+                fprintf(pvtu,"    </PPoints>\n");
+                fprintf(pvtu,"    <PCellData>\n");
+                fprintf(pvtu,"      <PDataArray type=\"%s\" Name=\"mpi_rank\"/>\n",DENDRO_NODE_VAR_INT);
+                if (cellLevels != NULL)
+                    fprintf(pvtu,"      <PDataArray type=\"%s\" Name=\"cell_level\"/>\n",DENDRO_NODE_VAR_INT);
+                fprintf(pvtu,"    </PCellData>\n");
+                fprintf(pvtu,"    <PPointData>\n");
+                for (unsigned int v = 0; v < numPointData; v++)
+                    fprintf(pvtu,"      <PDataArray type=\"%s\" Name=\"%s\"/>\n",vtk_type_name(pointData[v]),pointDataNames[v]);
+                fprintf(pvtu,"    </PPointData>\n");
 
+                std::string vtuName=getFileName(std::string(fPrefix));
+                for(unsigned int proc=0;proc<npes;proc++)
+                    fprintf(pvtu,"    <Piece Source=\"%s_%d_%d.vtu\"/>\n",vtuName.c_str(),proc,npes);
 
-                fprintf(fp,"    <PPoints>\n");
+                fprintf(pvtu,"  </PUnstructuredGrid>\n");
+                fprintf(pvtu,"</VTKFile>\n");
+                fclose(pvtu);
+            }
+        }
 
-#ifdef DENDRO_VTU_ASCII
-                fprintf(fp,"      <PDataArray type=\"%s\" Name=\"Position\""" NumberOfComponents=\"3\" format=\"%s\"/>\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_ASCII);
-#else
-                fprintf(fp,"      <PDataArray type=\"%s\" Name=\"Position\""" NumberOfComponents=\"3\" format=\"%s\"/>\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_BINARY);
-#endif
+        // Template instantiation.
+        template void cells2vtu<float>(const char *, unsigned int, unsigned int, const double *, const unsigned int *, unsigned int, const char **, const float **, MPI_Comm);
+        template void cells2vtu<double>(const char *, unsigned int, unsigned int, const double *, const unsigned int *, unsigned int, const char **, const double **, MPI_Comm);
 
 
+        template <typename T>
+        int cells2mpiio(const char *fPrefix, unsigned int cellDim, unsigned int numCells, const double *pointCoords, const unsigned int *cellLevels,
+                        unsigned int numPointData, const char **pointDataNames, const T **pointData, MPI_Comm comm)
+        {
+            int rank,npes;
+            MPI_Comm_rank(comm,&rank);
+            MPI_Comm_size(comm,&npes);
 
-                fprintf(fp,"    </PPoints>\n");
-                fprintf(fp,"    <PCellData>\n");
+            const unsigned int numCorners = 1u << cellDim;
+            const uint64_t numLocalPoints = (uint64_t) numCells * numCorners;
+
+            uint64_t cellBegin = 0, numGlobalCells = 0, numLocalCells = numCells;
+            MPI_Exscan(&numLocalCells, &cellBegin, 1, MPI_UINT64_T, MPI_SUM, comm);
+            if (!rank)
+                cellBegin = 0;   // Undefined after MPI_Exscan().
+            MPI_Allreduce(&numLocalCells, &numGlobalCells, 1, MPI_UINT64_T, MPI_SUM, comm);
+            const uint64_t pointBegin = cellBegin * numCorners;
+            const uint64_t numGlobalPoints = numGlobalCells * numCorners;
+
+            // Arrays in file order; an entry is the data of one point or of one cell.
+            struct ArrayDesc { std::string name; const char *type; unsigned int components; size_t entryBytes; bool isCellData; const char *data; };
+            std::vector<ArrayDesc> arrays;
+
+            std::vector<uint64_t> connectivity(numLocalPoints);
+            for (uint64_t ii = 0; ii < numLocalPoints; ii++)
+                connectivity[ii] = pointBegin + ii;
+            std::vector<unsigned int> loc_rank(numCells, rank);
+
+            arrays.push_back({"Position", DENDRO_NODE_VAR_DOUBLE, 3, 3 * sizeof(double), false, (const char *) pointCoords});
+            arrays.push_back({"connectivity", "UInt64", numCorners, numCorners * sizeof(uint64_t), true, (const char *) connectivity.data()});
+            arrays.push_back({"cell_level", DENDRO_NODE_VAR_INT, 1, sizeof(unsigned int), true, (const char *) cellLevels});
+            arrays.push_back({"mpi_rank", DENDRO_NODE_VAR_INT, 1, sizeof(unsigned int), true, (const char *) loc_rank.data()});
+            for (unsigned int v = 0; v < numPointData; v++)
+                arrays.push_back({pointDataNames[v], vtk_type_name(pointData[v]), 1, sizeof(T), false, (const char *) pointData[v]});
 
-#ifdef DENDRO_VTU_ASCII
-                fprintf(fp,"        <PDataArray type=\"%s\" Name=\"mpi_rank\"" " format=\"%s\"/>\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_ASCII);
-#else
-                fprintf(fp,"        <PDataArray type=\"%s\" Name=\"mpi_rank\"" " format=\"%s\"/>\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_BINARY);
-#endif
+            char fname[FNAME_LENGTH];
+            sprintf(fname,"%s.bin",fPrefix);
+
+            // An existing, longer file would keep its tail after we write.
+            if (!rank)
+                MPI_File_delete(fname, MPI_INFO_NULL);
+            MPI_Barrier(comm);
+
+            MPI_File file;
+            if (MPI_File_open(comm, fname, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+                if (!rank)
+                    std::cout << "rank: " << rank << "[IO Error]: Could not open " << fname << std::endl;
+                return 1;
+            }
 
+            // MPI counts are int, so a large local array is written in several collective rounds.
+            // Every proc takes part in the same number of rounds, possibly writing nothing.
+            const uint64_t maxWriteEntries = INT_MAX;
+            uint64_t maxLocalPoints = 0;
+            MPI_Allreduce(&numLocalPoints, &maxLocalPoints, 1, MPI_UINT64_T, MPI_MAX, comm);
+            const uint64_t numRounds = (maxLocalPoints + maxWriteEntries - 1) / maxWriteEntries;
+
+            int localFailed = 0;
+            std::vector<uint64_t> arrayOffsets(arrays.size());
+            uint64_t fileOffset = 0;
+            for (size_t a = 0; a < arrays.size(); a++)
+            {
+                const uint64_t globalEntries = (arrays[a].isCellData ? numGlobalCells : numGlobalPoints);
+                const uint64_t entryBegin = (arrays[a].isCellData ? cellBegin : pointBegin);
+                const uint64_t localEntries = (arrays[a].isCellData ? numLocalCells : numLocalPoints);
+
+                MPI_Datatype entryType;
+                MPI_Type_contiguous(arrays[a].entryBytes, MPI_BYTE, &entryType);
+                MPI_Type_commit(&entryType);
+                arrayOffsets[a] = fileOffset;
+                for (uint64_t round = 0, written = 0; round < numRounds; round++)
+                {
+                    const uint64_t roundEntries = std::min(localEntries - written, maxWriteEntries);
+                    localFailed |= (MPI_File_write_at_all(file, fileOffset + (entryBegin + written) * arrays[a].entryBytes,
+                                                          arrays[a].data + written * arrays[a].entryBytes,
+                                                          (int) roundEntries, entryType, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+                    written += roundEntries;
+                }
+                MPI_Type_free(&entryType);
+                fileOffset += globalEntries * arrays[a].entryBytes;
+            }
+            MPI_File_close(&file);
 
+            std::vector<uint64_t> rankCells(npes);
+            MPI_Gather(&numLocalCells, 1, MPI_UINT64_T, rankCells.data(), 1, MPI_UINT64_T, 0, comm);
 
-#ifdef DENDRO_VTU_ASCII
-                fprintf(fp,"        <PDataArray type=\"%s\" Name=\"cell_level\"" " format=\"%s\"/>\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_ASCII);
-#else
-                fprintf(fp,"        <PDataArray type=\"%s\" Name=\"cell_level\"" " format=\"%s\"/>\n",DENDRO_NODE_COORD_TYPE,DENDRO_FORMAT_BINARY);
-#endif
-
-                fprintf(fp,"    </PCellData>\n");
-                std::string vtuName=getFileName(std::string(fPrefix));
-                for(unsigned int proc=0;proc<npes;proc++)
+            if (!rank)
+            {
+                const std::string binName = getFileName(std::string(fPrefix)) + ".bin";
+
+                nlohmann::json desc;
+                desc["format"] = "dendro-kt cells";
+                desc["version"] = 1;
+                desc["data_file"] = binName;
+                desc["byte_order"] = "LittleEndian";
+                desc["cell_type"] = (cellDim == 2 ? "quad" : "hexahedron");
+                desc["num_points"] = numGlobalPoints;
+                desc["num_cells"] = numGlobalCells;
+                desc["rank_cells"] = rankCells;
+                for (size_t a = 0; a < arrays.size(); a++)
                 {
-                    fprintf(fp,"<Piece Source=\"%s_%d_%d.vtu\"/>\n",vtuName.c_str(),proc,npes);
+                    nlohmann::json array;
+                    array["name"] = arrays[a].name;
+                    array["type"] = arrays[a].type;
+                    array["center"] = (arrays[a].isCellData ? "cell" : "point");
+                    array["shape"] = {(arrays[a].isCellData ? numGlobalCells : numGlobalPoints), arrays[a].components};
+                    array["offset"] = arrayOffsets[a];
+                    desc["arrays"].push_back(array);
+                }
 
+                sprintf(fname,"%s.json",fPrefix);
+                std::ofstream json(fname);
+                json << desc.dump(2) << std::endl;
+                localFailed |= !json.good();
+
+                // XDMF: Float/Int/UInt and precision in bytes for each array.
+                auto dataItem = [&](FILE *xmf, size_t a) {
+                    const std::string &type = arrays[a].type;
+                    const char *numberType = (type.compare(0, 5, "Float") == 0 ? "Float" : (type.compare(0, 4, "UInt") == 0 ? "UInt" : "Int"));
+                    const unsigned int precision = arrays[a].entryBytes / arrays[a].components;
+                    fprintf(xmf,"        <DataItem Dimensions=\"%llu %u\" NumberType=\"%s\" Precision=\"%u\" Format=\"Binary\" Endian=\"Little\" Seek=\"%llu\">%s</DataItem>\n",
+                            (unsigned long long) (arrays[a].isCellData ? numGlobalCells : numGlobalPoints), arrays[a].components,
+                            numberType, precision, (unsigned long long) arrayOffsets[a], binName.c_str());
+                };
+
+                sprintf(fname,"%s.xmf",fPrefix);
+                FILE *xmf = fopen(fname,"w");
+                if (xmf == NULL) {
+                    std::cout << "rank: " << rank << "[IO Error]: Could not open " << fname << std::endl;
+                    localFailed = 1;
                 }
-                fprintf(fp,"</PUnstructuredGrid>\n");
-                fprintf(fp,"</VTKFile>\n");
+                else {
+                    fprintf(xmf,"<?xml version=\"1.0\" ?>\n");
+                    fprintf(xmf,"<Xdmf Version=\"3.0\">\n");
+                    fprintf(xmf,"  <Domain>\n");
+                    fprintf(xmf,"    <Grid Name=\"%s\" GridType=\"Uniform\">\n",getFileName(std::string(fPrefix)).c_str());
+                    fprintf(xmf,"      <Topology TopologyType=\"%s\" NumberOfElements=\"%llu\">\n",(cellDim == 2 ? "Quadrilateral" : "Hexahedron"),(unsigned long long) numGlobalCells);
+                    dataItem(xmf, 1);
+                    fprintf(xmf,"      </Topology>\n");
+                    fprintf(xmf,"      <Geometry GeometryType=\"XYZ\">\n");
+                    dataItem(xmf, 0);
+                    fprintf(xmf,"      </Geometry>\n");
+                    for (size_t a = 2; a < arrays.size(); a++)
+                    {
+                        fprintf(xmf,"      <Attribute Name=\"%s\" AttributeType=\"Scalar\" Center=\"%s\">\n",arrays[a].name.c_str(),(arrays[a].isCellData ? "Cell" : "Node"));
+                        dataItem(xmf, a);
+                        fprintf(xmf,"      </Attribute>\n");
+                    }
+                    fprintf(xmf,"    </Grid>\n");
+                    fprintf(xmf,"  </Domain>\n");
+                    fprintf(xmf,"</Xdmf>\n");
+                    localFailed |= (ferror(xmf) != 0);
+                    fclose(xmf);
+                }
+            }
 
+            int globFailed = 0;
+            MPI_Allreduce(&localFailed, &globFailed, 1, MPI_INT, MPI_MAX, comm);
+            if (globFailed && !rank)
+                std::cout << "[IO Error]: writing " << fPrefix << ".bin failed" << std::endl;
+            return globFailed;
+        }
 
-                fclose(fp);
-                fp=NULL;
+        // Template instantiation.
+        template int cells2mpiio<float>(const char *, unsigned int, unsigned int, const double *, const unsigned int *, unsigned int, const char **, const float **, MPI_Comm);
+        template int cells2mpiio<double>(const char *, unsigned int, unsigned int, const double *, const unsigned int *, unsigned int, const char **, const double **, MPI_Comm);
 
 
-            }
+        template <typename T, unsigned int D>
+        void oct2vtu(const ot::TreeNode<T,D> *pNodes,const unsigned int nSize,const char* fPrefix, MPI_Comm comm)
+        {
+            static_assert(D == 2 || D == 3, "oct2vtu() writes 2D or 3D trees; see projectSliceKTree() for 4D.");
 
+            const unsigned int numCorners = 1u << D;
+            std::vector<double> coord_data(3 * numCorners * (size_t) nSize, 0.0);
+            std::vector<unsigned int> loc_level(nSize);
+
+            for(unsigned int ele=0;ele<nSize;ele++) {
+                const unsigned int sz = 1u << (m_uiMaxDepth - pNodes[ele].getLevel());
+                std::array<T,D> eleCoords;
+                pNodes[ele].getAnchor(eleCoords);
+                loc_level[ele] = pNodes[ele].getLevel();
 
+                for (unsigned int k = 0; k < numCorners; k++)
+                {
+                    const unsigned int bits = vtk_corner_bits(k);
+                    for (unsigned int d = 0; d < D; d++)
+                        coord_data[3 * ((size_t) ele * numCorners + k) + d] = eleCoords[d] + ((bits >> d) & 1u) * sz;
+                }
+            }
 
+            cells2vtu<double>(fPrefix, D, nSize, coord_data.data(), loc_level.data(), 0, NULL, NULL, comm);
         }
 
         // Template instantiation.
+        template void oct2vtu<unsigned int, 2>(const ot::TreeNode<unsigned int,2> *pNodes,const unsigned int nSize,const char* fPrefix, MPI_Comm comm);
         template void oct2vtu<unsigned int, 3>(const ot::TreeNode<unsigned int,3> *pNodes,const unsigned int nSize,const char* fPrefix, MPI_Comm comm);
 
 
@@ -17,8 +17,14 @@
 #include <assert.h>
 #include <mpi.h>
 #include "profiler.h"
+#include "profRegistry.h"
 #include <iostream>
 
+// The matvec columns come from regions profiled inside the library, which are not timed without it.
+#ifndef DENDRO_KT_PROFILE
+#error "matvec benchmarks need DENDRO_KT_PROFILE (link them to dendroKT_prof, see CMakeLists.txt)"
+#endif
+
 
     namespace bench
     {
@@ -27,17 +33,25 @@
         extern profiler_t t_adaptive_tbal;
         extern profiler_t t_adaptive_oda;
 
-        // For now, I will inject timing into the implementation.
-        extern profiler_t t_ghostexchange;
-        extern profiler_t t_topdown;
-        extern profiler_t t_bottomup;
-        extern profiler_t t_treeinterior;
-        extern profiler_t t_elemental;
-        extern profiler_t t_matvec;
-        
-        /**@breif reset all the extern counters defined here.. */
+        /**@breif reset all the extern counters defined here, and the profiled regions. */
         void resetAllTimers();
 
+        /**
+         * @brief: the local time and calls of a region profiled inside the library, e.g. "feMatrix::matVec/matvec".
+         * @note: needs DENDRO_KT_PROFILE (see profRegistry.h), which is checked above.
+         */
+        inline profiler_t regionTimer(const char *path)
+        {
+            profiler_t timer;
+            prof::RegionStats stats;
+            if (prof::getLocalStats(path, stats))
+            {
+                timer.seconds = stats.seconds;
+                timer.num_calls = stats.calls;
+            }
+            return timer;
+        }
+
 
         /**
          * @brief: performs the bench kernel node sort, tree construction and balancing. 
@@ -24,6 +24,7 @@
 #include "heatMat.h"
 #include "heatVec.h"
 
+#include <cstdlib>
 #include <cstring>
 
 
@@ -35,13 +36,6 @@ namespace bench
     profiler_t t_adaptive_tbal;
     profiler_t t_adaptive_oda;
 
-    profiler_t t_ghostexchange;
-    profiler_t t_topdown;
-    profiler_t t_bottomup;
-    profiler_t t_treeinterior;
-    profiler_t t_elemental;
-    profiler_t t_matvec;
-
 
 
     void resetAllTimers()
@@ -51,12 +45,7 @@ namespace bench
         t_adaptive_tbal.clear();
         t_adaptive_oda.clear();
 
-        t_ghostexchange.clear();
-        t_topdown.clear();
-        t_bottomup.clear();
-        t_treeinterior.clear();
-        t_elemental.clear();
-        t_matvec.clear();
+        prof::reset();
     }
 
     template <unsigned int dim>
@@ -108,7 +97,7 @@ namespace bench
 
                 // Generate DA from balanced tree.
                 t_adaptive_oda.start();
-                ot::DA<dim> oda(&(*tree.cbegin()), (unsigned) tree.size(), comm, eleOrder, numPts, loadFlexibility);
+                ot::DA<dim> oda(&(*tree.cbegin()), (unsigned) tree.size(), comm, eleOrder, 0, loadFlexibility);
                 t_adaptive_oda.stop();
             }
         }
@@ -174,11 +163,12 @@ namespace bench
             }
 
             // Clear the side effect of warmup.
-            t_ghostexchange.clear();
-            t_topdown.clear();
-            t_bottomup.clear();
-            t_treeinterior.clear();
-            t_elemental.clear();
+            prof::reset();
+
+            // Record a timeline of the benchmarked matvecs, merge with ./traceMerge.
+            const char *tracePrefix = getenv("DENDRO_KT_TRACE");
+            if (tracePrefix != NULL)
+                prof::traceBegin(tracePrefix, comm);
 
             // Benchmark the matvec.
             for (int ii = 0; ii < numRuns; ii++)
@@ -186,6 +176,9 @@ namespace bench
                 heatMat.matVec(ux, dummy, 1.0);
             }
 
+            if (tracePrefix != NULL)
+                prof::traceEnd();
+
             /// double tol=1e-6;
             /// unsigned int max_iter=1000;
             /// heatMat.cgSolve(ux,Mfrhs,max_iter,tol,0);
@@ -319,11 +312,10 @@ int main(int argc, char** argv)
         "bal", 
         "adaptive_oda", 
 
-        "matvec"
+        "matvec",
         "ghostexchange", 
         "topdown", 
         "bottomup", 
-        "treeinterior", 
         "elemental", 
     };
 
@@ -333,15 +325,14 @@ int main(int argc, char** argv)
         bench::t_adaptive_tbal, 
         bench::t_adaptive_oda, 
 
-        bench::t_matvec,
-        bench::t_ghostexchange, 
-        bench::t_topdown, 
-        bench::t_bottomup, 
-        bench::t_treeinterior, 
-        bench::t_elemental, 
+        bench::regionTimer("feMatrix::matVec/matvec"),
+        bench::regionTimer("feMatrix::matVec/ghostExchange"),
+        bench::regionTimer("feMatrix::matVec/matvec/top_down"),
+        bench::regionTimer("feMatrix::matVec/matvec/bottom_up"),
+        bench::regionTimer("feMatrix::matVec/matvec/elemental"),
     };
 
-    bench::dump_profile_info(std::cout, msgPrefix, params,param_names,2, counters,counter_names,10, comm);
+    bench::dump_profile_info(std::cout, msgPrefix, params,param_names,2, counters,counter_names,9, comm);
 
     _DestroyHcurve();
     MPI_Finalize();
@@ -35,13 +35,8 @@ namespace bench
     profiler_t t_adaptive_tconstr;
     profiler_t t_adaptive_tbal;
     profiler_t t_adaptive_oda;
+    ot::DAConstructTimers t_adaptive_oda_phases;   // Copied from the DA after construction.
 
-    profiler_t t_ghostexchange;
-    profiler_t t_topdown;
-    profiler_t t_bottomup;
-    profiler_t t_treeinterior;
-    profiler_t t_elemental;
-    profiler_t t_matvec;
 
     struct ReportSizes
     {
@@ -61,13 +56,9 @@ namespace bench
         t_adaptive_tconstr.clear();
         t_adaptive_tbal.clear();
         t_adaptive_oda.clear();
+        t_adaptive_oda_phases.clear();
 
-        t_ghostexchange.clear();
-        t_topdown.clear();
-        t_bottomup.clear();
-        t_treeinterior.clear();
-        t_elemental.clear();
-        t_matvec.clear();
+        prof::reset();
         
     }
 
@@ -129,8 +120,9 @@ namespace bench
 
             // Generate DA from balanced tree.
             t_adaptive_oda.start();
-            ot::DA<dim> oda(&(*tree.cbegin()), (unsigned) tree.size(), comm, eleOrder, numPts, loadFlexibility);
+            ot::DA<dim> oda(&(*tree.cbegin()), (unsigned) tree.size(), comm, eleOrder, 0, loadFlexibility);
             t_adaptive_oda.stop();
+            t_adaptive_oda_phases = oda.getConstructTimers();
             gDistRptSz.b1_globNodeSz = oda.getGlobalNodeSz();
         }
 
@@ -147,7 +139,7 @@ namespace bench
             gRptSz.b2_treeMatvecSz = tree.size();
 
             // DA based on adaptive grid.
-            ot::DA<dim> *octDA = new ot::DA<dim>(&(*tree.cbegin()), tree.size(), comm, eleOrder, numPts, loadFlexibility);
+            ot::DA<dim> *octDA = new ot::DA<dim>(&(*tree.cbegin()), tree.size(), comm, eleOrder, 0, loadFlexibility);
             gDistRptSz.b2_globNodeSz = octDA->getGlobalNodeSz();
 
             const unsigned int DOF = 1;   // matvec only supports dof==1 right now.
@@ -203,11 +195,7 @@ namespace bench
             }
 
             // Clear the side effect of warmup.
-            t_ghostexchange.clear();
-            t_topdown.clear();
-            t_bottomup.clear();
-            t_treeinterior.clear();
-            t_elemental.clear();
+            prof::reset();
 
             // Benchmark the matvec.
             for (int ii = 0; ii < numRuns; ii++)
@@ -361,12 +349,18 @@ int main(int argc, char** argv)
         "constr", 
         "bal", 
         "adaptive_oda", 
+        "oda_activeComm",
+        "oda_extNodes",
+        "oda_countCG",
+        "oda_intNodes",
+        "oda_scattermap",
+        "oda_gathermap",
+        "oda_ghostCoords",
 
         "matvec",
         "ghostexchange", 
         "topdown", 
         "bottomup", 
-        "treeinterior", 
         "elemental", 
     };
 
@@ -375,16 +369,22 @@ int main(int argc, char** argv)
         bench::t_adaptive_tconstr, 
         bench::t_adaptive_tbal, 
         bench::t_adaptive_oda, 
-
-        bench::t_matvec,
-        bench::t_ghostexchange, 
-        bench::t_topdown, 
-        bench::t_bottomup, 
-        bench::t_treeinterior, 
-        bench::t_elemental, 
+        bench::t_adaptive_oda_phases.t_activeComm,
+        bench::t_adaptive_oda_phases.t_extNodes,
+        bench::t_adaptive_oda_phases.t_countCGNodes,
+        bench::t_adaptive_oda_phases.t_intNodes,
+        bench::t_adaptive_oda_phases.t_scattermap,
+        bench::t_adaptive_oda_phases.t_gathermap,
+        bench::t_adaptive_oda_phases.t_ghostCoords,
+
+        bench::regionTimer("feMatrix::matVec/matvec"),
+        bench::regionTimer("feMatrix::matVec/ghostExchange"),
+        bench::regionTimer("feMatrix::matVec/matvec/top_down"),
+        bench::regionTimer("feMatrix::matVec/matvec/bottom_up"),
+        bench::regionTimer("feMatrix::matVec/matvec/elemental"),
     };
 
-    bench::dump_profile_info(std::cout, msgPrefix, params,param_names,2, counters,counter_names,10, comm);
+    bench::dump_profile_info(std::cout, msgPrefix, params,param_names,2, counters,counter_names,16, comm);
 
     _DestroyHcurve();
     MPI_Finalize();
@@ -0,0 +1,274 @@
+/**
+ * @brief: Benchmark program to compare local node orderings of the DA on an adaptive 4D grid:
+ * - construction order: exterior nodes as left by dist_countCGNodes(), interior nodes appended.
+ * - first-touch order: after DA::renumberNodesFirstTouch().
+ * For each ordering the matvec time and the hardware cache misses (Linux perf events) are reported.
+ * Cache misses read -1 where perf events are unavailable.
+ *
+ * @note: Based on bench/src/matvec_bench_adaptive.cpp
+*/
+
+#include "treeNode.h"
+#include "tsort.h"
+#include "nsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+#include "profiler.h"
+
+#include "oda.h"
+#include "feMatrix.h"
+
+#include "heatMat.h"
+
+#include <cstring>
+#include <cmath>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace bench
+{
+    /**@brief: counts hardware cache misses of the calling process between start() and stop(). */
+    class CacheMissCounter
+    {
+      public:
+        CacheMissCounter() : m_fd(-1), m_count(0)
+        {
+#ifdef __linux__
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+
+        ~CacheMissCounter()
+        {
+#ifdef __linux__
+            if (m_fd >= 0)
+                close(m_fd);
+#endif
+        }
+
+        bool isAvailable() const { return m_fd >= 0; }
+
+        void start()
+        {
+#ifdef __linux__
+            if (m_fd >= 0)
+            {
+                ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        void stop()
+        {
+#ifdef __linux__
+            if (m_fd >= 0)
+            {
+                ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+                long long c = 0;
+                if (read(m_fd, &c, sizeof(c)) == sizeof(c))
+                    m_count += c;
+            }
+#endif
+        }
+
+        void clear() { m_count = 0; }
+
+        long long count() const { return (m_fd >= 0 ? m_count : -1); }
+
+      private:
+        int m_fd;
+        long long m_count;
+    };
+
+
+    struct OrderingResult
+    {
+      profiler_t t_matvec;
+      long long cacheMisses;
+    };
+
+
+    template <unsigned int dim>
+    OrderingResult time_matvec(ot::DA<dim> *octDA, const double *in, double *out, unsigned int numWarmup, unsigned int numRuns, CacheMissCounter &counter)
+    {
+        const unsigned int DOF = 1;   // matvec only supports dof==1 right now.
+
+        Point<dim> domain_min(-0.5,-0.5,-0.5);
+        Point<dim> domain_max(0.5,0.5,0.5);
+
+        HeatEq::HeatMat<dim> heatMat(octDA,DOF);
+        heatMat.setProblemDimensions(domain_min,domain_max);
+
+        for (int ii = 0; ii < numWarmup; ii++)
+            heatMat.matVec(in, out, 1.0);
+
+        OrderingResult result;
+        result.t_matvec.clear();
+        counter.clear();
+
+        for (int ii = 0; ii < numRuns; ii++)
+        {
+            MPI_Barrier(octDA->getCommActive());
+            counter.start();
+            result.t_matvec.start();
+            heatMat.matVec(in, out, 1.0);
+            result.t_matvec.stop();
+            counter.stop();
+        }
+
+        result.cacheMisses = counter.count();
+        return result;
+    }
+
+
+    template <unsigned int dim>
+    void bench_kernel(unsigned int numPts, unsigned int numWarmup, unsigned int numRuns, unsigned int eleOrder, const char *msgPrefix, MPI_Comm comm)
+    {
+        int rank, npes;
+        MPI_Comm_rank(comm,&rank);
+        MPI_Comm_size(comm,&npes);
+
+        using T = unsigned int;
+        using TreeNode = ot::TreeNode<T,dim>;
+
+        const unsigned int maxPtsPerRegion = 1;
+        const double loadFlexibility = 0.3;
+
+        // Construct an adaptive grid based on a Gaussian point cloud.
+        std::vector<TreeNode> tree;
+        std::vector<TreeNode> points = ot::getPts<T,dim>(numPts);
+        ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, maxPtsPerRegion, loadFlexibility, comm);
+        points.clear();
+
+        ot::DA<dim> *octDA = new ot::DA<dim>(&(*tree.cbegin()), tree.size(), comm, eleOrder, 0, loadFlexibility);
+
+        CacheMissCounter counter;
+        OrderingResult results[2];
+        double maxDiff = 0.0;
+
+        if (octDA->isActive())
+        {
+            std::function<void(const double *, double*)> f_init =[](const double * xyz,double *var){
+                var[0] = std::sin(xyz[0]) + std::cos(xyz[1]);
+            };
+
+            std::vector<double> in, outConstr, outFirstTouch, outPermuted;
+            octDA->createVector(in,false,false,1);
+            octDA->createVector(outConstr,false,false,1);
+            octDA->createVector(outFirstTouch,false,false,1);
+            octDA->createVector(outPermuted,false,false,1);
+
+            // 1. Construction order.
+            octDA->setVectorByFunction(in.data(),f_init,false,false,1);
+            results[0] = time_matvec<dim>(octDA, in.data(), outConstr.data(), numWarmup, numRuns, counter);
+
+            // 2. First-touch order.
+            octDA->renumberNodesFirstTouch();
+            octDA->setVectorByFunction(in.data(),f_init,false,false,1);
+            results[1] = time_matvec<dim>(octDA, in.data(), outFirstTouch.data(), numWarmup, numRuns, counter);
+
+            // Both orderings must give the same result, up to the permutation.
+            octDA->nodalVecToConstructionOrder(outFirstTouch.data(), outPermuted.data(), 1);
+            for (unsigned int ii = 0; ii < outConstr.size(); ii++)
+                maxDiff = std::max(maxDiff, std::fabs(outConstr[ii] - outPermuted[ii]));
+        }
+        else
+        {
+            results[0].cacheMisses = results[1].cacheMisses = 0;
+        }
+
+        const char * orderNames[] = {"construction", "firstTouch"};
+
+        double glbMaxDiff = 0.0;
+        par::Mpi_Reduce(&maxDiff, &glbMaxDiff, 1, MPI_MAX, 0, comm);
+
+        if (!rank)
+            std::cout << "msgPrefix\tnpes\tpts_per_core\teleOrder\tnumNodes\tordering\t"
+                      << "matvec(min)\tmatvec(mean)\tmatvec(max)\tcacheMisses(sum)\tmaxDiff" << std::endl;
+
+        for (int o = 0; o < 2; o++)
+        {
+            double stat = results[o].t_matvec.seconds, stat_g[3];
+            par::Mpi_Reduce(&stat, stat_g + 0, 1, MPI_MIN, 0, comm);
+            par::Mpi_Reduce(&stat, stat_g + 1, 1, MPI_SUM, 0, comm);
+            par::Mpi_Reduce(&stat, stat_g + 2, 1, MPI_MAX, 0, comm);
+            stat_g[1] /= (double) npes;
+
+            // Report -1 if any proc could not count.
+            long long misses = results[o].cacheMisses, misses_g = 0, missesMin = 0;
+            par::Mpi_Reduce(&misses, &misses_g, 1, MPI_SUM, 0, comm);
+            par::Mpi_Reduce(&misses, &missesMin, 1, MPI_MIN, 0, comm);
+            if (missesMin < 0)
+                misses_g = -1;
+
+            if (!rank)
+                std::cout << msgPrefix << "\t" << npes << "\t" << numPts << "\t" << eleOrder << "\t"
+                          << octDA->getGlobalNodeSz() << "\t" << orderNames[o] << "\t"
+                          << stat_g[0] << "\t" << stat_g[1] << "\t" << stat_g[2] << "\t"
+                          << misses_g << "\t" << glbMaxDiff << std::endl;
+        }
+
+        delete octDA;
+    }
+
+}// end of namespace of bench
+
+
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc,&argv);
+
+    int rank,npes;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MPI_Comm_rank(comm,&rank);
+    MPI_Comm_size(comm,&npes);
+
+    const unsigned int msgPrefixLimit = 64;
+
+    if(argc<=3)
+    {
+        if(!rank)
+            std::cout<<"usage :  "<<argv[0]<<" pts_per_core(weak scaling) maxdepth elementalOrder numRuns(default 10) msgPrefix(<" << msgPrefixLimit << ")"<<std::endl;
+
+        MPI_Abort(comm,0);
+    }
+
+    constexpr unsigned int dim = 4;
+    const unsigned int pts_per_core = atoi(argv[1]);
+    m_uiMaxDepth = atoi(argv[2]);
+    const unsigned int eleOrder = atoi(argv[3]);
+    const unsigned int numRuns = (argc > 4 ? atoi(argv[4]) : 10);
+
+    char msgPrefix[2*msgPrefixLimit + 1];
+    msgPrefix[0] = '\0';
+    msgPrefix[msgPrefixLimit] = '\0';
+    if (argc > 5)
+      std::strncpy(msgPrefix, argv[5], msgPrefixLimit);
+
+    _InitializeHcurve(dim);
+
+    const unsigned int numWarmup = 2;
+    bench::bench_kernel<dim>(pts_per_core, numWarmup, numRuns, eleOrder, msgPrefix, comm);
+
+    _DestroyHcurve();
+    MPI_Finalize();
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+/**
+ * @brief: Merges the per-proc trace files <prefix>.<rank>.trace, written by prof::traceEnd(),
+ * into one Chrome trace (JSON) to open in chrome://tracing or Perfetto.
+ *
+ * @note: Run serially, e.g. after DENDRO_KT_TRACE=mv mpirun -np 4 ./matvecBench 1000 8 1
+*/
+
+#include "profRegistry.h"
+
+#include <iostream>
+#include <mpi.h>
+
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc,&argv);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD,&rank);
+
+    if(argc<=2)
+    {
+        if(!rank)
+            std::cout<<"usage :  "<<argv[0]<<" tracePrefix out.json"<<std::endl;
+        MPI_Abort(MPI_COMM_WORLD,0);
+    }
+
+    int numFailed = 0;
+    if(!rank)
+        numFailed = prof::writeChromeTrace(argv[1], argv[2]);
+
+    MPI_Finalize();
+    return (numFailed != 0);
+}
@@ -39,6 +39,7 @@
 
 
 #include <array>
+#include <vector>
 #include <set>
 #include <unordered_map>
 #include <stack>
@@ -610,69 +611,111 @@ void hexadecimal_string(std::array<int, K> h, char *c)
 //
 // THE CODE THAT WRITES THE TABLES TO SOURCE FILES.
 //
+// The tables are written as constexpr static members of explicit
+// specializations in a header (include/KDhcurvedata_DATA.h), so that
+// lookups with constant indices fold at compile time. The single
+// out-of-class definitions go in src/KDhcurvedata_DATA.cpp.
+//
 // ================================================================
-void output_preamble(std::ofstream &outfile)
+void output_preamble(std::ofstream &header, std::ofstream &source)
 {
-  outfile << "/**\n"
-             " * @author Masado Ishii\n"
-             " * @brief The actual table data generated by another script.\n"
-             " */\n";
-  outfile << "#include \"../include/KDhcurvedata_decl.h\"" << "\n\n";
+  header << "/**\n"
+            " * @author Masado Ishii\n"
+            " * @brief The actual table data generated by another script (gen/RotationTableHilbert.cpp).\n"
+            " * @note Included by KDhcurvedata_decl.h. Do not edit by hand.\n"
+            " */\n\n";
+  header << "#ifndef DENDRO_KT_HCURVEDATA_DATA_H\n"
+            "#define DENDRO_KT_HCURVEDATA_DATA_H\n\n";
+
+  source << "/**\n"
+            " * @author Masado Ishii\n"
+            " * @brief Definitions of the table data in KDhcurvedata_DATA.h, generated by another script.\n"
+            " */\n";
+  source << "#include \"../include/KDhcurvedata_decl.h\"" << "\n\n";
 }
 
-template <int K>
-void  output_tables(std::ofstream &outfile)
+void output_postamble(std::ofstream &header, std::ofstream &source)
 {
-  const int numChildren = 1 << K;
-  const int numOrientations = intFactorial<int>(K) * intPow<int>(2, K-1);
+  header << "#endif // DENDRO_KT_HCURVEDATA_DATA_H\n";
+}
 
-  char rotations[2*numChildren*numOrientations];
-  unsigned int htable[numChildren*numOrientations];
+void output_struct(std::ofstream &header, std::ofstream &source,
+                   const char *structName, int K, int numOrientations,
+                   const std::vector<char> &rotations, const std::vector<unsigned int> &htable)
+{
+  const int numChildren = 1 << K;
 
-  // Generate table data.
-  hilbert::generate_rotation_table<K>(rotations, htable);
+  header << "template <>\n"
+         << "struct " << structName << "<" << K << ">\n"
+         << "{\n"
+         << "  static constexpr int numRotations = " << numOrientations << ";\n"
+         << "\n";
 
   //
   // Write table data: m_rotations[].
   //
-  outfile << "template <>\n"
-          << "const char HilbertData<" << K << ">::m_rotations[] = {\n";
-
+  header << "  static constexpr char m_rotations[" << 2*numChildren*numOrientations << "] = {\n";
   for (int r = 0; r < numOrientations; r++)
   {
-    outfile << "    ";
+    header << "    ";
 
     #pragma unroll(numChildren)
     for (int ch = 0; ch < numChildren; ch++)
-      outfile << (int) rotations[r*2*numChildren + ch] << ",";
-    outfile << " ";
+      header << (int) rotations[r*2*numChildren + ch] << ",";
+    header << " ";
 
     #pragma unroll(numChildren)
     for (int ch = 0; ch < numChildren; ch++)
-      outfile << (int) rotations[r*2*numChildren + numChildren + ch] << ",";
-    outfile << "\n";
+      header << (int) rotations[r*2*numChildren + numChildren + ch] << ",";
+    header << "\n";
   }
-
-  outfile << "};\n"
-          << "\n";
+  header << "  };\n"
+         << "\n";
 
   //
   // Write table data: m_HILBERT_TABLE[].
   //
-  outfile << "template <>\n"
-          << "const int HilbertData<" << K << ">::m_HILBERT_TABLE[] = {\n";
-
+  header << "  static constexpr int m_HILBERT_TABLE[" << numChildren*numOrientations << "] = {\n";
   for (int r = 0; r < numOrientations; r++)
   {
-    outfile << "    ";
+    header << "    ";
     #pragma unroll(numChildren)
     for (int ch = 0; ch < numChildren; ch++)
-      outfile << (int) htable[r*numChildren + ch] << ",";
-    outfile << "\n";
+      header << (int) htable[r*numChildren + ch] << ",";
+    header << "\n";
   }
+  header << "  };\n"
+         << "};\n"
+         << "\n";
+
+  source << "constexpr int " << structName << "<" << K << ">::numRotations;\n"
+         << "constexpr char " << structName << "<" << K << ">::m_rotations[];\n"
+         << "constexpr int " << structName << "<" << K << ">::m_HILBERT_TABLE[];\n"
+         << "\n";
+}
+
+template <int K>
+void  output_tables(std::ofstream &header, std::ofstream &source)
+{
+  const int numChildren = 1 << K;
+  const int numOrientations = intFactorial<int>(K) * intPow<int>(2, K-1);
+
+  // On the heap: for K>=6 the tables no longer fit on the stack.
+  std::vector<char> rotations(2*numChildren*numOrientations);
+  std::vector<unsigned int> htable(numChildren*numOrientations);
+
+  // Generate table data.
+  hilbert::generate_rotation_table<K>(rotations.data(), htable.data());
+
+  output_struct(header, source, "HilbertData", K, numOrientations, rotations, htable);
+
+  // Morton ordering is the trivial curve with a single orientation.
+  std::vector<char> mortonRotations(2*numChildren);
+  std::vector<unsigned int> mortonHtable(numChildren, 0);
+  for (int ch = 0; ch < numChildren; ch++)
+    mortonRotations[ch] = mortonRotations[numChildren + ch] = ch;
 
-  outfile << "};\n"
-          << "\n";
+  output_struct(header, source, "MortonData", K, 1, mortonRotations, mortonHtable);
 }
 
 // ================================================================
@@ -724,13 +767,19 @@ int main(int arc, char* argv[])
   /// test_fill_tables<4>();
   /// test_fill_tables<5>();
 
-  std::ofstream outfile;
-  outfile.open("KDhcurvedata_DATA.cpp");
-  output_preamble(outfile);
-  output_tables<2>(outfile);
-  output_tables<3>(outfile);
-  output_tables<4>(outfile);
-  outfile.close();
+  // Dimensions 5 and up are supported by the generator, but their tables
+  // grow as pow(2,K-1)*factorial(K) rows (1920 rows for K==5, 23040 for K==6);
+  // add them here if needed.
+  std::ofstream header, source;
+  header.open("KDhcurvedata_DATA.h");
+  source.open("KDhcurvedata_DATA.cpp");
+  output_preamble(header, source);
+  output_tables<2>(header, source);
+  output_tables<3>(header, source);
+  output_tables<4>(header, source);
+  output_postamble(header, source);
+  header.close();
+  source.close();
 
   return 0;
 }
@@ -8,24 +8,50 @@
 
 #include "hcurvedata.h"
 
-#include <cstring>
-
 template <int pDim>
-struct HilbertData
-{
-  static void copyData(char * &rotations, int * &HILBERT_TABLE);
-  static const char m_rotations[_KD_ROTATIONS_SIZE(pDim)];
-  static const int m_HILBERT_TABLE[_KD_HILBERT_TABLE_SIZE(pDim)];
-};
+struct HilbertData;
 
 template <int pDim>
-void HilbertData<pDim>::copyData(char * &rotations, int * &HILBERT_TABLE)
+struct MortonData;
+
+#include "KDhcurvedata_DATA.h"
+
+/**
+ * @brief Compile-time access to the SFC tables of a given dimension.
+ * @details Equivalent to indexing the globals rotations[] and HILBERT_TABLE[]
+ *          set up by _InitializeHcurve(dim), but the table is chosen by the
+ *          template argument, so there is no indirection through a global
+ *          pointer and lookups with constant indices fold at compile time.
+ *          - rotPerm(pRot)[child_sfc] == child_m
+ *          - rotInv(pRot)[child_m] == child_sfc
+ *          - orientLookup(pRot)[child_m] == child rotation.
+ */
+template <unsigned int dim>
+struct SFC_Tables
 {
-  rotations = new char[sizeof(m_rotations)];
-  memcpy(rotations, m_rotations, sizeof(m_rotations));
+#ifdef HILBERT_ORDERING
+  using Data = HilbertData<dim>;
+#else
+  using Data = MortonData<dim>;
+#endif
+
+  static constexpr int numChildren = 1 << dim;
+  static constexpr int numRotations = Data::numRotations;
+
+  static constexpr const char * rotPerm(int pRot)
+  {
+    return Data::m_rotations + pRot*2*numChildren;
+  }
 
-  HILBERT_TABLE = new int[sizeof(m_HILBERT_TABLE) / sizeof(int)];
-  memcpy(HILBERT_TABLE, m_HILBERT_TABLE, sizeof(m_HILBERT_TABLE));
-}
+  static constexpr const char * rotInv(int pRot)
+  {
+    return Data::m_rotations + pRot*2*numChildren + numChildren;
+  }
+
+  static constexpr const int * orientLookup(int pRot)
+  {
+    return Data::m_HILBERT_TABLE + pRot*numChildren;
+  }
+};
 
 #endif // DENDRO_KT_HCURVEDATA_DECL_H
@@ -63,6 +63,20 @@ namespace binOp{
     */
   unsigned int lowestOnePos(unsigned int num);
 
+  /**
+    @brief Finds the 0-based index of the most-significant 1 of a nonzero num, in constant time.
+    @note For any unsigned integer type up to 64 bits.
+    */
+  template <typename T>
+  inline unsigned int highestOnePos(T num)
+  {
+    static_assert(sizeof(T) <= sizeof(unsigned long long), "highestOnePos() supports up to 64 bits.");
+    if (sizeof(T) <= sizeof(unsigned int))
+      return 8*sizeof(unsigned int) - 1 - __builtin_clz((unsigned int) num);
+    else
+      return 8*sizeof(unsigned long long) - 1 - __builtin_clzll((unsigned long long) num);
+  }
+
   /**@brief sets the i^th bit on the value val*/
   template <typename T>
   inline void setBit(T& val, unsigned int i)
@@ -46,8 +46,10 @@ constexpr int _KD_HILBERT_TABLE_SIZE(int pDim)
 }
 
 
-extern int* HILBERT_TABLE;
-extern char* rotations;
+// Point into the constexpr tables of KDhcurvedata_DATA.h after _InitializeHcurve().
+// Templated code should prefer SFC_Tables<dim> (KDhcurvedata_decl.h).
+extern const int* HILBERT_TABLE;
+extern const char* rotations;
 
 //#define DENDRO_DIM2
 
@@ -62,4 +64,6 @@ void _DestroyHcurve();
 
 
 
+#include "KDhcurvedata_decl.h"
+
 #endif //DENDRO_KT_HCURVEDATA_H
@@ -107,9 +107,8 @@ namespace fem {
           tempSplitters, unused_ancS, unused_ancE);
 
       // Shortcuts to lookup SFC rotations.
-      constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
-      const ot::ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-      const ot::RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+      const ot::ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+      const ot::RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
 
       // Recurse normally.
       for (ot::ChildI child_sfc = 0; child_sfc < numChildren; child_sfc++)
@@ -13,11 +13,13 @@
 #include "hcurvedata.h"
 #include "parUtils.h"
 #include "binUtils.h"
+#include "profRegistry.h"
 
 #include <iostream>
 #include <bitset>
 
 #include <mpi.h>
+#include <omp.h>
 #include <vector>
 #include <queue>
 #include <unordered_set>
@@ -333,6 +335,16 @@ namespace ot {
      */
     static RankI countCGNodes(TNPoint<T,dim> *start, TNPoint<T,dim> *end, unsigned int order, bool classify = true);
 
+    /**
+     * @brief Appends the element-exterior nodes of SFC-sorted elements, generating every
+     *        (location, level) only once per run of sibling elements: the first sibling that
+     *        touches a location emits it, and numInstances counts the siblings that share it.
+     * @note Siblings are adjacent in the SFC and have equal level, so this is decided locally.
+     *       The result is what Element::appendExteriorNodes() on every element followed by
+     *       countInstances() would give, so it can be passed to countCGNodes()/dist_countCGNodes() directly.
+     */
+    static void appendExteriorNodesCanonical(const TreeNode<T,dim> *elements, RankI numElements, unsigned int order, std::vector<TNPoint<T,dim>> &nodeList);
+
     /**
      * @brief Sorts points `as points', meaning by coordinate first. NOTE: Doesn't enforce any ordering among points with identical coordinates.
      */
@@ -361,6 +373,27 @@ namespace ot {
     template <typename da>
     static void ghostReverse(da *dataAndGhostBuffers, da *sendBufferSpace, const ScatterMap &sm, const GatherMap &gm, MPI_Comm comm);
 
+    /**
+     * @brief Find which processors upon which the node is incident.
+     * @description Generates keys from pt.getDFD() and then calls getContainingBlocks().
+     * @note Guaranteed to include all neighbours but may include non-neighbours too.
+     *       Specifically (assuming 2:1 balancing), includes all neighbours of the host k-face.
+     */
+    static int getProcNeighbours(TNPoint<T,dim> pt, const TreeNode<T,dim> *splitters, int numSplitters, std::vector<int> &procNbList, unsigned int order);
+
+    /**
+     * @brief Batched getProcNeighbours() over a whole list of nodes, which should be SFC-sorted.
+     * @description Keys of consecutive nodes are swept against the splitters together, in one
+     *              traversal per chunk of nodes, with scratch space reused between chunks.
+     *              Nodes whose host cell lies, away from its boundary, in a subtree that belongs
+     *              to block rProc skip key generation entirely: their list is just {rProc}.
+     * @param [out] procNbList Concatenation of the per-node lists, as getProcNeighbours() would produce them.
+     * @param [out] numProcNb Length of the list of each node.
+     */
+    static void getProcNeighboursBatch(const TNPoint<T,dim> *points, RankI numPoints,
+        const TreeNode<T,dim> *splitters, int numSplitters, int rProc,
+        std::vector<int> &procNbList, std::vector<int> &numProcNb, unsigned int order);
+
 
     private:
 
@@ -385,8 +418,23 @@ namespace ot {
       /** @brief Breaks up an interface into the component hyperplanes. */
       static void bucketByHyperplane(TNPoint<T,dim> *start, TNPoint<T,dim> *end, unsigned int hlev, std::array<RankI,dim+1> &hSplitters);
 
+      /** @brief Buckets with fewer points than this are not worth an OpenMP task in countCGNodes_impl(). */
+      static constexpr RankI countCGNodes_taskGrain = 4096;
+
+      /**
+       * @brief Calls fun() from one thread of a team, so that its OpenMP tasks run in parallel.
+       *        Inside an active parallel region, e.g. when countCGNodes() is called by one thread
+       *        while the others do other work, the tasks go to the enclosing team; otherwise a
+       *        team is started if numPoints is worth it.
+       */
+      template <typename FunT>
+      static void runWithTasks(FunT &fun, RankI numPoints);
+
       /**
        * @brief Depth-first traversal: pre-order bucketing, post-order calling resolveInterface (bottom up).
+       * @note Child buckets and hyperplanes are disjoint and are processed as OpenMP tasks when
+       *       called inside a parallel region. Counts are reduced in a fixed order, so the result
+       *       does not depend on the number of threads.
        * @param sLev The level to separate children into sibiling buckets.
        * @param pRot The SFC orientation of the parent (containing) region.
        */
@@ -423,12 +471,24 @@ namespace ot {
       static std::vector<TreeNode<T,dim>> dist_bcastSplitters(const TreeNode<T,dim> *start, MPI_Comm comm);
 
       /**
-       * @brief Find which processors upon which the node is incident.
-       * @description Generates keys from pt.getDFD() and then calls getContainingBlocks().
-       * @note Guaranteed to include all neighbours but may include non-neighbours too.
-       *       Specifically (assuming 2:1 balancing), includes all neighbours of the host k-face.
+       * @brief Generates the keys used by getProcNeighbours(), appending them to keyList.
+       */
+      static void appendProcNeighbourKeys(const TNPoint<T,dim> &pt, std::vector<TreeNode<T,dim>> &keyList, unsigned int order);
+
+      /**
+       * @brief Recursive part of getProcNeighboursBatch(): flags the cells that lie, away from the
+       *        subtree boundary (except at the lower domain boundary), in a subtree wholly inside block rProc.
+       */
+      static void markInteriorHosts(TreeNode<T,dim> *cells, RankI *ids, RankI begin, RankI end,
+          const TreeNode<T,dim> *splitters, int sBegin, int sEnd, LevI lev, RotI pRot,
+          int &numPrevBlocks, int rProc, std::vector<char> &isInterior);
+
+      /**
+       * @brief Recursive part of getProcNeighboursBatch(): same traversal as SFC_Tree::getContainingBlocks(),
+       *        but records the block of every key (-1 if before the first splitter), moving owners along with the keys.
        */
-      static int getProcNeighbours(TNPoint<T,dim> pt, const TreeNode<T,dim> *splitters, int numSplitters, std::vector<int> &procNbList, unsigned int order);
+      static void tagContainingBlocks(TreeNode<T,dim> *keys, RankI *owners, int *blocks, RankI begin, RankI end,
+          const TreeNode<T,dim> *splitters, int sBegin, int sEnd, LevI lev, RotI pRot, int &numPrevBlocks);
 
       /**
        * @brief Find which processors upon which the node is incident.
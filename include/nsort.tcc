@@ -117,6 +117,7 @@ namespace ot {
     m_isSelected = other.m_isSelected;
     m_numInstances = other.m_numInstances;
     m_owner = other.m_owner;
+    return *this;
   }
 
 
@@ -495,6 +496,7 @@ namespace ot {
       const TreeNode<T,dim> *treePartFront, const TreeNode<T,dim> *treePartBack,
       MPI_Comm comm)
   {
+    DENDRO_PROF_SCOPE("dist_countCGNodes");
     using TNP = TNPoint<T,dim>;
 
     // Counting:
@@ -556,8 +558,8 @@ namespace ot {
     std::vector<BdryNodeInfo> bdryNodeInfo;
     std::vector<int> shareLists;
 
-    std::vector<RankI> sendCounts(nProc, 0);
-    std::vector<RankI> recvCounts(nProc, 0);
+    std::vector<RankI> sendCounts;
+    std::vector<RankI> recvCounts;
 
     std::vector<RankI> sendOffsets;
     std::vector<RankI> recvOffsets;
@@ -568,47 +570,52 @@ namespace ot {
     // Get neighbour information.
     std::vector<TreeNode<T,dim>> splitters = dist_bcastSplitters(treePartFront, comm);
     assert((splitters.size() == nProc));
+    std::vector<int> procNbLists, numProcNbs;
+    getProcNeighboursBatch(points.data(), numUniquePoints, splitters.data(), nProc, rProc, procNbLists, numProcNbs, 1);
+    const int *procNbPtr = procNbLists.data();
     for (RankI ptIdx = 0; ptIdx < numUniquePoints; ptIdx++)
     {
-      // Concatenates list of (unique) proc neighbours to shareLists.
-      int numProcNb = getProcNeighbours(points[ptIdx], splitters.data(), nProc, shareLists, 1);
-      //TODO test the assertion that all listed proc-neighbours in a sublist are unique.
-
-      // Remove ourselves from neighbour list.
-      if (std::remove(shareLists.end() - numProcNb, shareLists.end(), rProc) < shareLists.end())
-      {
-        shareLists.erase(shareLists.end() - 1);
-        numProcNb--;
-      }
+      // Concatenates list of (unique) proc neighbours to shareLists, removing ourselves.
+      int numProcNb = 0;
+      for (int nb = 0; nb < numProcNbs[ptIdx]; nb++, procNbPtr++)
+        if (*procNbPtr != rProc)
+        {
+          shareLists.push_back(*procNbPtr);
+          numProcNb++;
+        }
 
       if (numProcNb > 0)  // Shared, i.e. is a proc-boundary node.
-      {
         bdryNodeInfo.push_back({ptIdx, numProcNb});    // Record which point and how many proc-neighbours.
-        for (int nb = numProcNb; nb >= 1; nb--)
-        {
-          sendCounts[*(shareLists.end() - nb)]++;
-        }
-      }
     }
 
+    // Sparse (rank, count) lists of the neighbouring processors, in rank order.
+    // Only neighbours are listed, so nothing here is O(nProc).
+    sendProc = shareLists;
+    std::sort(sendProc.begin(), sendProc.end());
+    sendProc.erase(std::unique(sendProc.begin(), sendProc.end()), sendProc.end());
+    const int numSendProc = (int) sendProc.size();
+    auto sendIdx = [&sendProc](int proc)
+        { return std::lower_bound(sendProc.begin(), sendProc.end(), proc) - sendProc.begin(); };
+
+    sendCounts.resize(numSendProc, 0);
+    for (int proc : shareLists)
+      sendCounts[sendIdx(proc)]++;
+
 
     // Create the preliminary send buffer, ``share buffer.''
     // We compute the preliminary send buffer only once, so don't make a separate scatter map for it.
     std::vector<TNP> shareBuffer;
     int sendTotal = 0;
-    sendOffsets.resize(nProc);
-    for (int proc = 0; proc < nProc; proc++)
+    sendOffsets.resize(numSendProc);
+    for (int sIdx = 0; sIdx < numSendProc; sIdx++)
     {
-      sendOffsets[proc] = sendTotal;
-      sendTotal += sendCounts[proc];
+      sendOffsets[sIdx] = sendTotal;
+      sendTotal += sendCounts[sIdx];
     }
     shareBuffer.resize(sendTotal);
 
-    // Determine the receive counts, via Alltoall of send counts.
-    par::Mpi_Alltoall(sendCounts.data(), recvCounts.data(), 1, comm); 
-
     // Copy outbound data into the share buffer.
-    // Note: Advances sendOffsets, so will need to recompute sendOffsets later.
+    std::vector<RankI> shareCursor = sendOffsets;
     const int *shareListPtr = &(*shareLists.begin());
     for (const BdryNodeInfo &nodeInfo : bdryNodeInfo)
     {
@@ -616,37 +623,21 @@ namespace ot {
       {
         int proc = *(shareListPtr++);
         points[nodeInfo.ptIdx].set_owner(rProc);   // Reflected in both copies, else default -1.
-        shareBuffer[sendOffsets[proc]++] = points[nodeInfo.ptIdx];
+        shareBuffer[shareCursor[sendIdx(proc)]++] = points[nodeInfo.ptIdx];
       }
     }
 
-    // Compact lists of neighbouring processors and (re)compute share offsets.
-    // Note: This should only be done after we are finished with shareLists.
-    int numSendProc = 0;
-    int numRecvProc = 0;
-    sendTotal = 0;
+    // Determine who sends to us and how much, via sparse exchange of send counts.
+    // Tag 1 keeps the counts apart from the node data (tag 0) that follows.
+    par::Mpi_Alltoall_NBX<RankI>(sendProc.data(), sendCounts.data(), numSendProc,
+                                 recvProc, recvCounts, 1, comm);
+    const int numRecvProc = (int) recvProc.size();
     int recvTotal = 0;
-    sendOffsets.clear();
-    for (int proc = 0; proc < nProc; proc++)
+    for (int rIdx = 0; rIdx < numRecvProc; rIdx++)
     {
-      if (sendCounts[proc] > 0)   // Discard empty counts, which includes ourselves.
-      {
-        sendCounts[numSendProc++] = sendCounts[proc];  // Compacting.
-        sendOffsets.push_back(sendTotal);
-        sendProc.push_back(proc);
-        sendTotal += sendCounts[proc];
-      }
-      if (recvCounts[proc] > 0)   // Discard empty counts, which includes ourselves.
-      {
-        recvCounts[numRecvProc++] = recvCounts[proc];  // Compacting.
-        recvOffsets.push_back(recvTotal);
-        recvProc.push_back(proc);
-        recvTotal += recvCounts[proc];
-      }
-
+      recvOffsets.push_back(recvTotal);
+      recvTotal += recvCounts[rIdx];
     }
-    sendCounts.resize(numSendProc);
-    recvCounts.resize(numRecvProc);
 
     // Preliminary receive will be into end of existing node list.
     points.resize(numUniquePoints + recvTotal);
@@ -729,14 +720,13 @@ namespace ot {
       const unsigned int backLev = treePartBack->getLevel();
 
       constexpr char numChildren = TreeNode<T,dim>::numChildren;
-      constexpr char rotOffset = 2*numChildren;                             // num columns in rotations[].
       unsigned int pRot = 0;
 
       // Find first contained node.
       segBegin = points.begin();
       for (unsigned int testLev = 1; testLev <= frontLev; testLev++)
       {
-        const ChildI *rot_inv = &rotations[pRot*rotOffset + 1*numChildren];   // child_sfc == rot_inv[child_morton];
+        const ChildI *rot_inv = SFC_Tables<dim>::rotInv(pRot);   // child_sfc == rot_inv[child_morton];
         const ChildI spChild_m = treePartFront->getMortonIndex(testLev);
         const ChildI spChild_sfc = rot_inv[spChild_m];
 
@@ -748,7 +738,7 @@ namespace ot {
           break;
         // Else, child_sfc == spChild_sfc, so we need to keep descending.
 
-        const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+        const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
         pRot = orientLookup[spChild_m];
       }
 
@@ -759,7 +749,7 @@ namespace ot {
         segEnd = points.end() - 1;
         for (unsigned int testLev = 1; testLev <= backLev; testLev++)
         {
-          const ChildI *rot_inv = &rotations[pRot*rotOffset + 1*numChildren];   // child_sfc == rot_inv[child_morton];
+          const ChildI *rot_inv = SFC_Tables<dim>::rotInv(pRot);   // child_sfc == rot_inv[child_morton];
           const ChildI spChild_m = treePartBack->getMortonIndex(testLev);
           const ChildI spChild_sfc = rot_inv[spChild_m];
 
@@ -771,7 +761,7 @@ namespace ot {
           // because that would imply segEnd < segBegin.
           // Therefore we know child_sfc == spChild_sfc, and we need to keep descending.
 
-          const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+          const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
           pRot = orientLookup[spChild_m];
         }
         segEnd++;
@@ -809,6 +799,7 @@ namespace ot {
   template <typename T, unsigned int dim>
   ScatterMap SFC_NodeSort<T,dim>::computeScattermap(const std::vector<TNPoint<T,dim>> &ownedNodes, const TreeNode<T,dim> *treePartStart, MPI_Comm comm)
   {
+    DENDRO_PROF_SCOPE("computeScattermap");
     using TNP = TNPoint<T,dim>;
 
     int rProc, nProc;
@@ -872,6 +863,25 @@ namespace ot {
   }
 
 
+  //
+  // SFC_NodeSort::runWithTasks()
+  //
+  template <typename T, unsigned int dim>
+  template <typename FunT>
+  void SFC_NodeSort<T,dim>::runWithTasks(FunT &fun, RankI numPoints)
+  {
+    // A nested region, even an inactive one, would bind the tasks to a team of one thread.
+    if (omp_in_parallel())
+      fun();
+    else
+    {
+      #pragma omp parallel if (numPoints >= countCGNodes_taskGrain)
+      #pragma omp single
+      fun();
+    }
+  }
+
+
   //
   // SFC_NodeSort::countCGNodes()
   //
@@ -928,22 +938,114 @@ namespace ot {
 
       // Bottom-up counting interior points
       //
-      if (order <= 2)
-        totalUniquePoints += countCGNodes_impl(resolveInterface_lowOrder, start, end - numDomBdryPoints, 1, 0, order);
-      else
-        totalUniquePoints += countCGNodes_impl(resolveInterface_highOrder, start, end - numDomBdryPoints, 1, 0, order);
+      RankI numUniqIntPoints = 0;
+      auto countIntPoints = [&]() {
+        if (order <= 2)
+          numUniqIntPoints = countCGNodes_impl(resolveInterface_lowOrder, start, end - numDomBdryPoints, 1, 0, order);
+        else
+          numUniqIntPoints = countCGNodes_impl(resolveInterface_highOrder, start, end - numDomBdryPoints, 1, 0, order);
+      };
+      runWithTasks(countIntPoints, end - start);
+      totalUniquePoints += numUniqIntPoints;
     }
     // Sorting/instancing task.
     else
     {
       countInstances(end - numDomBdryPoints, end, order);
-      countCGNodes_impl(countInstances, start, end - numDomBdryPoints, 1, 0, order);
+      auto instanceIntPoints = [&]() {
+        countCGNodes_impl(countInstances, start, end - numDomBdryPoints, 1, 0, order);
+      };
+      runWithTasks(instanceIntPoints, end - start);
     }
 
     return totalUniquePoints;
   }
 
 
+  //
+  // SFC_NodeSort::appendExteriorNodesCanonical()
+  //
+  template <typename T, unsigned int dim>
+  void SFC_NodeSort<T,dim>::appendExteriorNodesCanonical(const TreeNode<T,dim> *elements, RankI numElements, unsigned int order, std::vector<TNPoint<T,dim>> &nodeList)
+  {
+    using TNP = TNPoint<T,dim>;
+
+    // Nodes of a sibling family lie on a grid of (2*order+1)^dim locations over the parent.
+    // For each grid location, the index in nodeList of the node emitted for it, or noSlot.
+    const RankI noSlot = static_cast<RankI>(-1);
+    const unsigned int gridWidth = 2*order + 1;
+    std::vector<RankI> gridSlot(intPow(gridWidth, dim), noSlot);
+    std::vector<unsigned int> touched;
+
+    const unsigned int numNodes = intPow(order+1, dim);
+
+    RankI runBegin = 0;
+    while (runBegin < numElements)
+    {
+      // Find the run of siblings starting at runBegin.
+      const TreeNode<T,dim> &first = elements[runBegin];
+      const TreeNode<T,dim> parent = (first.getLevel() > 0 ? first.getParent() : first);
+      RankI runEnd = runBegin + 1;
+      while (first.getLevel() > 0 && runEnd < numElements &&
+             elements[runEnd].getLevel() == first.getLevel() && elements[runEnd].getParent() == parent)
+        runEnd++;
+
+      if (runEnd - runBegin == 1)
+      {
+        Element<T,dim>(first).appendExteriorNodes(order, nodeList);
+        runBegin = runEnd;
+        continue;
+      }
+
+      const unsigned int len = 1u << (m_uiMaxDepth - first.getLevel());
+      for (RankI e = runBegin; e < runEnd; e++)
+      {
+        std::array<unsigned int, dim> childOffset;
+        for (int d = 0; d < dim; d++)
+          childOffset[d] = (elements[e].getX(d) != parent.getX(d) ? order : 0);
+
+        // Same traversal of exterior nodes as Element::appendExteriorNodes().
+        std::array<unsigned int, dim> nodeIndices;
+        nodeIndices.fill(0);
+        for (unsigned int node = 0; node < numNodes; node++)
+        {
+          if (std::count(nodeIndices.begin(), nodeIndices.end(), 0) == 0 &&
+              std::count(nodeIndices.begin(), nodeIndices.end(), order) == 0)
+          {
+            nodeIndices[0] = order;   // Skip ahead to the lexicographically next boundary node.
+            node += order - 1;
+          }
+
+          unsigned int gridIdx = 0;
+          for (int d = dim-1; d >= 0; d--)
+            gridIdx = gridIdx * gridWidth + childOffset[d] + nodeIndices[d];
+
+          if (gridSlot[gridIdx] == noSlot)
+          {
+            std::array<T,dim> nodeCoords;
+            #pragma unroll(dim)
+            for (int d = 0; d < dim; d++)
+              nodeCoords[d] = len * nodeIndices[d] / order  +  elements[e].getX(d);
+            gridSlot[gridIdx] = nodeList.size();
+            touched.push_back(gridIdx);
+            nodeList.push_back(TNP(nodeCoords, first.getLevel()));
+          }
+          else
+            nodeList[gridSlot[gridIdx]].incrementNumInstances();
+
+          incrementBaseB<unsigned int, dim>(nodeIndices, order+1);
+        }
+      }
+
+      for (unsigned int gridIdx : touched)
+        gridSlot[gridIdx] = noSlot;
+      touched.clear();
+
+      runBegin = runEnd;
+    }
+  }
+
+
   //
   // SFC_NodeSort::filterDomainBoundary()
   //
@@ -1002,11 +1104,10 @@ namespace ot {
   {
     using TNP = TNPoint<T,dim>;
     constexpr char numChildren = TreeNode<T,dim>::numChildren;
-    constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
 
     // Lookup tables to apply rotations.
-    const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-    const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+    const ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+    const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
 
     if (end <= begin) { return; }
 
@@ -1177,11 +1278,10 @@ namespace ot {
     using TNP = TNPoint<T,dim>;
     using TreeNode = TreeNode<T,dim>;
     constexpr char numChildren = TreeNode::numChildren;
-    constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
 
     // Lookup tables to apply rotations.
-    const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-    const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+    const ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+    const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
 
     if (!(start < end))
       return 0;
@@ -1197,17 +1297,22 @@ namespace ot {
         tempSplitters,
         ancStart, ancEnd);
 
-    // Recurse.
+    // Recurse. The child buckets are disjoint, so large ones become tasks.
+    // (Inside a parallel region; otherwise the tasks run immediately.)
+    std::array<RankI, numChildren> childCounts;
+    childCounts.fill(0);
     for (char child_sfc = 0; child_sfc < numChildren; child_sfc++)
     {
       // Check for empty bucket.
-      if (tempSplitters[child_sfc+1] - tempSplitters[child_sfc+0] == 0)
+      const RankI childSz = tempSplitters[child_sfc+1] - tempSplitters[child_sfc+0];
+      if (childSz == 0)
         continue;
 
       ChildI child = rot_perm[child_sfc];
       RotI cRot = orientLookup[child];
 
-      numUniqPoints += countCGNodes_impl<ResolverT>(
+      #pragma omp task default(shared) firstprivate(child_sfc, cRot) if (childSz >= countCGNodes_taskGrain)
+      childCounts[child_sfc] = countCGNodes_impl<ResolverT>(
           resolveInterface,
           start + tempSplitters[child_sfc+0], start + tempSplitters[child_sfc+1],
           sLev+1, cRot,
@@ -1215,18 +1320,31 @@ namespace ot {
     }
 
     // Process own interface. (In this case hlev == sLev).
+    // Disjoint from the children, so it overlaps with their tasks.
     std::array<RankI, dim+1> hSplitters;
     bucketByHyperplane(start + ancStart, start + ancEnd, sLev, hSplitters);
+    std::array<RankI, dim> hCounts;
     for (int d = 0; d < dim; d++)
     {
-      locTreeSortAsPoints(
-          start + ancStart, hSplitters[d], hSplitters[d+1],
-          sLev, m_uiMaxDepth, pRot);
+      #pragma omp task default(shared) firstprivate(d) if (hSplitters[d+1] - hSplitters[d] >= countCGNodes_taskGrain)
+      {
+        locTreeSortAsPoints(
+            start + ancStart, hSplitters[d], hSplitters[d+1],
+            sLev, m_uiMaxDepth, pRot);
 
-      // The actual counting happens here.
-      numUniqPoints += resolveInterface(start + ancStart + hSplitters[d], start + ancStart + hSplitters[d+1], order);
+        // The actual counting happens here.
+        hCounts[d] = resolveInterface(start + ancStart + hSplitters[d], start + ancStart + hSplitters[d+1], order);
+      }
     }
 
+    #pragma omp taskwait
+
+    // Reduce in a fixed order.
+    for (char child_sfc = 0; child_sfc < numChildren; child_sfc++)
+      numUniqPoints += childCounts[child_sfc];
+    for (int d = 0; d < dim; d++)
+      numUniqPoints += hCounts[d];
+
     return numUniqPoints;
   }
 
@@ -1596,10 +1714,10 @@ namespace ot {
 
     using TreeNode = TreeNode<T,dim>;
     std::vector<TreeNode> splitters(nProc);
-    splitters[rProc] = *start;
+    TreeNode mySplitter = *start;
 
-    for (int turn = 0; turn < nProc; turn++)
-      par::Mpi_Bcast<TreeNode>(&splitters[turn], 1, turn, comm);
+    // One collective instead of nProc consecutive broadcasts.
+    par::Mpi_Allgather<TreeNode>(&mySplitter, splitters.data(), 1, comm);
 
     return splitters;
   }
@@ -1622,9 +1740,26 @@ namespace ot {
       std::vector<int> &procNbList,
       unsigned int order)
   {
-    std::vector<TreeNode<T,dim>> keyList(2*intPow(3,dim));    // Allocate then shrink. TODO static allocation
+    std::vector<TreeNode<T,dim>> keyList(2*intPow(3,dim));    // Allocate then shrink.
     keyList.clear();
+    appendProcNeighbourKeys(pt, keyList, order);
+
+    int procNbListSizeOld = procNbList.size();
+    SFC_Tree<T,dim>::getContainingBlocks(keyList.data(), 0, (int) keyList.size(), splitters, numSplitters, procNbList);
+    int procNbListSize = procNbList.size();
+
+    return procNbListSize - procNbListSizeOld;
+  }
+
 
+  //
+  // SFC_NodeSort::appendProcNeighbourKeys()
+  //
+  template <typename T, unsigned int dim>
+  void SFC_NodeSort<T,dim>::appendProcNeighbourKeys(const TNPoint<T,dim> &pt,
+      std::vector<TreeNode<T,dim>> &keyList,
+      unsigned int order)
+  {
     pt.getDFD().appendAllNeighboursAsPoints(keyList);  // Includes domain boundary points.
 
     // Fix to make sure we get 1-finer-level neighbours of the host k-face.
@@ -1660,12 +1795,224 @@ namespace ot {
         centerPt.appendAllNeighboursAsPoints(keyList);
       }
     }
+  }
 
-    int procNbListSizeOld = procNbList.size();
-    SFC_Tree<T,dim>::getContainingBlocks(keyList.data(), 0, (int) keyList.size(), splitters, numSplitters, procNbList);
-    int procNbListSize = procNbList.size();
 
-    return procNbListSize - procNbListSizeOld;
+  //
+  // SFC_NodeSort::getProcNeighboursBatch()
+  //
+  template <typename T, unsigned int dim>
+  void SFC_NodeSort<T,dim>::getProcNeighboursBatch(const TNPoint<T,dim> *points, RankI numPoints,
+      const TreeNode<T,dim> *splitters, int numSplitters, int rProc,
+      std::vector<int> &procNbList, std::vector<int> &numProcNb,
+      unsigned int order)
+  {
+    numProcNb.clear();
+    numProcNb.reserve(numPoints);
+
+    // Early-out: host cells strictly inside a subtree of our own block.
+    std::vector<char> isInterior(numPoints, false);
+    {
+      std::vector<TreeNode<T,dim>> cells(numPoints);
+      std::vector<RankI> ids(numPoints);
+      for (RankI ii = 0; ii < numPoints; ii++)
+      {
+        cells[ii] = points[ii].getCell();
+        ids[ii] = ii;
+      }
+      int numPrevBlocks = 0;
+      markInteriorHosts(cells.data(), ids.data(), 0, numPoints, splitters, 0, numSplitters, 1, 0, numPrevBlocks, rProc, isInterior);
+    }
+
+    // Remaining nodes: generate keys for a chunk of nodes and sweep them all at once.
+    const RankI chunkKeys = 1u << 16;
+    std::vector<TreeNode<T,dim>> keys;
+    std::vector<RankI> owners;
+    std::vector<int> blocks;
+    std::vector<RankI> ownerOffsets;
+    std::vector<int> nodeBlocks;
+
+    RankI chunkBegin = 0;
+    while (chunkBegin < numPoints)
+    {
+      keys.clear();
+      owners.clear();
+      RankI chunkEnd = chunkBegin;
+      while (chunkEnd < numPoints && keys.size() < chunkKeys)
+      {
+        if (!isInterior[chunkEnd])
+        {
+          appendProcNeighbourKeys(points[chunkEnd], keys, order);
+          owners.resize(keys.size(), chunkEnd - chunkBegin);
+        }
+        chunkEnd++;
+      }
+
+      blocks.resize(keys.size());
+      int numPrevBlocks = 0;
+      if (keys.size() > 0)
+        tagContainingBlocks(keys.data(), owners.data(), blocks.data(), 0, keys.size(), splitters, 0, numSplitters, 1, 0, numPrevBlocks);
+
+      // Group the tagged blocks by owner (counting sort).
+      ownerOffsets.assign(chunkEnd - chunkBegin + 1, 0);
+      for (RankI k = 0; k < keys.size(); k++)
+        ownerOffsets[owners[k] + 1]++;
+      for (RankI ii = 0; ii < chunkEnd - chunkBegin; ii++)
+        ownerOffsets[ii + 1] += ownerOffsets[ii];
+      nodeBlocks.resize(keys.size());
+      for (RankI k = 0; k < keys.size(); k++)
+        nodeBlocks[ownerOffsets[owners[k]]++] = blocks[k];
+
+      // Blocks are numbered in SFC order, so a sorted unique list matches getContainingBlocks().
+      RankI segBegin = 0;
+      for (RankI ii = 0; ii < chunkEnd - chunkBegin; ii++)
+      {
+        const RankI segEnd = ownerOffsets[ii];
+        if (isInterior[chunkBegin + ii])
+        {
+          procNbList.push_back(rProc);
+          numProcNb.push_back(1);
+        }
+        else
+        {
+          std::sort(nodeBlocks.begin() + segBegin, nodeBlocks.begin() + segEnd);
+          const int sizeOld = procNbList.size();
+          for (RankI k = segBegin; k < segEnd; k++)
+            if (nodeBlocks[k] >= 0 && (procNbList.size() == sizeOld || procNbList.back() != nodeBlocks[k]))
+              procNbList.push_back(nodeBlocks[k]);
+          numProcNb.push_back(procNbList.size() - sizeOld);
+        }
+        segBegin = segEnd;
+      }
+
+      chunkBegin = chunkEnd;
+    }
+  }
+
+
+  //
+  // SFC_NodeSort::markInteriorHosts()
+  //
+  template <typename T, unsigned int dim>
+  void SFC_NodeSort<T,dim>::markInteriorHosts(TreeNode<T,dim> *cells, RankI *ids, RankI begin, RankI end,
+      const TreeNode<T,dim> *splitters, int sBegin, int sEnd, LevI lev, RotI pRot,
+      int &numPrevBlocks, int rProc, std::vector<char> &isInterior)
+  {
+    constexpr ChildI numChildren = TreeNode<T,dim>::numChildren;
+    const ChildI *rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+    const ChildI *rot_inv = SFC_Tables<dim>::rotInv(pRot);
+    const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
+
+    // Bucket cells. Cells in the ancestor bucket span splitters, so are never interior.
+    std::array<RankI, 1+numChildren> cellBuckets;
+    RankI ancStart, ancEnd;
+    SFC_Tree<T,dim>::template SFC_bucketing_general<KeyFunIdentity_TN<T,dim>, TreeNode<T,dim>, TreeNode<T,dim>, RankI>(
+        cells, ids, begin, end, lev, pRot, KeyFunIdentity_TN<T,dim>(), true, true, cellBuckets, ancStart, ancEnd);
+
+    // Count splitters.
+    std::array<RankI, numChildren> numSplittersInBucket;
+    numSplittersInBucket.fill(0);
+    for (int s = sBegin; s < sEnd; s++)
+    {
+      if (splitters[s].getLevel() < lev)
+        numPrevBlocks++;
+      else
+        numSplittersInBucket[rot_inv[splitters[s].getMortonIndex(lev)]]++;
+    }
+
+    for (ChildI child_sfc = 0; child_sfc < numChildren; child_sfc++)
+    {
+      const RankI cBegin = cellBuckets[child_sfc], cEnd = cellBuckets[child_sfc+1];
+      if (cEnd > cBegin && numSplittersInBucket[child_sfc] > 0)
+      {
+        if (lev < m_uiMaxDepth)
+          markInteriorHosts(cells, ids, cBegin, cEnd,
+              splitters, numPrevBlocks, numPrevBlocks + numSplittersInBucket[child_sfc],
+              lev+1, orientLookup[rot_perm[child_sfc]],
+              numPrevBlocks, rProc, isInterior);
+        else
+          numPrevBlocks += numSplittersInBucket[child_sfc];
+      }
+      else if (cEnd > cBegin && numPrevBlocks - 1 == rProc)
+      {
+        // The whole subtree is ours. Keys reach one finest unit beyond the host cell,
+        // except below the lower domain boundary, where none are generated.
+        const TreeNode<T,dim> subtree = cells[cBegin].getAncestor(lev);
+        const unsigned long subLen = 1ul << (m_uiMaxDepth - lev);
+        for (RankI ii = cBegin; ii < cEnd; ii++)
+        {
+          const unsigned long cellLen = 1ul << (m_uiMaxDepth - cells[ii].getLevel());
+          bool inside = true;
+          for (int d = 0; d < dim && inside; d++)
+          {
+            const unsigned long cMin = cells[ii].getX(d), sMin = subtree.getX(d);
+            inside = (cMin > sMin || cMin == 0) && (cMin + cellLen + 1 < sMin + subLen);
+          }
+          isInterior[ids[ii]] = inside;
+        }
+      }
+      else
+        numPrevBlocks += numSplittersInBucket[child_sfc];
+    }
+  }
+
+
+  //
+  // SFC_NodeSort::tagContainingBlocks()
+  //
+  template <typename T, unsigned int dim>
+  void SFC_NodeSort<T,dim>::tagContainingBlocks(TreeNode<T,dim> *keys, RankI *owners, int *blocks, RankI begin, RankI end,
+      const TreeNode<T,dim> *splitters, int sBegin, int sEnd, LevI lev, RotI pRot, int &numPrevBlocks)
+  {
+    constexpr ChildI numChildren = TreeNode<T,dim>::numChildren;
+    const ChildI *rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+    const ChildI *rot_inv = SFC_Tables<dim>::rotInv(pRot);
+    const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
+
+    // Bucket keys, moving their owners along.
+    std::array<RankI, 1+numChildren> keyBuckets;
+    RankI ancStart, ancEnd;
+    SFC_Tree<T,dim>::template SFC_bucketing_general<KeyFunIdentity_TN<T,dim>, TreeNode<T,dim>, TreeNode<T,dim>, RankI>(
+        keys, owners, begin, end, lev, pRot, KeyFunIdentity_TN<T,dim>(), true, true, keyBuckets, ancStart, ancEnd);
+
+    // Count splitters.
+    std::array<RankI, numChildren> numSplittersInBucket;
+    numSplittersInBucket.fill(0);
+    RankI numAncSplitters = 0;
+    for (int s = sBegin; s < sEnd; s++)
+    {
+      if (splitters[s].getLevel() < lev)
+        numAncSplitters++;
+      else
+        numSplittersInBucket[rot_inv[splitters[s].getMortonIndex(lev)]]++;
+    }
+
+    // Splitters in the ancestor bucket preceed keys.
+    numPrevBlocks += numAncSplitters;
+    std::fill(blocks + ancStart, blocks + ancEnd, numPrevBlocks - 1);
+
+    for (ChildI child_sfc = 0; child_sfc < numChildren; child_sfc++)
+    {
+      const RankI cBegin = keyBuckets[child_sfc], cEnd = keyBuckets[child_sfc+1];
+      if (lev < m_uiMaxDepth && cEnd > cBegin && numSplittersInBucket[child_sfc] > 0)
+      {
+        tagContainingBlocks(keys, owners, blocks, cBegin, cEnd,
+            splitters, numPrevBlocks, numPrevBlocks + numSplittersInBucket[child_sfc],
+            lev+1, orientLookup[rot_perm[child_sfc]],
+            numPrevBlocks);
+      }
+      else if (lev < m_uiMaxDepth)
+      {
+        std::fill(blocks + cBegin, blocks + cEnd, numPrevBlocks - 1);
+        numPrevBlocks += numSplittersInBucket[child_sfc];
+      }
+      else
+      {
+        // In leaf buckets splitters preceed keys, just as in ancestor buckets.
+        numPrevBlocks += numSplittersInBucket[child_sfc];
+        std::fill(blocks + cBegin, blocks + cEnd, numPrevBlocks - 1);
+      }
+    }
   }
 
 
@@ -1837,7 +2184,6 @@ namespace ot {
     if (ownedNodes_end <= ownedNodes_bg) { return; }
 
     constexpr char numChildren = TreeNode<T,dim>::numChildren;
-    constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
 
     // Locate buckets in ownedNodes. //
     std::array<RankI, numChildren+1> tempSplitters;
@@ -1877,8 +2223,8 @@ namespace ot {
 
 
     // Lookup tables to apply rotations.
-    const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-    const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+    const ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+    const RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
 
     if (sLev < eLev)  // This means eLev is further from the root level than sLev.
     {
@@ -1975,33 +2321,34 @@ namespace ot {
     MPI_Comm_rank(comm, &rProc);
     MPI_Comm_size(comm, &nProc);
 
-    std::vector<RankI> fullSendCounts(nProc);
-    auto scountIter = sm.m_sendCounts.cbegin();
-    auto sprocIter = sm.m_sendProc.cbegin();
-    while (scountIter < sm.m_sendCounts.cend())
-      fullSendCounts[*(sprocIter++)] = *(scountIter++);
-
-    // All to all to exchange counts. Receivers need to learn who they receive from.
-    std::vector<RankI> fullRecvCounts(nProc);
-    par::Mpi_Alltoall<RankI>(fullSendCounts.data(), fullRecvCounts.data(), 1, comm);
+    // Sparse exchange of counts. Receivers need to learn who they receive from.
+    std::vector<int> recvProc;
+    std::vector<RankI> recvCounts;
+    par::Mpi_Alltoall_NBX<RankI>(sm.m_sendProc.data(), sm.m_sendCounts.data(), (int) sm.m_sendProc.size(),
+                                 recvProc, recvCounts, 2, comm);
 
     // Compact the receive counts into the GatherMap struct.
+    // Our local nodes go between the ghosts received from lower and higher ranks.
     GatherMap gm;
     RankI accum = 0;
-    for (int proc = 0; proc < nProc; proc++)
+    bool locPlaced = false;
+    for (size_t rIdx = 0; rIdx < recvProc.size(); rIdx++)
     {
-      if (fullRecvCounts[proc] > 0)
-      {
-        gm.m_recvProc.push_back(proc);
-        gm.m_recvCounts.push_back(fullRecvCounts[proc]);
-        gm.m_recvOffsets.push_back(accum);
-        accum += fullRecvCounts[proc];
-      }
-      else if (proc == rProc)
+      if (!locPlaced && recvProc[rIdx] > rProc)
       {
         gm.m_locOffset = accum;             // Allocate space for our local nodes.
         accum += localCount;
+        locPlaced = true;
       }
+      gm.m_recvProc.push_back(recvProc[rIdx]);
+      gm.m_recvCounts.push_back(recvCounts[rIdx]);
+      gm.m_recvOffsets.push_back(accum);
+      accum += recvCounts[rIdx];
+    }
+    if (!locPlaced)
+    {
+      gm.m_locOffset = accum;
+      accum += localCount;
     }
     gm.m_totalCount = accum;
     gm.m_locCount = localCount;
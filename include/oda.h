@@ -17,11 +17,16 @@
 #include "refel.h"
 #include "binUtils.h"
 #include "octUtils.h"
+#include "profiler.h"
+#include "profRegistry.h"
+#include "matvec.h"
+#include "oct2vtk.h"
 
 #include <iostream>
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <numeric>
 #include <cstring>
 
 
@@ -37,6 +42,26 @@
 
 namespace ot
 {
+
+/**@brief: wall time spent in the phases of DA construction. */
+struct DAConstructTimers
+{
+    profiler_t t_activeComm;      // grain-size check and shrinking onto the active comm.
+    profiler_t t_extNodes;        // element-exterior node generation.
+    profiler_t t_countCGNodes;    // dist_countCGNodes (overlaps t_intNodes).
+    profiler_t t_intNodes;        // element-interior node generation.
+    profiler_t t_scattermap;      // computeScattermap.
+    profiler_t t_gathermap;       // scatter2gather.
+    profiler_t t_ghostCoords;     // ghost exchange of node coordinates.
+
+    void clear()
+    {
+        t_activeComm.clear();  t_extNodes.clear();    t_countCGNodes.clear();
+        t_intNodes.clear();    t_scattermap.clear();  t_gathermap.clear();
+        t_ghostCoords.clear();
+    }
+};
+
 template <unsigned int dim>
 class DA
 {
@@ -134,25 +159,113 @@ class DA
     /**@brief: coordinates of nodes in the vector. */
     std::vector<ot::TreeNode<C,dim>> m_tnCoords;
 
+    /**@brief: true if ghosts owned by on-node procs are read through a shared-memory window. */
+    bool m_uiShmGhostReads;
+
+    /**@brief: procs of the active comm that share memory with this proc. */
+    MPI_Comm m_uiNodeComm;
+
+    /**@brief: shared-memory window holding the on-node part of the staged ghost data. */
+    MPI_Win m_uiShmWin;
+
+    /**@brief: bytes reserved per node in the shared window (sizeof(VECType)*maxDof). */
+    size_t m_uiShmEntryBytes;
+
+    /**@brief: start of our own segment of the shared window. */
+    char * m_uiShmLocalBase;
+
+    /**@brief: number of nodes staged in our own segment of the shared window. */
+    DendroIntL m_uiShmSendSz;
+
+    /**@brief: for each node staged in our shared segment, its local node index. */
+    std::vector<RankI> m_uiShmSendMap;
+
+    /**@brief: per send proc, offset (in nodes) of its data in our shared segment, or -1 if off-node. */
+    std::vector<DendroIntL> m_uiShmSendOffsets;
+
+    /**@brief: per recv proc, its rank in m_uiNodeComm, or MPI_UNDEFINED if off-node. */
+    std::vector<int> m_uiShmRecvNodeRank;
+
+    /**@brief: per recv proc, offset (in nodes) of our ghosts in its shared segment. */
+    std::vector<DendroIntL> m_uiShmRecvOffsets;
+
+    /**@brief: per recv proc, start of its segment of the shared window. */
+    std::vector<const char *> m_uiShmRecvBase;
+
     //TODO I don't think RefElement member belongs in DA (distributed array),
     //  but it has to go somewhere that the polyOrder is known.
     RefElement m_refel;
 
+    /**@brief: local elements of the active partition, in SFC order. */
+    std::vector<ot::TreeNode<C,dim>> m_tnElements;
+
+    /**@brief: for each local node, its index in the node order produced by construct(). */
+    std::vector<unsigned int> m_uiLocalNodePerm;
+
+    /**@brief: all (ghosted) node ids sorted by coordinates, then level; built on first use by indexNodesByCoords(), empty until then. */
+    std::vector<unsigned int> m_uiNodesByCoords;
+
+    /**@brief: timings of the last call to construct(). */
+    DAConstructTimers m_uiConstructTimers;
+
+    /**@brief: begin offsets of the active local segments, over all procs of the global comm (length npesAll+1). */
+    std::vector<DendroIntL> getActiveNodeBegins() const;
+
+    /**@brief: allocates the shared ghost window with entryBytes per node. Collective on m_uiNodeComm. */
+    void allocateShmWindow(size_t entryBytes);
+
+    /**@brief: true if a ghost read of nodes of entryBytes goes through the shared window. */
+    inline bool useShmGhostReads(size_t entryBytes) const { return m_uiShmGhostReads && entryBytes <= m_uiShmEntryBytes; }
+
+    /**
+     * @brief: one linear cell per local element (4D: the slice x[3]==sliceCoord), for vecTopvtu() and vecToSingleFile().
+     * @param [out] pointCoords: 3 coordinates per cell corner, corners in vtk order.
+     * @param [out] cellLevels: level of each cell.
+     * @param [out] pointData: per dof, the value at each cell corner.
+     */
+    template <typename T>
+    void vecToCells(const T *local, bool isGhosted, unsigned int dof, double sliceCoord,
+                    std::vector<double> &pointCoords, std::vector<unsigned int> &cellLevels, std::vector<std::vector<T>> &pointData);
+
+    /**@brief: buffers of getElementNodalValues(), reused from one element to the next. */
+    struct ElementValuesScratch
+    {
+        std::vector<ot::TreeNode<C,dim>> m_nodes;
+        std::vector<long> m_ids;
+        std::vector<long> m_parentIds;
+        std::vector<double> m_parentValues;
+    };
+
+    /**
+     * @brief: values at the (order+1)^dim lexicographic nodes of a local element, from a ghosted vector.
+     *         Nodes missing on the element (hanging) are interpolated from its parent.
+     * @return: false if the nodes of the parent are missing too.
+     * @pre: indexNodesByCoords() has been called since the nodes were last (re)numbered.
+     */
+    template <typename T>
+    bool getElementNodalValues(const T *ghosted, unsigned int dof, const ot::TreeNode<C,dim> &element, double *values,
+                               ElementValuesScratch &scratch);
+
+    /**@brief: builds m_uiNodesByCoords from m_tnCoords, unless it is built already. Clear it to invalidate. */
+    void indexNodesByCoords();
+
   public:
 
         /**@brief: Constructor for the DA data structures
          * @param [in] in : input octree, need to be 2:1 balanced unique sorted octree.
          * @param [in] comm: MPI global communicator for mesh generation.
          * @param [in] order: order of the element.
-         * @param [in] grainSz: Number of suggested elements per processor,
+         * @param [in] grainSz: Minimum elements per active processor. If the tree is smaller
+         *                      than grainSz per proc, the DA shrinks onto fewer procs (see isActive()).
+         *                      The maximum over all procs is used. 0 (default) never shrinks.
          * @param [in] sfc_tol: SFC partitioning tolerance,
          */
         DA();
 
-        DA(const ot::TreeNode<C,dim> *inTree, unsigned int nEle, MPI_Comm comm, unsigned int order, unsigned int grainSz = 100, double sfc_tol = 0.3);
+        DA(const ot::TreeNode<C,dim> *inTree, unsigned int nEle, MPI_Comm comm, unsigned int order, unsigned int grainSz = 0, double sfc_tol = 0.3);
 
 
-        /** @brief Construct oda for regular grid. */
+        /** @brief Construct oda for regular grid, with at least grainSz elements per processor. */
         DA(MPI_Comm comm, unsigned int order, unsigned int grainSz = 100, double sfc_tol = 0.3);
 
         /**@brief: Construct a DA from a function
@@ -160,17 +273,21 @@ class DA
          * @param [in] comm: MPI global communicator for mesh generation.
          * @param [in] order: order of the element.
          * @param [in] interp_tol: allowable interpolation error against func; controls refinement.
-         * @param [in] grainSz: Number of suggested elements per processor.
+         * @param [in] grainSz: Minimum elements per active processor, as above. 0 (default) never shrinks.
          * @param [in] sfc_tol: SFC partitioning tolerance,
          */
         template <typename T>
-        DA(std::function<void(const T *, T *)> func, unsigned int dofSz, MPI_Comm comm, unsigned int order, double interp_tol, unsigned int grainSz = 100, double sfc_tol = 0.3);
+        DA(std::function<void(const T *, T *)> func, unsigned int dofSz, MPI_Comm comm, unsigned int order, double interp_tol, unsigned int grainSz = 0, double sfc_tol = 0.3);
 
         /**
          * @brief deconstructor for the DA class.
          * */
         ~DA();
 
+        /**@brief: not copyable; a DA owns its communicators and shared window. */
+        DA(const DA &) = delete;
+        DA & operator=(const DA &) = delete;
+
         /**
          * @brief does the work for the constructors.
          */
@@ -206,6 +323,9 @@ class DA
         /**@brief get element order*/
         inline unsigned int getElementOrder() const { return m_uiElementOrder; }
 
+        /**@brief: timings of the phases of DA construction on this proc. */
+        inline const DAConstructTimers & getConstructTimers() const { return m_uiConstructTimers; }
+
         /**@brief: returns the global MPI communicator*/
         inline MPI_Comm getGlobalComm() const { return m_uiGlobalComm; }
 
@@ -307,6 +427,22 @@ class DA
         template <typename T>
         void readFromGhostEnd(T *vec, unsigned int dof = 1);
 
+        /**
+          * @brief Read ghosts owned by procs on the same node directly through an MPI
+          *        shared-memory window; only off-node neighbours exchange messages.
+          * @param [in] maxDof: the window holds maxDof values of VECType per node. Reads of
+          *        wider nodes (sizeof(T)*dof larger than that) exchange messages as before.
+          * @note Collective on the active comm. Call with no ghost exchange in flight.
+          *       While enabled, at most one readFromGhost exchange may be in flight at a time.
+          * */
+        void enableSharedGhostReads(unsigned int maxDof = 1);
+
+        /**@brief Return to message-based ghost reads and release the shared window. */
+        void disableSharedGhostReads();
+
+        /**@brief true if on-node ghosts are read through shared memory. */
+        inline bool isSharedGhostReads() const { return m_uiShmGhostReads; }
+
         /**
          * @brief Initiate accumilation across ghost elements
          * @note It is assumed the dofs {A,B,C} are stored ABC ABC ABC ABC.
@@ -342,6 +478,64 @@ class DA
         template <typename T>
         void ghostedNodalToNodalVec(const T *gVec, T *&local, bool isAllocated = false, unsigned int dof = 1) const;
 
+        /**
+             * @brief renumber the local nodes in the order they are first touched by
+             *        a traversal of the local elements in SFC order. Ghost segments keep their order.
+             * @note vectors created before the call are in the old order; use getLocalNodePermutation()
+             *       or constructionOrderToNodalVec() to carry them over.
+             * */
+        void renumberNodesFirstTouch();
+
+        /**@brief: for each local node, its index in the node order produced by construct(). */
+        inline const std::vector<unsigned int> & getLocalNodePermutation() const { return m_uiLocalNodePerm; }
+
+        /**
+             * @brief permute a nodal local vector (non ghosted) from the current node order to the construction order.
+             * @param[in] in: input vector in the current node order
+             * @param[out] out: output vector in the construction order (allocated, distinct from in)
+             * @param[in] dof: degrees of freedoms
+             * */
+        template <typename T>
+        void nodalVecToConstructionOrder(const T *in, T *out, unsigned int dof = 1) const;
+
+        /**
+             * @brief permute a nodal local vector (non ghosted) from the construction order to the current node order.
+             * @param[in] in: input vector in the construction order
+             * @param[out] out: output vector in the current node order (allocated, distinct from in)
+             * @param[in] dof: degrees of freedoms
+             * */
+        template <typename T>
+        void constructionOrderToNodalVec(const T *in, T *out, unsigned int dof = 1) const;
+
+        /**@brief returns the local nodal size in the full layout, in which the global
+         *        node ordering is split evenly over all procs of the global comm. */
+        inline unsigned int getFullNodalSz() const
+        {
+            return m_uiGlobalNodeSz / m_uiGlobalNpes + (m_uiRankGlobal < m_uiGlobalNodeSz % m_uiGlobalNpes ? 1 : 0);
+        }
+
+        /**
+             * @brief move a nodal local vector (non ghosted) from the active layout to the full layout.
+             * @param[in] activeVec: input vector over the active procs (ignored on inactive procs)
+             * @param[out] fullVec: vector of size dof*getFullNodalSz() on every proc of the global comm.
+             * @param[in] isAllocated: true if the out is allocated, false otherwise.
+             * @param[in] dof: degrees of freedoms
+             * @note collective on the global comm.
+             * */
+        template <typename T>
+        void activeToFullNodalVec(const T *activeVec, T *&fullVec, bool isAllocated = false, unsigned int dof = 1) const;
+
+        /**
+             * @brief move a nodal local vector (non ghosted) from the full layout back to the active layout.
+             * @param[in] fullVec: vector of size dof*getFullNodalSz() on every proc of the global comm.
+             * @param[out] activeVec: output vector over the active procs (untouched on inactive procs)
+             * @param[in] isAllocated: true if the out is allocated, false otherwise.
+             * @param[in] dof: degrees of freedoms
+             * @note collective on the global comm.
+             * */
+        template <typename T>
+        void fullToActiveNodalVec(const T *fullVec, T *&activeVec, bool isAllocated = false, unsigned int dof = 1) const;
+
         /**
              * @brief initialize a variable vector to a function depends on spatial coords.
              * @param[in/out] local: allocated vector, initialized vector -- offset by the dofIdx
@@ -372,12 +566,43 @@ class DA
         /**@brief write the vec to pvtu file
              * @param[in] local: variable vector
              * @param[in] fPrefix: file name prefix
+             * @param[in] nodalVarNames: names of the dof variables (default: var0, var1, ...)
              * @param [in] isElemental: True if creating a elemental vector (cell data vector) false for a nodal vector
              * @param [in] isGhosted: True will allocate ghost nodal values as well, false will only allocate memory for local nodes.
              * @param [in] dof: degrees of freedoms
+             * @param [in] sliceCoord: (4D only) writes the 3D slice x[3] == sliceCoord of the unit domain.
+             * @note: writes one linear cell per element, with the values at the element corners
+             *        (hanging corners are interpolated). Collective on the active comm.
              * */
         template <typename T>
-        void vecTopvtu(T *local, const char *fPrefix, char **nodalVarNames = NULL, bool isElemental = false, bool isGhosted = false, unsigned int dof = 1);
+        void vecTopvtu(const T *local, const char *fPrefix, char **nodalVarNames = NULL, bool isElemental = false, bool isGhosted = false, unsigned int dof = 1, double sliceCoord = 0.0);
+
+        /**@brief write the vec to a single binary file <fPrefix>.bin with MPI-IO, described by <fPrefix>.json and <fPrefix>.xmf
+             * @note: same cells and arguments as vecTopvtu(); see io::vtk::cells2mpiio().
+             * @return 0 on success. Collective on the active comm.
+             * */
+        template <typename T>
+        int vecToSingleFile(const T *local, const char *fPrefix, char **nodalVarNames = NULL, bool isElemental = false, bool isGhosted = false, unsigned int dof = 1, double sliceCoord = 0.0);
+
+        /**
+         * @brief extracts the (dim-1)-dimensional slice x[sliceDim] == sliceCoord of a nodal vector,
+         *        e.g. the 3D spatial slice at a fixed time of a 4D space-time vector.
+         * @param [in] local: nodal vector (interleaved dofs). If isGhosted, its ghosts must have been read.
+         * @param [in] sliceDim: axis normal to the slice.
+         * @param [in] sliceCoord: position of the slice in the unit domain.
+         * @param [out] sliceTree: for each local element cut by the slice, the element without axis sliceDim (see projectSliceKTree()).
+         * @param [out] sliceValues: for each leaf of sliceTree, the values at its (order+1)^(dim-1) lexicographic nodes, dofs interleaved.
+         * @return number of elements whose nodal values could not be found (0 on success).
+         * @note: the elements are found by descending the SFC-sorted local elements into the subtrees cut by
+         *        the slice only, and the values are interpolated with the element basis, using the index of
+         *        the nodes by coordinates built with the DA. With a ghosted input the cost is in the size of
+         *        the slice. If !isGhosted, the whole vector is first copied and its ghosts are read, which
+         *        costs O(local nodes) and is collective on the active comm.
+         * */
+        template <typename T>
+        DendroIntL extractSlice(const T *local, unsigned int sliceDim, double sliceCoord,
+                                std::vector<ot::TreeNode<C,dim-1>> &sliceTree, std::vector<T> &sliceValues,
+                                bool isGhosted = false, unsigned int dof = 1);
 
         /**
              * @brief returns a pointer to a dof index,
@@ -501,7 +726,7 @@ class DA
              * @param [in] isGhosted: True will allocate ghost nodal values as well, false will only allocate memory for local nodes.
              * @param [in] dof: degrees of freedoms
              * */
-        void petscVecTopvtu(const Vec &local, const char *fPrefix, char **nodalVarNames = NULL, bool isElemental = false, bool isGhosted = false, unsigned int dof = 1);
+        void petscVecTopvtu(const Vec &local, const char *fPrefix, char **nodalVarNames = NULL, bool isElemental = false, bool isGhosted = false, unsigned int dof = 1, double sliceCoord = 0.0);
 
         /**
              * @brief a wrapper for setting values into the Matrix.  This internally calls PETSc's MatSetValues() function.
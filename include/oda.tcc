@@ -60,6 +60,93 @@ namespace ot
         SFC_Tree<C,dim>::distTreeSort(outTree, sfc_tol, comm);
       }
 
+
+      /**
+       * @brief Moves a distributed array into a new contiguous layout, preserving global order.
+       * @param src Local segment, which starts at global index srcBegin and has srcSz entries.
+       * @param dest [out] Local segment of the new layout, preallocated to dof*(destBegins[rProc+1]-destBegins[rProc]).
+       * @param destBegins Global index where each proc's new segment begins, length nProc+1.
+       * @param dof Values per entry; counts and offsets refer to entries.
+       * @note Senders know the new layout, receivers learn their sources by sparse exchange.
+       */
+      template <typename T>
+      void redistribute(const T *src, DendroIntL srcBegin, DendroIntL srcSz,
+                        T *dest, const std::vector<DendroIntL> &destBegins,
+                        unsigned int dof, MPI_Comm comm)
+      {
+        int nProc, rProc;
+        MPI_Comm_size(comm, &nProc);
+        MPI_Comm_rank(comm, &rProc);
+
+        const DendroIntL destBegin = destBegins[rProc];
+        const DendroIntL destSz = destBegins[rProc+1] - destBegin;
+
+        // Our segment overlaps a contiguous run of destination procs.
+        std::vector<int> sendProc;
+        std::vector<DendroIntL> sendCounts;
+        std::vector<DendroIntL> sendOffsets;
+        const DendroIntL srcEnd = srcBegin + srcSz;
+        int proc = std::upper_bound(destBegins.begin(), destBegins.end() - 1, srcBegin) - destBegins.begin() - 1;
+        for (; srcSz > 0 && proc < nProc && destBegins[proc] < srcEnd; proc++)
+        {
+          const DendroIntL overlapBegin = std::max(srcBegin, destBegins[proc]);
+          const DendroIntL overlapEnd = std::min(srcEnd, destBegins[proc+1]);
+          if (overlapEnd <= overlapBegin)
+            continue;
+
+          if (proc == rProc)     // Copy our own part directly.
+            std::copy(src + dof * (overlapBegin - srcBegin), src + dof * (overlapEnd - srcBegin),
+                      dest + dof * (overlapBegin - destBegin));
+          else
+          {
+            sendProc.push_back(proc);
+            sendCounts.push_back(overlapEnd - overlapBegin);
+            sendOffsets.push_back(overlapBegin - srcBegin);
+          }
+        }
+
+        std::vector<int> recvProc;
+        std::vector<DendroIntL> recvCounts;
+        par::Mpi_Alltoall_NBX<DendroIntL>(sendProc.data(), sendCounts.data(), (int) sendProc.size(),
+                                          recvProc, recvCounts, 1, comm);
+
+        // Sources are ordered by rank, hence by global index. Our own part
+        // (if any) is already in place, between the lower and higher sources.
+        const DendroIntL ownSz = destSz - std::accumulate(recvCounts.begin(), recvCounts.end(), (DendroIntL) 0);
+        std::vector<MPI_Request> requests(sendProc.size() + recvProc.size());
+        DendroIntL recvOffset = 0;
+        bool ownPlaced = false;
+        for (size_t rIdx = 0; rIdx < recvProc.size(); rIdx++)
+        {
+          if (!ownPlaced && recvProc[rIdx] > rProc)
+          {
+            recvOffset += ownSz;
+            ownPlaced = true;
+          }
+          par::Mpi_Irecv(dest + dof * recvOffset, (int) (dof * recvCounts[rIdx]),
+                         recvProc[rIdx], 0, comm, &requests[rIdx]);
+          recvOffset += recvCounts[rIdx];
+        }
+
+        for (size_t sIdx = 0; sIdx < sendProc.size(); sIdx++)
+          par::Mpi_Isend(const_cast<T *>(src) + dof * sendOffsets[sIdx], (int) (dof * sendCounts[sIdx]),
+                         sendProc[sIdx], 0, comm, &requests[recvProc.size() + sIdx]);
+
+        MPI_Waitall((int) requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+      }
+
+
+      /**
+       * @brief Begin offsets (length nProc+1) of numTotal entries split evenly over the first numParts of nProc procs.
+       */
+      inline std::vector<DendroIntL> evenSplitBegins(DendroIntL numTotal, int numParts, int nProc)
+      {
+        std::vector<DendroIntL> begins(nProc + 1, numTotal);
+        for (int p = 0; p < numParts; p++)
+          begins[p] = numTotal / numParts * p + std::min<DendroIntL>(p, numTotal % numParts);
+        return begins;
+      }
+
     }//namespace ot::util
 
 
@@ -205,12 +292,73 @@ namespace ot
         std::copy(srcStart, srcStart + dof*m_uiLocalNodalSz, local);
     }
 
+    template <unsigned int dim>
+    template<typename T>
+    void DA<dim>::nodalVecToConstructionOrder(const T* in, T* out, unsigned int dof) const
+    {
+        if(!(m_uiIsActive))
+            return;
+
+        for (unsigned int ii = 0; ii < m_uiLocalNodalSz; ii++)
+            std::copy(in + dof*ii, in + dof*(ii+1), out + dof*m_uiLocalNodePerm[ii]);
+    }
+
+    template <unsigned int dim>
+    template<typename T>
+    void DA<dim>::constructionOrderToNodalVec(const T* in, T* out, unsigned int dof) const
+    {
+        if(!(m_uiIsActive))
+            return;
+
+        for (unsigned int ii = 0; ii < m_uiLocalNodalSz; ii++)
+            std::copy(in + dof*m_uiLocalNodePerm[ii], in + dof*(m_uiLocalNodePerm[ii]+1), out + dof*ii);
+    }
+
+    template <unsigned int dim>
+    std::vector<DendroIntL> DA<dim>::getActiveNodeBegins() const
+    {
+        // Active procs are the lowest ranks of the global comm, in order.
+        DendroIntL myBegin = (m_uiIsActive ? m_uiGlobalRankBegin : m_uiGlobalNodeSz);
+        std::vector<DendroIntL> begins(m_uiGlobalNpes + 1, m_uiGlobalNodeSz);
+        par::Mpi_Allgather<DendroIntL>(&myBegin, begins.data(), 1, m_uiGlobalComm);
+        return begins;
+    }
+
+    template <unsigned int dim>
+    template<typename T>
+    void DA<dim>::activeToFullNodalVec(const T* activeVec, T*& fullVec, bool isAllocated, unsigned int dof) const
+    {
+        if(!isAllocated)
+            fullVec = new T[dof*getFullNodalSz()];
+
+        const std::vector<DendroIntL> fullBegins = util::evenSplitBegins(m_uiGlobalNodeSz, m_uiGlobalNpes, m_uiGlobalNpes);
+        const DendroIntL activeBegin = (m_uiIsActive ? m_uiGlobalRankBegin : m_uiGlobalNodeSz);
+        const DendroIntL activeSz = (m_uiIsActive ? m_uiLocalNodalSz : 0);
+
+        util::redistribute<T>(activeVec, activeBegin, activeSz, fullVec, fullBegins, dof, m_uiGlobalComm);
+    }
+
+    template <unsigned int dim>
+    template<typename T>
+    void DA<dim>::fullToActiveNodalVec(const T* fullVec, T*& activeVec, bool isAllocated, unsigned int dof) const
+    {
+        if(!isAllocated)
+            createVector<T>(activeVec,false,false,dof);
+
+        const std::vector<DendroIntL> activeBegins = getActiveNodeBegins();
+        const std::vector<DendroIntL> fullBegins = util::evenSplitBegins(m_uiGlobalNodeSz, m_uiGlobalNpes, m_uiGlobalNpes);
+
+        util::redistribute<T>(fullVec, fullBegins[m_uiRankGlobal], getFullNodalSz(), activeVec, activeBegins, dof, m_uiGlobalComm);
+    }
+
 
 
     template <unsigned int dim>
     template <typename T>
     void DA<dim>::readFromGhostBegin(T* vec,unsigned int dof)
     {
+        DENDRO_PROF_SCOPE("readFromGhostBegin");
+
         // Send to downstream, recv from upstream.
 
         if (m_uiGlobalNpes==1)
@@ -231,6 +379,8 @@ namespace ot
           const unsigned int upstBSz = m_uiTotalNodalSz - m_uiLocalNodalSz;
           const unsigned int dnstBSz = m_sm.m_map.size();
 
+          const bool useShm = useShmGhostReads(sizeof(T)*dof);
+
           // 2. Initiate recvs. Since vec is collated [abc abc], can receive into vec.
           if (upstBSz)
           {
@@ -241,6 +391,12 @@ namespace ot
 
             for (unsigned int upstIdx = 0; upstIdx < nUpstProcs; upstIdx++)
             {
+              if (useShm && m_uiShmRecvNodeRank[upstIdx] != MPI_UNDEFINED)
+              {
+                reql[upstIdx] = MPI_REQUEST_NULL;     // Read from shared memory in readFromGhostEnd().
+                continue;
+              }
+
               T *upstProcStart = upstB + dof*m_gm.m_recvOffsets[upstIdx];
               unsigned int upstCount = dof*m_gm.m_recvCounts[upstIdx];
               unsigned int upstProc = m_gm.m_recvProc[upstIdx];
@@ -255,20 +411,46 @@ namespace ot
             dnstB = (T*) ctx.getSendBuffer();
             MPI_Request *reql = ctx.getDnstRequestList();
 
-            // 3a. Stage the send data.
-            for (unsigned int k = 0; k < dnstBSz; k++)
+            // 3a. Stage the send data for off-node procs.
+            for (unsigned int dnstIdx = 0; dnstIdx < nDnstProcs; dnstIdx++)
+            {
+              if (useShm && m_uiShmSendOffsets[dnstIdx] >= 0)
+                continue;
+              const RankI sendBegin = m_sm.m_sendOffsets[dnstIdx];
+              const RankI sendCount = m_sm.m_sendCounts[dnstIdx];
+              for (RankI k = 0; k < sendCount; k++)
+              {
+                const T *nodeSrc = vec + dof * (m_sm.m_map[sendBegin + k] + m_uiLocalNodeBegin);
+                std::copy(nodeSrc, nodeSrc + dof, dnstB + dof * (sendBegin + k));
+              }
+            }
+
+            // Data for all on-node procs goes to our shared segment, in one parallel loop.
+            if (useShm)
             {
-              const T *nodeSrc = vec + dof * (m_sm.m_map[k] + m_uiLocalNodeBegin);
-              std::copy(nodeSrc, nodeSrc + dof, dnstB + dof * k);
+              T * const stageB = (T*) m_uiShmLocalBase;
+              #pragma omp parallel for
+              for (DendroIntL k = 0; k < m_uiShmSendSz; k++)
+              {
+                const T *nodeSrc = vec + dof * (m_uiShmSendMap[k] + m_uiLocalNodeBegin);
+                std::copy(nodeSrc, nodeSrc + dof, stageB + dof * k);
+              }
             }
 
             // 3b. Fire the sends.
             for (unsigned int dnstIdx = 0; dnstIdx < nDnstProcs; dnstIdx++)
             {
+              if (useShm && m_uiShmSendOffsets[dnstIdx] >= 0)
+              {
+                reql[dnstIdx] = MPI_REQUEST_NULL;
+                continue;
+              }
+
               T *dnstProcStart = dnstB + dof * m_sm.m_sendOffsets[dnstIdx];
               unsigned int dnstCount = dof*m_sm.m_sendCounts[dnstIdx];
               unsigned int dnstProc = m_sm.m_sendProc[dnstIdx];
               par::Mpi_Isend(dnstProcStart, dnstCount, dnstProc, m_uiCommTag, m_uiActiveComm, &reql[dnstIdx]);
+              DENDRO_PROF_BYTES(sizeof(T) * dnstCount);
             }
           }
         }
@@ -280,6 +462,8 @@ namespace ot
     template <typename T>
     void DA<dim>::readFromGhostEnd(T *vec,unsigned int dof)
     {
+        DENDRO_PROF_SCOPE("readFromGhostEnd");
+
         if (m_uiGlobalNpes==1)
             return;
 
@@ -299,6 +483,24 @@ namespace ot
         const unsigned int nUpstProcs = m_gm.m_recvProc.size();
         const unsigned int nDnstProcs = m_sm.m_sendProc.size();
 
+        // 1b. Copy on-node ghosts straight out of the owners' shared segments.
+        if (useShmGhostReads(sizeof(T)*dof))
+        {
+          MPI_Win_sync(m_uiShmWin);
+          MPI_Barrier(m_uiNodeComm);     // Owners have finished staging.
+          MPI_Win_sync(m_uiShmWin);
+
+          for (unsigned int upstIdx = 0; upstIdx < nUpstProcs; upstIdx++)
+          {
+            if (m_uiShmRecvNodeRank[upstIdx] == MPI_UNDEFINED)
+              continue;
+            const T *src = (const T*) m_uiShmRecvBase[upstIdx] + dof * m_uiShmRecvOffsets[upstIdx];
+            std::copy(src, src + dof * m_gm.m_recvCounts[upstIdx], vec + dof * m_gm.m_recvOffsets[upstIdx]);
+          }
+
+          MPI_Barrier(m_uiNodeComm);     // Owners may stage again.
+        }
+
         // 2. Wait on recvs and sends.
         reql = ctxPtr->getUpstRequestList();
         for (int upstIdx = 0; upstIdx < nUpstProcs; upstIdx++)
@@ -318,6 +520,8 @@ namespace ot
     template <typename T>
     void DA<dim>::writeToGhostsBegin(T *vec, unsigned int dof)
     {
+        DENDRO_PROF_SCOPE("writeToGhostsBegin");
+
         // The same as readFromGhosts, but roles reversed:
         // Send to upstream, recv from downstream.
 
@@ -369,6 +573,7 @@ namespace ot
               unsigned int upstCount = dof*m_gm.m_recvCounts[upstIdx];
               unsigned int upstProc = m_gm.m_recvProc[upstIdx];
               par::Mpi_Isend(upstProcStart, upstCount, upstProc, m_uiCommTag, m_uiActiveComm, &reql[upstIdx]);
+              DENDRO_PROF_BYTES(sizeof(T) * upstCount);
             }
           }
         }
@@ -381,6 +586,8 @@ namespace ot
     template <typename T>
     void DA<dim>::writeToGhostsEnd(T *vec, unsigned int dof)
     {
+        DENDRO_PROF_SCOPE("writeToGhostsEnd");
+
         // The same as readFromGhosts, but roles reversed:
         // Send to upstream, recv from downstream.
 
@@ -452,10 +659,11 @@ namespace ot
         if (!isElemental)
         {
             const unsigned int nodalSz = (isGhosted ? m_uiTotalNodalSz : m_uiLocalNodalSz);
+            const unsigned int coordsBegin = (isGhosted ? 0 : m_uiLocalNodeBegin);
             // Assumes interleaved variables, [abc][abc].
             for (unsigned int k = 0; k < nodalSz; k++)
             {
-                m_tnCoords[k].getAnchor(tnCoords);
+                m_tnCoords[coordsBegin + k].getAnchor(tnCoords);
                 #pragma unroll(edim)
                 for (int d = 0; d < edim; d++)
                   fCoords[d] = scale * tnCoords[d];
@@ -545,10 +753,342 @@ namespace ot
 
     template <unsigned int dim>
     template <typename T>
-    void DA<dim>::vecTopvtu(T* local, const char * fPrefix,char** nodalVarNames,bool isElemental,bool isGhosted,unsigned int dof)
+    void DA<dim>::vecToCells(const T *local, bool isGhosted, unsigned int dof, double sliceCoord,
+                             std::vector<double> &pointCoords, std::vector<unsigned int> &cellLevels, std::vector<std::vector<T>> &pointData)
     {
-      //TODO
+        // Elements are written as linear cells of dimension up to 3.
+        // 4D elements are cut by the hyperplane x[3]==sliceCoord, interpolating linearly in x[3].
+        constexpr unsigned int cellDim = (dim < 3 ? dim : 3);
+        constexpr unsigned int numCorners = 1u << cellDim;
+        const unsigned int order = m_uiElementOrder;
+
+        // Lexicographic index of an element node at a corner (bit d: upper side of axis d).
+        auto cornerNode = [order](unsigned int bits)
+        {
+            unsigned int idx = 0, stride = 1;
+            for (unsigned int d = 0; d < dim; d++, stride *= (order + 1))
+                if ((bits >> d) & 1u)
+                    idx += order * stride;
+            return idx;
+        };
+
+        pointCoords.clear();
+        cellLevels.clear();
+        pointData.assign(dof, std::vector<T>());
+
+        // One ghost exchange for all dofs. The ghost segments of a ghosted input are not trusted.
+        std::vector<T> ghosted((size_t) dof * m_uiTotalNodalSz);
+        const T *ownedIn = local + (isGhosted ? (size_t) dof * m_uiLocalNodeBegin : 0);
+        std::copy(ownedIn, ownedIn + (size_t) dof * m_uiLocalNodalSz, ghosted.begin() + (size_t) dof * m_uiLocalNodeBegin);
+        readFromGhostBegin(ghosted.data(), dof);
+        readFromGhostEnd(ghosted.data(), dof);
+
+        // One pass over the local elements, gathering all dofs of each element at once.
+        const unsigned int npe = m_uiNpE;
+        const double domainScale = 1.0 / (1u << m_uiMaxDepth);
+        std::vector<double> eleValues((size_t) dof * npe);
+        ElementValuesScratch scratch;
+        indexNodesByCoords();
+        for (const ot::TreeNode<C,dim> &element : m_tnElements)
+        {
+            const double h = domainScale * (1u << (m_uiMaxDepth - element.getLevel()));
+            double w = 0.0;
+            if (dim == 4)
+            {
+                const double lo = domainScale * element.getX(3);
+                const double hi = lo + h;
+                if (!(lo <= sliceCoord && (sliceCoord < hi || (hi >= 1.0 && sliceCoord <= hi))))
+                    continue;
+                w = (sliceCoord - lo) / h;
+            }
+
+            getElementNodalValues(ghosted.data(), dof, element, eleValues.data(), scratch);
+
+            for (unsigned int k = 0; k < numCorners; k++)
+            {
+                const unsigned int bits = io::vtk::vtk_corner_bits(k);
+                const unsigned int n0 = cornerNode(bits);
+                for (unsigned int d = 0; d < 3; d++)
+                    pointCoords.push_back(d < cellDim ? domainScale * element.getX(d) + ((bits >> d) & 1u) * h : 0.0);
+                for (unsigned int var = 0; var < dof; var++)
+                {
+                    const double *values = &eleValues[(size_t) var * npe];
+                    pointData[var].push_back((T) (dim == 4 ? (1.0 - w) * values[n0] + w * values[cornerNode(bits | 8u)] : values[n0]));
+                }
+            }
+            cellLevels.push_back(element.getLevel());
+        }
+    }
+
+
+    template <unsigned int dim>
+    template <typename T>
+    void DA<dim>::vecTopvtu(const T* local, const char * fPrefix,char** nodalVarNames,bool isElemental,bool isGhosted,unsigned int dof,double sliceCoord)
+    {
+        if (!m_uiIsActive)
+            return;
+
+        if (isElemental)
+        {
+            std::cout << "vecTopvtu(): elemental vectors are not supported yet." << std::endl;
+            return;
+        }
+
+        constexpr unsigned int cellDim = (dim < 3 ? dim : 3);
+        std::vector<double> pointCoords;
+        std::vector<unsigned int> cellLevels;
+        std::vector<std::vector<T>> pointData;
+        vecToCells(local, isGhosted, dof, sliceCoord, pointCoords, cellLevels, pointData);
+
+        std::vector<std::string> names(dof);
+        std::vector<const char *> namePtrs(dof);
+        std::vector<const T *> dataPtrs(dof);
+        for (unsigned int var = 0; var < dof; var++)
+        {
+            names[var] = (nodalVarNames != NULL ? std::string(nodalVarNames[var]) : "var" + std::to_string(var));
+            namePtrs[var] = names[var].c_str();
+            dataPtrs[var] = pointData[var].data();
+        }
+
+        // A piece without cells (4D: none cut by the slice) still lists cell_level, like the others.
+        const unsigned int noCellLevels = 0;
+        io::vtk::cells2vtu<T>(fPrefix, cellDim, cellLevels.size(), pointCoords.data(),
+            (cellLevels.empty() ? &noCellLevels : cellLevels.data()),
+            dof, namePtrs.data(), dataPtrs.data(), m_uiActiveComm);
+    }
+
+
+    template <unsigned int dim>
+    template <typename T>
+    int DA<dim>::vecToSingleFile(const T* local, const char * fPrefix,char** nodalVarNames,bool isElemental,bool isGhosted,unsigned int dof,double sliceCoord)
+    {
+        if (!m_uiIsActive)
+            return 0;
+
+        if (isElemental)
+        {
+            std::cout << "vecToSingleFile(): elemental vectors are not supported yet." << std::endl;
+            return 1;
+        }
+
+        constexpr unsigned int cellDim = (dim < 3 ? dim : 3);
+        std::vector<double> pointCoords;
+        std::vector<unsigned int> cellLevels;
+        std::vector<std::vector<T>> pointData;
+        vecToCells(local, isGhosted, dof, sliceCoord, pointCoords, cellLevels, pointData);
+
+        std::vector<std::string> names(dof);
+        std::vector<const char *> namePtrs(dof);
+        std::vector<const T *> dataPtrs(dof);
+        for (unsigned int var = 0; var < dof; var++)
+        {
+            names[var] = (nodalVarNames != NULL ? std::string(nodalVarNames[var]) : "var" + std::to_string(var));
+            namePtrs[var] = names[var].c_str();
+            dataPtrs[var] = pointData[var].data();
+        }
+
+        return io::vtk::cells2mpiio<T>(fPrefix, cellDim, cellLevels.size(), pointCoords.data(), cellLevels.data(),
+            dof, namePtrs.data(), dataPtrs.data(), m_uiActiveComm);
+    }
+
+
+    template <unsigned int dim>
+    template <typename T>
+    bool DA<dim>::getElementNodalValues(const T *ghosted, unsigned int dof, const ot::TreeNode<C,dim> &element, double *values,
+                                        ElementValuesScratch &scratch)
+    {
+        const unsigned int npe = m_uiNpE;
+
+        // Ghosted node id at the coordinates of node, preferring the level of node, then coarser levels.
+        auto findNode = [this](const ot::TreeNode<C,dim> &node) -> long
+        {
+            auto coordLess = [](const ot::TreeNode<C,dim> &a, const ot::TreeNode<C,dim> &b) {
+                for (int d = 0; d < dim; d++)
+                    if (a.getX(d) != b.getX(d))
+                        return a.getX(d) < b.getX(d);
+                return false;
+            };
+            auto lo = std::lower_bound(m_uiNodesByCoords.begin(), m_uiNodesByCoords.end(), node,
+                [&](unsigned int id, const ot::TreeNode<C,dim> &key) { return coordLess(m_tnCoords[id], key); });
+            long found = -1;
+            for (auto it = lo; it != m_uiNodesByCoords.end() && !coordLess(node, m_tnCoords[*it]); ++it)
+            {
+                if (m_tnCoords[*it].getLevel() == node.getLevel())
+                    return *it;
+                if (m_tnCoords[*it].getLevel() < node.getLevel())
+                    found = *it;
+            }
+            return found;
+        };
+
+        std::vector<ot::TreeNode<C,dim>> &nodes = scratch.m_nodes;
+        std::vector<long> &ids = scratch.m_ids;
+        nodes.clear();
+        ot::Element<C,dim>(element).template appendNodes<ot::TreeNode<C,dim>>(m_uiElementOrder, nodes);
+
+        ids.resize(npe);
+        bool hasAllNodes = true;
+        for (unsigned int n = 0; n < npe; n++)
+        {
+            const long id = ids[n] = findNode(nodes[n]);
+            hasAllNodes &= (id >= 0);
+            for (unsigned int v = 0; v < dof; v++)
+                values[v * npe + n] = (id >= 0 ? ghosted[dof * id + v] : 0.0);
+        }
+        if (hasAllNodes)
+            return true;
+
+        // Hanging nodes: interpolate from the parent, as fem::matvec() does.
+        if (element.getLevel() == 0)
+            return false;
+        const ot::TreeNode<C,dim> parent = element.getParent();
+        nodes.clear();
+        ot::Element<C,dim>(parent).template appendNodes<ot::TreeNode<C,dim>>(m_uiElementOrder, nodes);
+
+        std::vector<double> &parentValues = scratch.m_parentValues;
+        std::vector<long> &parentIds = scratch.m_parentIds;
+        parentValues.resize(npe);
+        parentIds.resize(npe);
+        for (unsigned int n = 0; n < npe; n++)
+            parentIds[n] = findNode(nodes[n]);
+
+        for (unsigned int v = 0; v < dof; v++)
+        {
+            for (unsigned int n = 0; n < npe; n++)
+                parentValues[n] = (parentIds[n] >= 0 ? ghosted[dof * parentIds[n] + v] : 0.0);
+            m_refel.template IKD_Parent2Child<dim>(parentValues.data(), parentValues.data(), element.getMortonIndex());
+            for (unsigned int n = 0; n < npe; n++)
+                if (ids[n] < 0)
+                {
+                    if (parentIds[n] < 0)
+                        return false;
+                    values[v * npe + n] = parentValues[n];
+                }
+        }
+        return true;
+    }
+
+
+    template <unsigned int dim>
+    template <typename T>
+    DendroIntL DA<dim>::extractSlice(const T *local, unsigned int sliceDim, double sliceCoord,
+                                     std::vector<ot::TreeNode<C,dim-1>> &sliceTree, std::vector<T> &sliceValues,
+                                     bool isGhosted, unsigned int dof)
+    {
+        sliceTree.clear();
+        sliceValues.clear();
+        if (!m_uiIsActive)
+            return 0;
+
+        indexNodesByCoords();
+
+        const unsigned int order = m_uiElementOrder;
+        const unsigned int npe = m_uiNpE;
+        const unsigned int sliceNpe = npe / (order + 1);
+
+        const T *ghosted = local;
+        std::vector<T> ghostedCopy;
+        if (!isGhosted)
+        {
+            ghostedCopy.resize((size_t) dof * m_uiTotalNodalSz);
+            std::copy(local, local + (size_t) dof * m_uiLocalNodalSz, ghostedCopy.begin() + (size_t) dof * m_uiLocalNodeBegin);
+            readFromGhostBegin(ghostedCopy.data(), dof);
+            readFromGhostEnd(ghostedCopy.data(), dof);
+            ghosted = ghostedCopy.data();
+        }
+
+        // The slice in integer coordinates; a slice on the upper domain boundary cuts the last elements.
+        const double domainLen = (double) (1u << m_uiMaxDepth);
+        const double s = sliceCoord * domainLen;
+        auto isCut = [&](const ot::TreeNode<C,dim> &region) {
+            const double lo = region.getX(sliceDim);
+            const double hi = lo + (double) (1u << (m_uiMaxDepth - region.getLevel()));
+            return (lo <= s && s < hi) || (s == hi && hi == domainLen);
+        };
+
+        unsigned int selectDimSrc[dim-1];
+        unsigned int selectDimDst[dim-1];
+        for (unsigned int dIdx = 0; dIdx < dim-1; dIdx++)
+        {
+            selectDimSrc[dIdx] = (dIdx < sliceDim ? dIdx : dIdx+1);
+            selectDimDst[dIdx] = dIdx;
+        }
+
+        std::vector<double> eleValues((size_t) dof * npe);
+        std::vector<double> weights(order + 1);
+        ElementValuesScratch scratch;
+        DendroIntL numFailed = 0;
+
+        auto emitElement = [&](const ot::TreeNode<C,dim> &element)
+        {
+            ot::TreeNode<C,dim-1> sliceLeaf;
+            ot::permuteDims<C, dim, dim-1>(dim-1, element, selectDimSrc, sliceLeaf, selectDimDst);
+            sliceTree.push_back(sliceLeaf);
+
+            if (!getElementNodalValues(ghosted, dof, element, eleValues.data(), scratch))
+                numFailed++;
+
+            // Lagrange weights of the nodes along sliceDim, at the slice.
+            const double h = (double) (1u << (m_uiMaxDepth - element.getLevel()));
+            const double xi = (s - element.getX(sliceDim)) / h;
+            for (unsigned int i = 0; i <= order; i++)
+            {
+                weights[i] = 1.0;
+                for (unsigned int j = 0; j <= order; j++)
+                    if (j != i)
+                        weights[i] *= (xi * order - j) / ((double) i - j);
+            }
+
+            // Slice node m -> element nodes with index i along sliceDim.
+            unsigned int strideSlice = 1;
+            for (unsigned int d = 0; d < sliceDim; d++)
+                strideSlice *= (order + 1);
+
+            for (unsigned int m = 0; m < sliceNpe; m++)
+            {
+                const unsigned int lower = m % strideSlice, upper = m / strideSlice;
+                const unsigned int n0 = lower + upper * strideSlice * (order + 1);
+                for (unsigned int v = 0; v < dof; v++)
+                {
+                    double val = 0.0;
+                    for (unsigned int i = 0; i <= order; i++)
+                        val += weights[i] * eleValues[v * npe + n0 + i * strideSlice];
+                    sliceValues.push_back((T) val);
+                }
+            }
+        };
+
+        // Descend the SFC-sorted elements, visiting only subtrees cut by the slice.
+        std::function<void(const ot::TreeNode<C,dim> &, ot::RotI, size_t, size_t)> descend =
+            [&](const ot::TreeNode<C,dim> &region, ot::RotI pRot, size_t begin, size_t end)
+        {
+            if (begin == end || !isCut(region))
+                return;
+            if (m_tnElements[begin].getLevel() <= region.getLevel())
+            {
+                emitElement(m_tnElements[begin]);
+                return;
+            }
+
+            const ot::LevI cLev = region.getLevel() + 1;
+            const ot::ChildI * const rot_perm = SFC_Tables<dim>::rotPerm(pRot);
+            const ot::ChildI * const rot_inv = SFC_Tables<dim>::rotInv(pRot);
+            const ot::RotI * const orientLookup = SFC_Tables<dim>::orientLookup(pRot);
+
+            size_t childBegin = begin;
+            for (ot::ChildI child_sfc = 0; child_sfc < (1 << dim); child_sfc++)
+            {
+                const size_t childEnd = std::partition_point(m_tnElements.begin() + childBegin, m_tnElements.begin() + end,
+                    [&](const ot::TreeNode<C,dim> &ele) { return rot_inv[ele.getMortonIndex(cLev)] <= child_sfc; })
+                    - m_tnElements.begin();
+                const ot::ChildI child_m = rot_perm[child_sfc];
+                descend(region.getChildMorton(child_m), orientLookup[child_m], childBegin, childEnd);
+                childBegin = childEnd;
+            }
+        };
+        descend(ot::TreeNode<C,dim>(), 0, 0, m_tnElements.size());
 
+        return numFailed;
     }
 
 
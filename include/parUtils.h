@@ -335,6 +335,27 @@ namespace par {
     int Mpi_Alltoallv_Kway(T* sbuff_, int* s_cnt_, int* sdisp_,
                            T* rbuff_, int* r_cnt_, int* rdisp_, MPI_Comm c);
 
+  /**
+   * @brief Sparse counterpart of Mpi_Alltoall for a single count per peer.
+   *        Each rank names only the ranks it sends to, and learns who sends to it.
+   * @description Uses the nonblocking consensus (NBX) of Hoefler et al.:
+   *        synchronous sends of the counts, probing for incoming counts,
+   *        and a nonblocking barrier entered once all local sends are matched.
+   *        Cost depends on the number of neighbours rather than the size of comm.
+   * @param sendProc  Ranks to send to (need not be sorted; must not contain duplicates).
+   * @param sendCounts One value per rank in sendProc.
+   * @param numSend Length of sendProc and sendCounts.
+   * @param recvProc [out] Ranks that sent to us, sorted ascending.
+   * @param recvCounts [out] The values received, matched with recvProc.
+   * @param tag Tag reserved for this exchange. Consecutive exchanges on the same
+   *        communicator that are not separated by another collective should use distinct tags.
+   * @author Masado Ishii
+   */
+  template <typename T>
+    int Mpi_Alltoall_NBX(const int *sendProc, const T *sendCounts, int numSend,
+                         std::vector<int> &recvProc, std::vector<T> &recvCounts,
+                         int tag, MPI_Comm comm);
+
 
 
   /**
@@ -554,6 +575,70 @@ namespace par {
   template <typename T>
     void bitonicSort(std::vector<T> & in, MPI_Comm comm) ;
 
+  /**
+    @brief Merges consecutive sorted runs of a vector into one sorted vector,
+    pairwise with omp_par::merge().
+    @param arr The runs, stored contiguously. Replaced by the merged result.
+    @param runBegin Offsets of the runs in arr, followed by arr.size(). Runs may be empty.
+    @param comp Strict weak ordering used to sort the runs.
+    @author Masado Ishii
+    */
+  template <typename T, class Compare>
+    void mergeSortedRuns(std::vector<T> &arr, const std::vector<DendroIntL> &runBegin, Compare comp);
+
+  /**
+    @brief Selects kway-1 splitters that divide a distributed, locally sorted
+    vector into kway buckets of nearly equal global size.
+    @description Parallel selection as in HykSort (Sundar, Malhotra & Biros, ICS 2013):
+    evenly spaced samples are drawn from the global interval that brackets each
+    target rank, the global ranks of the samples are reduced, and the brackets
+    are narrowed until every splitter is within tolerance or cannot be improved
+    (e.g. a run of equal keys straddles the target).
+    @param arr Locally sorted input. The global size must be nonzero.
+    @param kway Number of buckets.
+    @param comm The communicator.
+    @param comp Strict weak ordering that arr is sorted by.
+    @return The same kway-1 nondecreasing splitters on every process.
+    Bucket i holds the elements x such that !comp(x, s[i]) and comp(x, s[i+1]).
+    @author Masado Ishii
+    */
+  template <typename T, class Compare>
+    std::vector<T> selectSplitters(const std::vector<T> &arr, int kway, MPI_Comm comm, Compare comp);
+
+  /**
+    @brief Distributed k-way sample sort (HykSort) for any trivially copyable type.
+    @description Sorts locally with omp_par::merge_sort(). Then, while more than one process remains,
+    selects kway-1 splitters, sends bucket i to a partner in the i-th of kway process groups
+    with Mpi_Alltoallv_Kway(), merges the received runs, and recurses within the group.
+    The data is exchanged as bytes, so T does not need an Mpi_datatype.
+    The output is globally sorted but only approximately balanced; call partitionW()
+    afterwards if an exact partition is required. Some processes may end up empty.
+    @param arr The local part of the input, replaced by the local part of the sorted output.
+    @param kway Number of groups to split into at each level (clamped to [2, npes]).
+    @param comm The communicator. It is not modified.
+    @param comp Strict weak ordering.
+    @note The bytes sent to a single process must fit in an int.
+    @author Masado Ishii
+    */
+  template <typename T, class Compare>
+    void HykSort(std::vector<T> &arr, unsigned int kway, MPI_Comm comm, Compare comp);
+
+  template <typename T>
+    void HykSort(std::vector<T> &arr, unsigned int kway, MPI_Comm comm);
+
+  /**
+    @brief Distributed sample sort for any trivially copyable type.
+    @description One level of HykSort() with npes buckets: npes-1 splitters are selected,
+    and the buckets are exchanged in a single Mpi_Alltoallv_Kway(). Each process receives about N/npes elements.
+    @see HykSort
+    @author Masado Ishii
+    */
+  template <typename T, class Compare>
+    void sampleSort(std::vector<T> &arr, MPI_Comm comm, Compare comp);
+
+  template <typename T>
+    void sampleSort(std::vector<T> &arr, MPI_Comm comm);
+
 }//end namespace
 
 #ifdef USE_OLD_SORT
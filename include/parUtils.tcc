@@ -16,6 +16,7 @@
 #include "dendro.h"
 #include "ompUtils.h"
 #include <chrono>
+#include <functional>
 #include <assert.h>
 
 
@@ -122,6 +123,67 @@ namespace par {
     PROF_PAR_ALL2ALL_END
   }
 
+  template<typename T>
+  int Mpi_Alltoall_NBX(const int *sendProc, const T *sendCounts, int numSend,
+                       std::vector<int> &recvProc, std::vector<T> &recvCounts,
+                       int tag, MPI_Comm comm) {
+    std::vector<MPI_Request> sendRequests(numSend);
+    for (int sIdx = 0; sIdx < numSend; sIdx++)
+      par::Mpi_Issend<T>(const_cast<T *>(sendCounts + sIdx), 1, sendProc[sIdx], tag, comm, &sendRequests[sIdx]);
+
+    std::vector<std::pair<int, T>> received;
+
+    MPI_Request barrierRequest;
+    bool barrierActive = false;
+    bool done = false;
+    while (!done)
+    {
+      // Drain any counts that have arrived.
+      int flag;
+      MPI_Status status;
+      MPI_Iprobe(MPI_ANY_SOURCE, tag, comm, &flag, &status);
+      if (flag)
+      {
+        T count;
+        par::Mpi_Recv<T>(&count, 1, status.MPI_SOURCE, tag, comm, &status);
+        received.emplace_back(status.MPI_SOURCE, count);
+      }
+
+      if (barrierActive)
+      {
+        // Every rank has had all its sends matched.
+        int barrierDone;
+        MPI_Test(&barrierRequest, &barrierDone, MPI_STATUS_IGNORE);
+        done = barrierDone;
+      }
+      else
+      {
+        // Our sends have all been matched, so we can announce it.
+        int sendsDone;
+        MPI_Testall(numSend, sendRequests.data(), &sendsDone, MPI_STATUSES_IGNORE);
+        if (sendsDone)
+        {
+          MPI_Ibarrier(comm, &barrierRequest);
+          barrierActive = true;
+        }
+      }
+    }
+
+    // Callers expect rank order, as with the dense Alltoall.
+    std::sort(received.begin(), received.end(),
+        [](const std::pair<int, T> &a, const std::pair<int, T> &b) { return a.first < b.first; });
+
+    recvProc.resize(received.size());
+    recvCounts.resize(received.size());
+    for (size_t rIdx = 0; rIdx < received.size(); rIdx++)
+    {
+      recvProc[rIdx] = received[rIdx].first;
+      recvCounts[rIdx] = received[rIdx].second;
+    }
+
+    return 1;
+  }
+
   template<typename T>
   inline int Mpi_Alltoallv
       (T *sendbuf, int *sendcnts, int *sdispls,
@@ -1862,5 +1924,253 @@ namespace par {
     scratch_list.clear();
   }//end function
 
+  template <typename T, class Compare>
+  void mergeSortedRuns(std::vector<T> &arr, const std::vector<DendroIntL> &runBegin, Compare comp)
+  {
+    const int p = omp_get_max_threads();
+
+    std::vector<DendroIntL> split(runBegin);
+    std::vector<T> buffer(arr.size());
+    T *src = arr.data();
+    T *dst = buffer.data();
+
+    // Merge two runs at a time, alternating between arr and buffer.
+    while (split.size() > 2)
+    {
+      const size_t numRuns = split.size() - 1;
+      std::vector<DendroIntL> nextSplit;
+      for (size_t r = 0; r < numRuns; r += 2)
+      {
+        nextSplit.push_back(split[r]);
+        const DendroIntL b = split[r];
+        const DendroIntL m = split[r+1];
+        const DendroIntL e = (r + 1 < numRuns ? split[r+2] : m);
+
+        // omp_par::merge() does not accept empty lists.
+        if (b == m || m == e)
+          std::copy(src + b, src + e, dst + b);
+        else
+          omp_par::merge(src + b, src + m, src + m, src + e, dst + b, p, comp);
+      }
+      nextSplit.push_back(split.back());
+      split.swap(nextSplit);
+      std::swap(src, dst);
+    }
+
+    if (src != arr.data())
+      arr.swap(buffer);
+  }
+
+
+  template <typename T, class Compare>
+  std::vector<T> selectSplitters(const std::vector<T> &arr, int kway, MPI_Comm comm, Compare comp)
+  {
+    const int numSplitters = kway - 1;
+    const DendroIntL samplesPerSplitter = 16;
+    const int maxIterations = 16;
+
+    DendroIntL locN = arr.size(), glbN = 0;
+    par::Mpi_Allreduce<DendroIntL>(&locN, &glbN, 1, MPI_SUM, comm);
+
+    // Target global rank of each splitter, and how far it may be off.
+    std::vector<DendroIntL> target(numSplitters);
+    for (int j = 0; j < numSplitters; j++)
+      target[j] = (glbN * (j+1)) / kway;
+    const DendroIntL tolerance = std::max<DendroIntL>(1, glbN / (kway * 64));
+
+    // Local interval [lo, hi) of arr that brackets each target.
+    std::vector<DendroIntL> lo(numSplitters, 0), hi(numSplitters, locN);
+    std::vector<T> splitters(numSplitters);
+    std::vector<DendroIntL> error(numSplitters, glbN + 1);
+    std::vector<char> done(numSplitters, false);
+
+    std::vector<DendroIntL> locCnt(numSplitters), glbCnt(numSplitters), scanCnt(numSplitters);
+    std::vector<T> locSamples, glbSamples;
+    std::vector<DendroIntL> locRank, glbRank;
+
+    int npes;
+    MPI_Comm_size(comm, &npes);
+    std::vector<int> sampleBytes(npes), sampleDsp(npes);
+
+    for (int iter = 0; iter < maxIterations; iter++)
+    {
+      // Position of the local part of each bracket in the global bracket.
+      for (int j = 0; j < numSplitters; j++)
+        locCnt[j] = (done[j] ? 0 : hi[j] - lo[j]);
+      par::Mpi_Allreduce<DendroIntL>(locCnt.data(), glbCnt.data(), numSplitters, MPI_SUM, comm);
+      par::Mpi_Scan<DendroIntL>(locCnt.data(), scanCnt.data(), numSplitters, MPI_SUM, comm);
+
+      // Evenly spaced samples of each global bracket; each process draws those it owns.
+      locSamples.clear();
+      bool anyOpen = false;
+      for (int j = 0; j < numSplitters; j++)
+      {
+        if (done[j] || glbCnt[j] == 0)
+        {
+          done[j] = true;
+          continue;
+        }
+        anyOpen = true;
+
+        const DendroIntL numSamples = std::min(samplesPerSplitter, glbCnt[j]);
+        const DendroIntL scanBegin = scanCnt[j] - locCnt[j];
+        for (DendroIntL s = 0; s < numSamples; s++)
+        {
+          const DendroIntL globalPos = ((2*s + 1) * glbCnt[j]) / (2*numSamples);
+          if (scanBegin <= globalPos && globalPos < scanCnt[j])
+            locSamples.push_back(arr[lo[j] + (globalPos - scanBegin)]);
+        }
+      }
+      if (!anyOpen)
+        break;
+
+      // Gather all samples, as bytes.
+      int myBytes = locSamples.size() * sizeof(T);
+      par::Mpi_Allgather<int>(&myBytes, sampleBytes.data(), 1, comm);
+      sampleDsp[0] = 0;
+      omp_par::scan(sampleBytes.data(), sampleDsp.data(), npes);
+      glbSamples.resize((sampleDsp[npes-1] + sampleBytes[npes-1]) / sizeof(T));
+      par::Mpi_Allgatherv<char>(reinterpret_cast<char *>(locSamples.data()), myBytes,
+                                reinterpret_cast<char *>(glbSamples.data()),
+                                sampleBytes.data(), sampleDsp.data(), comm);
+      std::sort(glbSamples.begin(), glbSamples.end(), comp);
+
+      // Global rank of each sample: the number of elements that precede it.
+      const DendroIntL numSamples = glbSamples.size();
+      locRank.resize(numSamples);
+      glbRank.resize(numSamples);
+      #pragma omp parallel for
+      for (DendroIntL s = 0; s < numSamples; s++)
+        locRank[s] = std::lower_bound(arr.begin(), arr.end(), glbSamples[s], comp) - arr.begin();
+      par::Mpi_Allreduce<DendroIntL>(locRank.data(), glbRank.data(), numSamples, MPI_SUM, comm);
+
+      // Keep the best sample so far, and narrow the bracket to the samples around the target.
+      for (int j = 0; j < numSplitters; j++)
+      {
+        if (done[j])
+          continue;
+
+        const DendroIntL above = std::lower_bound(glbRank.begin(), glbRank.end(), target[j]) - glbRank.begin();
+        for (DendroIntL s = (above > 0 ? above - 1 : 0); s <= above && s < numSamples; s++)
+        {
+          const DendroIntL err = (glbRank[s] > target[j] ? glbRank[s] - target[j] : target[j] - glbRank[s]);
+          if (err < error[j])
+          {
+            error[j] = err;
+            splitters[j] = glbSamples[s];
+          }
+        }
+
+        if (error[j] <= tolerance)
+        {
+          done[j] = true;
+          continue;
+        }
+
+        if (above > 0)
+          lo[j] = std::max<DendroIntL>(lo[j],
+              std::upper_bound(arr.begin(), arr.end(), glbSamples[above-1], comp) - arr.begin());
+        if (above < numSamples)
+          hi[j] = std::min<DendroIntL>(hi[j],
+              std::lower_bound(arr.begin(), arr.end(), glbSamples[above], comp) - arr.begin());
+        hi[j] = std::max(lo[j], hi[j]);
+      }
+    }
+
+    return splitters;
+  }
+
+
+  template <typename T, class Compare>
+  void HykSort(std::vector<T> &arr, unsigned int kway, MPI_Comm comm, Compare comp)
+  {
+    omp_par::merge_sort(arr.data(), arr.data() + arr.size(), comp);
+
+    MPI_Comm c = comm;
+    int npes, rank;
+    MPI_Comm_size(c, &npes);
+
+    while (npes > 1)
+    {
+      MPI_Comm_rank(c, &rank);
+
+      DendroIntL locN = arr.size(), glbN = 0;
+      par::Mpi_Allreduce<DendroIntL>(&locN, &glbN, 1, MPI_SUM, c);
+      if (glbN == 0)
+        break;
+
+      const int k = std::max(2, std::min<int>(kway, npes));
+      const std::vector<T> splitters = selectSplitters(arr, k, c, comp);
+
+      // Process group i is [groupBegin[i], groupBegin[i+1]).
+      std::vector<int> groupBegin(k+1);
+      for (int i = 0; i <= k; i++)
+        groupBegin[i] = (npes * i) / k;
+      const int myGroup = std::upper_bound(groupBegin.begin(), groupBegin.end(), rank) - groupBegin.begin() - 1;
+
+      // Bucket i goes to one process in group i. Senders are spread round-robin over the group.
+      std::vector<int> sendCnt(npes, 0), sendDsp(npes, 0);
+      std::vector<int> recvCnt(npes, 0), recvDsp(npes, 0);
+      typename std::vector<T>::iterator bucketBegin = arr.begin();
+      for (int i = 0; i < k; i++)
+      {
+        typename std::vector<T>::iterator bucketEnd =
+            (i < k-1 ? std::lower_bound(bucketBegin, arr.end(), splitters[i], comp) : arr.end());
+        const int groupSize = groupBegin[i+1] - groupBegin[i];
+        sendCnt[groupBegin[i] + rank % groupSize] = (bucketEnd - bucketBegin) * sizeof(T);
+        bucketBegin = bucketEnd;
+      }
+
+      par::Mpi_Alltoall<int>(sendCnt.data(), recvCnt.data(), 1, c);
+      omp_par::scan(sendCnt.data(), sendDsp.data(), npes);
+      omp_par::scan(recvCnt.data(), recvDsp.data(), npes);
+
+      std::vector<T> recvBuf((recvDsp[npes-1] + recvCnt[npes-1]) / sizeof(T));
+      par::Mpi_Alltoallv_Kway<char>(reinterpret_cast<char *>(arr.data()), sendCnt.data(), sendDsp.data(),
+                                    reinterpret_cast<char *>(recvBuf.data()), recvCnt.data(), recvDsp.data(), c);
+
+      // The data from each source is sorted.
+      std::vector<DendroIntL> runBegin(npes + 1);
+      for (int r = 0; r < npes; r++)
+        runBegin[r] = recvDsp[r] / sizeof(T);
+      runBegin[npes] = recvBuf.size();
+      mergeSortedRuns(recvBuf, runBegin, comp);
+      arr.swap(recvBuf);
+
+      // Recurse within the group.
+      MPI_Comm groupComm;
+      MPI_Comm_split(c, myGroup, rank, &groupComm);
+      if (c != comm)
+        MPI_Comm_free(&c);
+      c = groupComm;
+      MPI_Comm_size(c, &npes);
+    }
+
+    if (c != comm)
+      MPI_Comm_free(&c);
+  }
+
+  template <typename T>
+  void HykSort(std::vector<T> &arr, unsigned int kway, MPI_Comm comm)
+  {
+    HykSort(arr, kway, comm, std::less<T>());
+  }
+
+
+  template <typename T, class Compare>
+  void sampleSort(std::vector<T> &arr, MPI_Comm comm, Compare comp)
+  {
+    int npes;
+    MPI_Comm_size(comm, &npes);
+    HykSort(arr, npes, comm, comp);
+  }
+
+  template <typename T>
+  void sampleSort(std::vector<T> &arr, MPI_Comm comm)
+  {
+    sampleSort(arr, comm, std::less<T>());
+  }
+
+
 }//end namespace
 
@@ -0,0 +1,160 @@
+/**
+ * @file:profRegistry.h
+ * @brief: Registry of nested, named timing regions with byte and flop counters.
+ *
+ * @description Regions are opened and closed with the DENDRO_PROF_* macros, which
+ *              compile to nothing unless DENDRO_KT_PROFILE is defined (cmake option
+ *              DENDRO_KT_PROFILE). A region opened inside another one is recorded as
+ *              its child, so the same name can be timed separately under different
+ *              callers, e.g. "distTreeBalancing/distTreeConstruction/distTreePartition".
+ *
+ *              Every thread accumulates into its own tree of regions without locking;
+ *              the trees are merged by path when reported. With HAVE_PAPI, the
+ *              floating point operations counted by PAPI are also accumulated.
+ *
+ *              Between traceBegin() and traceEnd(), every region is also recorded as a
+ *              timeline event, which traceEnd() writes to a compact binary file per proc.
+ *              writeChromeTrace() (or the traceMerge tool) merges the files of all procs
+ *              into one Chrome trace (chrome://tracing, Perfetto), with one process per
+ *              proc and one track per thread, to see load imbalance and waits over time.
+ *
+ *              The region names must be string literals (they are kept by pointer).
+ */
+
+#ifndef DENDRO_KT_PROF_REGISTRY_H
+#define DENDRO_KT_PROF_REGISTRY_H
+
+#include "mpi.h"
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace prof
+{
+    /**@brief: accumulated statistics of one region path on one process. */
+    struct RegionStats
+    {
+        std::string path;         // Names from the outermost region, separated by '/'.
+        double seconds;           // Inclusive wall time; the maximum over threads.
+        long long calls;          // Summed over threads.
+        long long bytes;          // Bytes moved, as reported with addBytes(); summed over threads.
+        long long flops;          // Flops, as reported with addFlops(); summed over threads.
+        long long papiFlops;      // Flops counted by PAPI (0 without HAVE_PAPI); summed over threads.
+    };
+
+    /**@brief: header of a trace file; followed by numNames (uint32 length, chars) names, then numEvents TraceRecord. */
+    struct TraceFileHeader
+    {
+        char m_magic[8];          // "DKTTRACE"
+        uint32_t m_version;
+        int32_t m_rank;
+        int32_t m_npes;
+        uint32_t m_numNames;
+        uint64_t m_numEvents;
+        uint64_t m_numDropped;    // Events not recorded because the buffer of a thread was full.
+    };
+
+    /**@brief: one closed region, times in nanoseconds since traceBegin(). */
+    struct TraceRecord
+    {
+        uint32_t m_name;          // Index into the names of the file.
+        uint32_t m_thread;
+        int64_t m_arg;            // e.g. the level of a matvec pass; -1 if none.
+        uint64_t m_begin;
+        uint64_t m_duration;
+    };
+
+    /**@brief: opens a child region of the current region of this thread; arg is only traced. */
+    void beginRegion(const char *name, long arg = -1);
+
+    /**@brief: closes the current region of this thread. */
+    void endRegion();
+
+    /**
+     * @brief: adds time the caller measured itself, e.g. summed over the nodes of one level of a
+     *         traversal, to a child region of the current region of this thread.
+     *         It is traced as a single event of that length, ending now (and not before traceBegin()).
+     */
+    void addRegion(const char *name, double seconds, long long calls, long arg = -1);
+
+    /**@brief: adds to the byte counter of the current region of this thread. */
+    void addBytes(long long bytes);
+
+    /**@brief: adds to the flop counter of the current region of this thread. */
+    void addFlops(long long flops);
+
+    /**@brief: zeros all statistics. Call outside of regions and parallel sections. */
+    void reset();
+
+    /**@brief: statistics of all region paths of this process, merged over threads, in path order. */
+    std::vector<RegionStats> getLocalStats();
+
+    /**@brief: local statistics of one path, e.g. "matvec/elemental"; false if it was never entered. */
+    bool getLocalStats(const char *path, RegionStats &stats);
+
+    /**
+     * @brief: writes a tab-separated table of all region paths, over the union of the paths
+     *         of all procs: calls (mean), seconds (min, mean, max), bytes and flops (mean).
+     * @note: collective on comm; only rank 0 writes.
+     */
+    void report(std::ostream &fout, MPI_Comm comm);
+
+    /**
+     * @brief: starts recording regions as events, to be written to <prefix>.<rank>.trace.
+     * @param [in] maxEventsPerThread: events past this many on a thread are dropped (and counted).
+     * @note: collective on comm, which synchronizes the time origin of the procs.
+     */
+    void traceBegin(const char *prefix, MPI_Comm comm, size_t maxEventsPerThread = (1u << 20));
+
+    /**
+     * @brief: stops recording and writes the events closed since traceBegin(). Call outside of parallel sections.
+     * @return 0 on success.
+     */
+    int traceEnd();
+
+    /**
+     * @brief: merges the trace files <prefix>.<rank>.trace of all procs into a Chrome trace (JSON).
+     * @return 0 on success.
+     */
+    int writeChromeTrace(const char *prefix, const char *jsonName);
+
+    /**@brief: opens a region for the lifetime of the object. */
+    class ScopedRegion
+    {
+      public:
+        explicit ScopedRegion(const char *name, long arg = -1) { beginRegion(name, arg); }
+        ~ScopedRegion() { endRegion(); }
+
+        ScopedRegion(const ScopedRegion &) = delete;
+        ScopedRegion &operator=(const ScopedRegion &) = delete;
+    };
+
+}// end of namespace prof
+
+
+#define DENDRO_PROF_CONCAT_(a, b) a##b
+#define DENDRO_PROF_CONCAT(a, b) DENDRO_PROF_CONCAT_(a, b)
+
+#ifdef DENDRO_KT_PROFILE
+  #define DENDRO_PROF_SCOPE(name) prof::ScopedRegion DENDRO_PROF_CONCAT(profRegion_, __LINE__)(name)
+  #define DENDRO_PROF_SCOPE_ARG(name, arg) prof::ScopedRegion DENDRO_PROF_CONCAT(profRegion_, __LINE__)(name, arg)
+  #define DENDRO_PROF_BEGIN(name) prof::beginRegion(name)
+  #define DENDRO_PROF_BEGIN_ARG(name, arg) prof::beginRegion(name, arg)
+  #define DENDRO_PROF_END() prof::endRegion()
+  #define DENDRO_PROF_ADD(name, seconds, calls, arg) prof::addRegion(name, seconds, calls, arg)
+  #define DENDRO_PROF_BYTES(n) prof::addBytes(n)
+  #define DENDRO_PROF_FLOPS(n) prof::addFlops(n)
+#else
+  #define DENDRO_PROF_SCOPE(name) ((void) 0)
+  #define DENDRO_PROF_SCOPE_ARG(name, arg) ((void) 0)
+  #define DENDRO_PROF_BEGIN(name) ((void) 0)
+  #define DENDRO_PROF_BEGIN_ARG(name, arg) ((void) 0)
+  #define DENDRO_PROF_END() ((void) 0)
+  #define DENDRO_PROF_ADD(name, seconds, calls, arg) ((void) 0)
+  #define DENDRO_PROF_BYTES(n) ((void) 0)
+  #define DENDRO_PROF_FLOPS(n) ((void) 0)
+#endif
+
+#endif //DENDRO_KT_PROF_REGISTRY_H
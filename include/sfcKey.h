@@ -0,0 +1,97 @@
+/**
+ * @file:sfcKey.h
+ * @brief: Precomputed space-filling-curve keys for TreeNodes.
+ *
+ * @description A key packs the SFC child ranks of all ancestors of a TreeNode,
+ *              most significant level first and zero-padded to m_uiMaxDepth,
+ *              followed by the level. Comparing two keys as unsigned integers
+ *              gives the order of locTreeSort() / TreeNode::operator<(),
+ *              including ancestors before descendants. The curve is whichever
+ *              one the rotation tables were initialized with (_InitializeHcurve()).
+ *
+ *              Keys need dim*m_uiMaxDepth + 5 bits: 64-bit keys hold e.g.
+ *              m_uiMaxDepth <= 14 in 4D; 128-bit keys hold m_uiMaxDepth <= 30 in 4D.
+ *              Only cells inside the unit domain have keys.
+ */
+
+#ifndef DENDRO_KT_SFC_KEY_H
+#define DENDRO_KT_SFC_KEY_H
+
+#include "treeNode.h"
+#include "tsort.h"    // LevI, RotI, ChildI, RankI
+#include "hcurvedata.h"
+
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace ot
+{
+
+__extension__ typedef unsigned __int128 SFC_UInt128;
+
+template <typename T, unsigned int D, typename UInt = SFC_UInt128>
+class SFC_Key
+{
+  public:
+    using UIntType = UInt;
+
+    static constexpr unsigned int levelBits = 5;   // Enough for MAX_LEVEL.
+
+    /** @returns true iff keys of this width can represent every level up to m_uiMaxDepth. */
+    static bool fits() { return D*m_uiMaxDepth + levelBits <= 8*sizeof(UInt); }
+
+    SFC_Key() : m_key(0) {}
+
+    /** @pre tn is inside the unit domain and fits() is true. */
+    explicit SFC_Key(const TreeNode<T,D> &tn);
+
+    /** @brief Reconstructs the TreeNode (anchor and level) the key was made from. */
+    TreeNode<T,D> toTreeNode() const;
+
+    LevI getLevel() const { return (LevI) (m_key & ((UInt(1) << levelBits) - 1)); }
+
+    UInt getRaw() const { return m_key; }
+
+    /** @brief Strict ancestor test, like TreeNode::isAncestor(). */
+    bool isAncestor(const SFC_Key &other) const
+    {
+      return getLevel() < other.getLevel() &&
+          (getLevel() == 0 || ((m_key ^ other.m_key) >> (levelBits + D*(m_uiMaxDepth - getLevel()))) == 0);
+    }
+
+    bool operator==(const SFC_Key &other) const { return m_key == other.m_key; }
+    bool operator!=(const SFC_Key &other) const { return m_key != other.m_key; }
+    bool operator< (const SFC_Key &other) const { return m_key <  other.m_key; }
+    bool operator<=(const SFC_Key &other) const { return m_key <= other.m_key; }
+    bool operator> (const SFC_Key &other) const { return m_key >  other.m_key; }
+    bool operator>=(const SFC_Key &other) const { return m_key >= other.m_key; }
+
+    /** @brief Computes the keys of a list of TreeNodes, so that they can be sorted and searched on keys alone. */
+    static void makeKeys(const TreeNode<T,D> *tnodes, RankI numNodes, std::vector<SFC_Key> &outKeys);
+
+  private:
+    UInt m_key;
+};
+
+template <typename T, unsigned int D>
+using SFC_Key64 = SFC_Key<T, D, uint64_t>;
+
+template <typename T, unsigned int D>
+using SFC_Key128 = SFC_Key<T, D, SFC_UInt128>;
+
+}  // namespace ot
+
+
+namespace std
+{
+  template <typename T, unsigned int D, typename UInt>
+  struct hash<ot::SFC_Key<T,D,UInt>>
+  {
+    size_t operator()(const ot::SFC_Key<T,D,UInt> &key) const;
+  };
+}
+
+#include "sfcKey.tcc"
+
+#endif // DENDRO_KT_SFC_KEY_H
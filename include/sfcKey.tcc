@@ -0,0 +1,102 @@
+/**
+ * @file:sfcKey.tcc
+ * @brief: Precomputed space-filling-curve keys for TreeNodes.
+ */
+
+namespace ot
+{
+
+template <typename T, unsigned int D, typename UInt>
+constexpr unsigned int SFC_Key<T,D,UInt>::levelBits;
+
+
+//
+// SFC_Key()
+//
+template <typename T, unsigned int D, typename UInt>
+SFC_Key<T,D,UInt>::SFC_Key(const TreeNode<T,D> &tn)
+{
+  constexpr char numChildren = TreeNode<T,D>::numChildren;
+
+  const LevI lev = tn.getLevel();
+  UInt index = 0;
+
+  // Level 1 is ordered by the 0th rotation, as in locTreeSort().
+  RotI pRot = 0;
+  for (LevI l = 1; l <= lev; l++)
+  {
+    const ChildI child_m = tn.getMortonIndex(l);
+    const ChildI child_sfc = SFC_Tables<D>::rotInv(pRot)[child_m];
+    index = (index << D) | UInt(child_sfc);
+    pRot = SFC_Tables<D>::orientLookup(pRot)[child_m];
+  }
+  index <<= D*(m_uiMaxDepth - lev);
+
+  m_key = (index << levelBits) | UInt(lev);
+}
+
+
+//
+// SFC_Key::toTreeNode()
+//
+template <typename T, unsigned int D, typename UInt>
+TreeNode<T,D> SFC_Key<T,D,UInt>::toTreeNode() const
+{
+  constexpr char numChildren = TreeNode<T,D>::numChildren;
+
+  const LevI lev = getLevel();
+  const UInt index = m_key >> levelBits;
+
+  std::array<T,D> coords;
+  coords.fill(0);
+
+  RotI pRot = 0;
+  for (LevI l = 1; l <= lev; l++)
+  {
+    const ChildI child_sfc = (ChildI) ((index >> (D*(m_uiMaxDepth - l))) & UInt(numChildren - 1));
+    const ChildI child_m = SFC_Tables<D>::rotPerm(pRot)[child_sfc];
+    #pragma unroll(D)
+    for (int d = 0; d < D; d++)
+      coords[d] |= T((child_m >> d) & 1u) << (m_uiMaxDepth - l);
+    pRot = SFC_Tables<D>::orientLookup(pRot)[child_m];
+  }
+
+  return TreeNode<T,D>(coords, lev);
+}
+
+
+//
+// SFC_Key::makeKeys()
+//
+template <typename T, unsigned int D, typename UInt>
+void SFC_Key<T,D,UInt>::makeKeys(const TreeNode<T,D> *tnodes, RankI numNodes, std::vector<SFC_Key> &outKeys)
+{
+  outKeys.resize(numNodes);
+  #pragma omp parallel for schedule(static)
+  for (RankI ii = 0; ii < numNodes; ii++)
+    outKeys[ii] = SFC_Key(tnodes[ii]);
+}
+
+}  // namespace ot
+
+
+namespace std
+{
+  template <typename T, unsigned int D, typename UInt>
+  size_t hash<ot::SFC_Key<T,D,UInt>>::operator()(const ot::SFC_Key<T,D,UInt> &key) const
+  {
+    // Fold the 64-bit words, then mix (splitmix64 finalizer).
+    UInt raw = key.getRaw();
+    uint64_t h = 0;
+    for (unsigned int w = 0; w < (sizeof(UInt) + 7) / 8; w++)
+    {
+      h ^= (uint64_t) raw + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+      if (sizeof(UInt) > 8)
+        raw = (raw >> 32) >> 32;
+    }
+    h ^= h >> 30;  h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;  h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return (size_t) h;
+  }
+}
@@ -134,6 +134,10 @@ namespace ot {
       /**@brief Returns the greatest depth at which the other node shares an ancestor.*/
       unsigned int getCommonAncestorDepth(const TreeNode &other);
 
+      /**@brief Returns the coarsest level whose child number differs between the two anchors
+       *        (0 for the domain-boundary bit), or m_uiMaxDepth+1 if the anchors are equal. Constant time.*/
+      unsigned int getFirstDiffLevel(const TreeNode &other) const;
+
       /**@brief set the octant flag*/
       int setFlag(unsigned int w);
 
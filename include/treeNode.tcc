@@ -1,6 +1,10 @@
 #include <array>
 #include <iomanip>
 #include "mathUtils.h"
+#include "binUtils.h"
+#ifdef HILBERT_ORDERING
+#include "hcurvedata.h"
+#endif
 #if __DEBUG_TN__
 #include <assert.h>
 #endif // __DEBUG_TN__
@@ -145,34 +149,27 @@ inline bool TreeNode<T,dim>::operator!=(TreeNode<T,dim> const &other) const {
 template <typename T, unsigned int dim>
 inline bool TreeNode<T,dim>::operator<(TreeNode<T,dim> const &other) const {
 
-  // -- original Morton
-  
-  // Use the coordinate with the highest level difference (closest to root).
-  T maxDiffCoord = 0;
-  for (int d = 0; d < dim; d++)
-  {
-    T diffCoord = m_uiCoords[d] ^ other.m_uiCoords[d];  // Will have 0's where equal.
-    maxDiffCoord = (diffCoord > maxDiffCoord ? diffCoord : maxDiffCoord);
-  }
-
-  // Find the index of the highest level of difference.
-  T levelDiff = 0;
-  while (levelDiff < m_uiLevel && levelDiff < other.m_uiLevel
-      && !(maxDiffCoord & (1u << (m_uiMaxDepth - levelDiff))))
-  {
-    levelDiff++;
-  }
+  // In case of descendantship, ancestor is strictly less than descendant.
+  const unsigned int levelDiff = getFirstDiffLevel(other);
+  if (levelDiff > getLevel() || levelDiff > other.getLevel())
+    return getLevel() < other.getLevel();
 
   // Use that level to compare child numbers.
-  // In case of descendantship, ancestor is strictly less than descendant.
   unsigned int myIndex = getMortonIndex(levelDiff);
   unsigned int otherIndex = other.getMortonIndex(levelDiff);
-  if (myIndex == otherIndex)
-    return m_uiLevel < other.m_uiLevel;
-  else
-    return myIndex < otherIndex;
 
-  // -- original Morton
+#ifdef HILBERT_ORDERING
+  // Orientation of the common ancestor, as in locTreeSort(): levels 0 and 1 use rotation 0.
+  constexpr unsigned int numChildren = 1u << dim;
+  int pRot = 0;
+  for (unsigned int l = 1; l < levelDiff; l++)
+    pRot = SFC_Tables<dim>::orientLookup(pRot)[getMortonIndex(l)];
+  const char *rot_inv = SFC_Tables<dim>::rotInv(pRot);   // child_sfc == rot_inv[child_morton];
+  myIndex = rot_inv[myIndex];
+  otherIndex = rot_inv[otherIndex];
+#endif
+
+  return myIndex < otherIndex;
 }
 
 //
@@ -280,16 +277,19 @@ inline void TreeNode<T,dim>::setMortonIndex(unsigned char child)
 template <typename T, unsigned int dim>
 inline unsigned int TreeNode<T,dim>::getCommonAncestorDepth(const TreeNode &other)
 {
-  unsigned int depth_rt = m_uiMaxDepth;
+  const unsigned int diffLevel = getFirstDiffLevel(other);
+  return (diffLevel > m_uiMaxDepth ? m_uiMaxDepth : diffLevel - 1);
+}
+
+template <typename T, unsigned int dim>
+inline unsigned int TreeNode<T,dim>::getFirstDiffLevel(const TreeNode &other) const
+{
+  // The highest '1' over all coordinates of the XOR marks the coarsest differing level.
+  T diff = 0;
   #pragma unroll(dim)
   for (int d = 0; d < dim; d++)
-  {
-    unsigned int diff = other.m_uiCoords[d] ^ m_uiCoords[d];
-    // Using log2 gives the index of the highest '1'. We want one above that.
-    unsigned int depth = m_uiMaxDepth - log2((diff << 1) | 1u);
-    depth_rt = (depth < depth_rt ? depth : depth_rt);  // Minimum of depths.
-  }
-  return depth_rt;
+    diff |= other.m_uiCoords[d] ^ m_uiCoords[d];
+  return (diff ? m_uiMaxDepth - binOp::highestOnePos(diff) : m_uiMaxDepth + 1);
 }
 
 template <typename T, unsigned int dim>
@@ -7,10 +7,20 @@
  * @description The compressed format views the linearized tree as a sequence
  *              of uniform-level segments. What is stored is a list of pairs:
  *              1. Level in the segment; 2. Inclusive prefix sum of segment lengths.
+ *
+ *              Because the tree is complete, consecutive leaves in a segment
+ *              are consecutive cells of the SFC at that level. A point is
+ *              located by binary search on the sampled segment starts, then by
+ *              stepping over segments in SFC-digit arithmetic from the sample.
  */
 
+#ifndef DENDRO_KT_TSEARCH_CMPX_H
+#define DENDRO_KT_TSEARCH_CMPX_H
+
 #include "treeNode.h"
 #include "tsort.h"    // RankI
+#include <mpi.h>
+#include <vector>
 
 namespace ot
 {
@@ -33,6 +43,7 @@ struct CompressedTree
 {
   std::vector<LevelSegment> segments;
   std::vector<SegmentSample<T,D>> samples;
+  RankI startRank = 0;   // Rank of the first leaf, i.e. where segment 0 begins.
 };
 
 template <typename T, unsigned int D>
@@ -47,7 +58,39 @@ struct SFC_Search
       const RankI startRank,
       CompressedTree<T,D> &outTree);
 
+  /** @brief Returned in place of a leaf rank for points outside the compressed range. */
+  static constexpr RankI notFound = static_cast<RankI>(-1);
+
+  /**
+   * @brief For each point, finds the (global) rank of the leaf containing it.
+   * @param cTree Output of compressTree(), with at least one sample.
+   * @param points Located by their coordinates; the level is ignored.
+   * @param outLeafRanks Resized to numPoints. Holds notFound for points
+   *        outside the leaves represented by cTree (or outside the domain).
+   */
+  static void locateLeaves(
+      const CompressedTree<T,D> &cTree,
+      const TreeNode<T,D> *points, RankI numPoints,
+      std::vector<RankI> &outLeafRanks);
 
+  /**
+   * @brief For each point, finds the rank of the process whose partition of the
+   *        distributed tree contains it. Collective on comm.
+   * @param localTree Compressed local partition (may be empty on some procs).
+   * @param outOwners Resized to numPoints. Holds -1 for points outside the domain.
+   * @note The owner can then locate the leaf with locateLeaves().
+   */
+  static void dist_locateOwners(
+      const CompressedTree<T,D> &localTree,
+      const TreeNode<T,D> *points, RankI numPoints,
+      std::vector<int> &outOwners,
+      MPI_Comm comm);
+
+  /**
+   * @brief Writes the SFC-ordered child ranks of the ancestors of tn at levels 1..lev
+   *        to digits[1..lev]. Returns false if tn lies outside the unit domain.
+   */
+  static bool getSFCDigits(const TreeNode<T,D> &tn, LevI lev, ChildI *digits);
 };
 
 
@@ -58,3 +101,5 @@ template struct SFC_Search<unsigned int, 4>;
 
 }  // namespace ot
 
+#endif // DENDRO_KT_TSEARCH_CMPX_H
+
@@ -15,6 +15,9 @@
 #include "treeNode.h"
 #include <mpi.h>
 #include <vector>
+#include <functional>
+#include <memory>
+#include <algorithm>
 #include "hcurvedata.h"
 #include "parUtils.h"
 #include <stdio.h>
@@ -103,6 +106,67 @@ struct KeyFunIdentity_Pt
 };
 
 
+/**
+ * @brief Compares TreeNodes against one fixed key in the SFC order of locTreeSort()
+ *        (the same order as TreeNode::operator<()). The orientations along the key's
+ *        ancestry are computed once, so each comparison is constant time.
+ *        Useful for sorted scans and binary searches against the same key.
+ */
+template <typename T, unsigned int D>
+class SFC_CachedKey
+{
+  public:
+    SFC_CachedKey(const TreeNode<T,D> &key);
+
+    const TreeNode<T,D> &getKey() const { return m_key; }
+
+    /** @brief Returns -1, 0, or +1 as tn precedes, equals, or follows the key. */
+    int compare(const TreeNode<T,D> &tn) const;
+
+    /** @brief First element of an SFC-sorted range that does not precede the key, like std::lower_bound(). */
+    const TreeNode<T,D> *lowerBound(const TreeNode<T,D> *first, const TreeNode<T,D> *last) const;
+
+    /** @brief First element of an SFC-sorted range that follows the key, like std::upper_bound(). */
+    const TreeNode<T,D> *upperBound(const TreeNode<T,D> *first, const TreeNode<T,D> *last) const;
+
+  private:
+    TreeNode<T,D> m_key;
+    std::array<RotI, MAX_LEVEL+1> m_rot;  // m_rot[l]: orientation that orders the key's ancestors' children at level l.
+};
+
+
+
+
+//
+// PointStream
+//   Input of the streaming distTreeConstruction(), for point sets too
+//   large to hold in memory at once. The stream is read several times.
+//
+template <typename T, unsigned int D>
+struct PointStream
+{
+  // Copies up to `maxPoints' points into `buffer', returns how many.
+  // Returns 0 only at the end of the stream.
+  std::function<RankI (TreeNode<T,D> *buffer, RankI maxPoints)> read;
+
+  // Restarts the stream from the beginning. Called before every pass.
+  std::function<void ()> rewind;
+
+  // Stream from an array that outlives the stream.
+  static PointStream fromArray(const TreeNode<T,D> *points, RankI numPoints)
+  {
+    std::shared_ptr<RankI> pos = std::make_shared<RankI>(0);
+    PointStream stream;
+    stream.read = [=](TreeNode<T,D> *buffer, RankI maxPoints) {
+      const RankI count = std::min(maxPoints, numPoints - *pos);
+      std::copy(points + *pos, points + *pos + count, buffer);
+      *pos += count;
+      return count;
+    };
+    stream.rewind = [=]() { *pos = 0; };
+    return stream;
+  }
+};
 
 
 template <typename T, unsigned int D>
@@ -258,6 +322,8 @@ struct SFC_Tree
 
   // Notes:
   //   - (Sub)tree will be built by appending to `tree'.
+  //   - Subtrees with at least locTreeConstruction_taskGrain points are built
+  //     as OpenMP tasks; the result does not depend on the number of threads.
   static void locTreeConstruction(TreeNode<T,D> *points,
                                   std::vector<TreeNode<T,D>> &tree,
                                   RankI maxPtsPerRegion,
@@ -267,12 +333,58 @@ struct SFC_Tree
                                   RotI pRot,
                                   TreeNode<T,D> pNode);
 
+  // Buckets with fewer points than this are not worth an OpenMP task in locTreeConstruction().
+  static constexpr RankI locTreeConstruction_taskGrain = 4096;
+
+  // Notes:
+  //   - Recursive part of locTreeConstruction(). Spawns tasks, so should be
+  //     called inside a parallel region; otherwise the tasks run immediately.
+  //   - A task builds its subtree in a separate vector, which is spliced
+  //     into `tree' in SFC order after the siblings are done.
+  static void locTreeConstruction_impl(TreeNode<T,D> *points,
+                                       std::vector<TreeNode<T,D>> &tree,
+                                       RankI maxPtsPerRegion,
+                                       RankI begin, RankI end,
+                                       LevI sLev,
+                                       LevI eLev,
+                                       RotI pRot,
+                                       TreeNode<T,D> pNode);
+
   static void distTreeConstruction(std::vector<TreeNode<T,D>> &points,
                                    std::vector<TreeNode<T,D>> &tree,
                                    RankI maxPtsPerRegion,
                                    double loadFlexibility,
                                    MPI_Comm comm);
 
+  // Streaming variant of distTreeConstruction().
+  // Notes:
+  //   - Peak memory for points is O(chunkSize) per process, independent of
+  //     the size of the stream. Only `tree' grows with the input.
+  //   - Pass 1 (repeated, at most m_uiMaxDepth+1 times): Count points per
+  //     cell of a coarse complete tree and refine cells holding more than
+  //     max(maxPtsPerRegion, min(chunkSize, N/(4*nProc))) points. The counts
+  //     are reduce-scattered, so each process holds the global counts of a
+  //     slice of the cells; only the refinement decisions are replicated.
+  //     The coarse tree itself is replicated, to locate points in it.
+  //   - Each process owns a contiguous SFC range of coarse cells, balanced by
+  //     point counts, and processes them in batches of at most chunkSize points.
+  //   - Pass 2 (once): Every process streams its points once more and spills
+  //     them, bucketed by batch round, to a temporary file. Each round reads
+  //     back only its own points and sends them to their owners in chunks,
+  //     with sparse point-to-point exchanges.
+  //     The owner builds the subtree of each cell with locTreeConstruction().
+  //   - The leaves equal those of locTreeConstruction() over the union of
+  //     all points. `tree' is sorted, complete, and free of duplicates,
+  //     and partitioned by points, not by leaves.
+  //   - A cell at m_uiMaxDepth cannot be refined and may exceed chunkSize.
+  //   - Returns 0, or 1 on every process (with `tree' empty) if the temporary
+  //     file could not be created, written or read on any process.
+  static int distTreeConstruction(PointStream<T,D> &stream,
+                                   std::vector<TreeNode<T,D>> &tree,
+                                   RankI maxPtsPerRegion,
+                                   RankI chunkSize,
+                                   MPI_Comm comm);
+
   // Removes duplicate/ancestor TreeNodes from a sorted list of TreeNodes.
   // Notes:
   //   - Removal is done in a single pass in-place. The vector may be shrunk.
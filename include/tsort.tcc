@@ -7,6 +7,64 @@
 namespace ot
 {
 
+//
+// SFC_CachedKey()
+//
+template <typename T, unsigned int D>
+SFC_CachedKey<T,D>::SFC_CachedKey(const TreeNode<T,D> &key)
+  : m_key(key)
+{
+  constexpr char numChildren = TreeNode<T,D>::numChildren;
+
+  // Levels 0 and 1 use the 0th rotation, as in locTreeSort().
+  m_rot[0] = 0;
+  m_rot[1] = 0;
+  for (LevI l = 1; l < key.getLevel(); l++)
+    m_rot[l+1] = SFC_Tables<D>::orientLookup(m_rot[l])[key.getMortonIndex(l)];
+}
+
+
+//
+// SFC_CachedKey::compare()
+//
+template <typename T, unsigned int D>
+int SFC_CachedKey<T,D>::compare(const TreeNode<T,D> &tn) const
+{
+  constexpr char numChildren = TreeNode<T,D>::numChildren;
+
+  const LevI tnLev = tn.getLevel();
+  const LevI keyLev = m_key.getLevel();
+  const LevI levelDiff = m_key.getFirstDiffLevel(tn);
+
+  // In case of descendantship, ancestor is strictly less than descendant.
+  if (levelDiff > tnLev || levelDiff > keyLev)
+    return (tnLev < keyLev ? -1 : tnLev > keyLev ? +1 : 0);
+
+  const ChildI *rot_inv = SFC_Tables<D>::rotInv(m_rot[levelDiff]);   // child_sfc == rot_inv[child_morton];
+  return (rot_inv[tn.getMortonIndex(levelDiff)] < rot_inv[m_key.getMortonIndex(levelDiff)] ? -1 : +1);
+}
+
+
+//
+// SFC_CachedKey::lowerBound()
+//
+template <typename T, unsigned int D>
+const TreeNode<T,D> * SFC_CachedKey<T,D>::lowerBound(const TreeNode<T,D> *first, const TreeNode<T,D> *last) const
+{
+  return std::partition_point(first, last, [this](const TreeNode<T,D> &tn) { return compare(tn) < 0; });
+}
+
+
+//
+// SFC_CachedKey::upperBound()
+//
+template <typename T, unsigned int D>
+const TreeNode<T,D> * SFC_CachedKey<T,D>::upperBound(const TreeNode<T,D> *first, const TreeNode<T,D> *last) const
+{
+  return std::partition_point(first, last, [this](const TreeNode<T,D> &tn) { return compare(tn) <= 0; });
+}
+
+
 
 //
 // locTreeSort()
@@ -25,7 +83,6 @@ SFC_Tree<T,D>:: locTreeSort(PointType *points,
   if (end <= begin) { return; }
 
   constexpr char numChildren = TreeNode<T,D>::numChildren;
-  constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
 
   // Reorder the buckets on sLev (current level).
   std::array<RankI, numChildren+1> tempSplitters;
@@ -42,8 +99,8 @@ SFC_Tree<T,D>:: locTreeSort(PointType *points,
   // Ancestor splitters are is ancStart and ancEnd, not tempSplitters.
 
   // Lookup tables to apply rotations.
-  const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-  const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+  const ChildI * const rot_perm = SFC_Tables<D>::rotPerm(pRot);
+  const RotI * const orientLookup = SFC_Tables<D>::orientLookup(pRot);
 
   if (sLev < eLev)  // This means eLev is further from the root level than sLev.
   {
@@ -98,7 +155,6 @@ SFC_Tree<T,D>:: locTreeSort(PointType *points, Companion *companions,
   if (end <= begin) { return; }
 
   constexpr char numChildren = TreeNode<T,D>::numChildren;
-  constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
 
   // Reorder the buckets on sLev (current level).
   std::array<RankI, numChildren+1> tempSplitters;
@@ -114,8 +170,8 @@ SFC_Tree<T,D>:: locTreeSort(PointType *points, Companion *companions,
   // Ancestor splitters are is ancStart and ancEnd, not tempSplitters.
 
   // Lookup tables to apply rotations.
-  const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-  const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+  const ChildI * const rot_perm = SFC_Tables<D>::rotPerm(pRot);
+  const RotI * const orientLookup = SFC_Tables<D>::orientLookup(pRot);
 
   if (sLev < eLev)  // This means eLev is further from the root level than sLev.
   {
@@ -201,7 +257,6 @@ SFC_Tree<T,D>:: SFC_bucketing_general(PointType *points, Companion* companions,
 {
   using TreeNode = TreeNode<T,D>;
   constexpr char numChildren = TreeNode::numChildren;
-  constexpr char rotOffset = 2*numChildren;  // num columns in rotations[].
 
   // -- Reconstruct offsets and bucketEnds from returned splitters. -- //
   SFC_locateBuckets_impl<KeyFun,PointType,KeyType>(
@@ -211,7 +266,7 @@ SFC_Tree<T,D>:: SFC_bucketing_general(PointType *points, Companion* companions,
 
   std::array<RankI, numChildren+1> offsets, bucketEnds;  // Last idx represents ancestors.
 
-  const ChildI *rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
+  const ChildI *rot_perm = SFC_Tables<D>::rotPerm(pRot);
   for (ChildI child_sfc = 0; child_sfc < numChildren; child_sfc++)
   {
     ChildI child = rot_perm[child_sfc];
@@ -284,7 +339,6 @@ SFC_Tree<T,D>:: SFC_locateBuckets_impl(const PointType *points,
 {
   using TreeNode = TreeNode<T,D>;
   constexpr char numChildren = TreeNode::numChildren;
-  constexpr char rotOffset = 2*numChildren;  // num columns in rotations[].
 
   std::array<int, numChildren> counts;
   counts.fill(0);
@@ -305,7 +359,7 @@ SFC_Tree<T,D>:: SFC_locateBuckets_impl(const PointType *points,
   else
     accum = begin;                                   // Else first child is front.
 
-  const ChildI *rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
+  const ChildI *rot_perm = SFC_Tables<D>::rotPerm(pRot);
   ChildI child_sfc = 0;
   for ( ; child_sfc < numChildren; child_sfc++)
   {
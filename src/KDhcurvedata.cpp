@@ -19,56 +19,40 @@
 #include "../include/KDhcurvedata_decl.h"
 #include <assert.h>
 
-char* rotations;
-int* HILBERT_TABLE;
+const char* rotations = NULL;
+const int* HILBERT_TABLE = NULL;
 
-void _InitializeHcurve(int pDim)
+template <int pDim>
+static void pointToTables()
 {
-#ifdef HILBERT_ORDERING
+  rotations = SFC_Tables<pDim>::rotPerm(0);
+  HILBERT_TABLE = SFC_Tables<pDim>::orientLookup(0);
+}
 
+void _InitializeHcurve(int pDim)
+{
+  // No copy: the globals alias the constexpr tables of KDhcurvedata_DATA.h.
   switch(pDim)
   {
     case 2:
-      HilbertData<2>::copyData(rotations, HILBERT_TABLE);
+      pointToTables<2>();
       break;
 
     case 3:
-      HilbertData<3>::copyData(rotations, HILBERT_TABLE);
+      pointToTables<3>();
       break;
 
     case 4:
-      HilbertData<4>::copyData(rotations, HILBERT_TABLE);
+      pointToTables<4>();
       break;
 
     default:
       assert(false);
   }
-
-#else
-
-  const int num_orthant = (1u<<pDim);
-  rotations = new char[2*num_orthant];
-  HILBERT_TABLE = new int[num_orthant];
-  for (int ort = 0; ort < num_orthant; ort++)
-  {
-    rotations[ort] = ort;
-    rotations[ort + num_orthant] = ort;
-    HILBERT_TABLE[ort] = 0;
-  }
-
-#endif
 }
 
 void _DestroyHcurve()
 {
-  if (rotations != NULL)
-  {
-    delete [] rotations;
-    rotations = NULL;
-  }
-  if (HILBERT_TABLE != NULL)
-  {
-    delete [] HILBERT_TABLE;
-    HILBERT_TABLE = NULL;
-  }
+  rotations = NULL;
+  HILBERT_TABLE = NULL;
 }
@@ -7,8 +7,10 @@
  **/
 
 #include "oda.h"
+#include "profRegistry.h"
 
 #include <algorithm>
+#include <omp.h>
 
 namespace ot
 {
@@ -33,6 +35,12 @@ namespace ot
         m_uiGlobalNpes = 0;
         m_uiRankActive = 0;
         m_uiRankGlobal = 0;
+        m_uiGlobalComm = MPI_COMM_NULL;
+        m_uiActiveComm = MPI_COMM_NULL;
+        m_uiIsActive = false;
+        m_uiShmGhostReads = false;
+        m_uiNodeComm = MPI_COMM_NULL;
+        m_uiShmWin = MPI_WIN_NULL;
     }
 
 
@@ -52,10 +60,11 @@ namespace ot
     template <unsigned int dim>
     void DA<dim>::construct(const ot::TreeNode<C,dim> *inTree, unsigned int nEle, MPI_Comm comm, unsigned int order, unsigned int grainSz, double sfc_tol)
     {
+        DENDRO_PROF_SCOPE("DA::construct");
+
         //TODO
         // ???  leftover uninitialized member variables.
         //
-        /// unsigned int m_uiLocalElementSz;
         /// unsigned int m_uiTotalElementSz;
 
         m_uiElementOrder = order;
@@ -63,8 +72,6 @@ namespace ot
 
         unsigned int intNodesPerEle = intPow(order - 1, dim);
 
-        // TODO take into account grainSz and sfc_tol to set up activeComm.
-
         int nProc, rProc;
 
         m_uiGlobalComm = comm;
@@ -73,43 +80,151 @@ namespace ot
         m_uiGlobalNpes = nProc;
         m_uiRankGlobal = rProc;
 
-        // For now, make all procs active.
-        m_uiIsActive = true;
-        m_uiActiveComm = m_uiGlobalComm;
+        m_uiCommTag = 0;
+
+        m_uiShmGhostReads = false;
+        m_uiNodeComm = MPI_COMM_NULL;
+        m_uiShmWin = MPI_WIN_NULL;
+
+        m_uiConstructTimers.clear();
+        m_uiConstructTimers.t_activeComm.start();
+
+        // Decide how many procs stay active, so that each has at least grainSz elements.
+        // (sfc_tol is not used: the shrunk partition is an exact split of the elements.)
+        // grainSz is reduced so that all procs agree, even if callers pass local values.
+        DendroIntL locEle = nEle, glbEle = 0, minLocEle = 0;
+        par::Mpi_Allreduce(&locEle, &glbEle, 1, MPI_SUM, m_uiGlobalComm);
+        par::Mpi_Allreduce(&locEle, &minLocEle, 1, MPI_MIN, m_uiGlobalComm);
+        unsigned int locGrainSz = grainSz;
+        par::Mpi_Allreduce(&locGrainSz, &grainSz, 1, MPI_MAX, m_uiGlobalComm);
+
+        int npesActive = nProc;
+        if (grainSz > 0 && glbEle < (DendroIntL) grainSz * nProc)
+            npesActive = std::max<DendroIntL>(1, glbEle / grainSz);
+
+        std::vector<ot::TreeNode<C,dim>> activeTree;
+        if (glbEle > 0 && (npesActive < nProc || minLocEle == 0))
+        {
+            // Repartition the elements evenly over the first npesActive procs.
+            DendroIntL eleBegin = 0;
+            par::Mpi_Scan(&locEle, &eleBegin, 1, MPI_SUM, m_uiGlobalComm);
+            eleBegin -= locEle;
+
+            npesActive = std::max<DendroIntL>(1, std::min<DendroIntL>(npesActive, glbEle));
+            const std::vector<DendroIntL> eleBegins = util::evenSplitBegins(glbEle, npesActive, nProc);
+            activeTree.resize(eleBegins[rProc+1] - eleBegins[rProc]);
+            util::redistribute(inTree, eleBegin, locEle, activeTree.data(), eleBegins, 1, m_uiGlobalComm);
+
+            inTree = activeTree.data();
+            nEle = activeTree.size();
+
+            m_uiIsActive = (rProc < npesActive);
+            par::splitComm2way(!m_uiIsActive, &m_uiActiveComm, m_uiGlobalComm);
+        }
+        else
+        {
+            m_uiIsActive = true;
+            m_uiActiveComm = m_uiGlobalComm;
+        }
+
         MPI_Comm_size(m_uiActiveComm, &nProc);
         MPI_Comm_rank(m_uiActiveComm, &rProc);
         m_uiActiveNpes = nProc;
         m_uiRankActive = rProc;
 
-        m_uiCommTag = 0;
+        m_uiConstructTimers.t_activeComm.stop();
+
+        m_uiLocalElementSz = nEle;
+
+        if (!m_uiIsActive || glbEle == 0)
+        {
+            // Inactive procs hold no nodes, but still know the global size.
+            // An empty tree leaves every proc here, with no nodes at all.
+            m_uiLocalNodalSz = 0;
+            m_uiTotalNodalSz = 0;
+            m_uiPreNodeBegin = m_uiPreNodeEnd = 0;
+            m_uiLocalNodeBegin = m_uiLocalNodeEnd = 0;
+            m_uiPostNodeBegin = m_uiPostNodeEnd = 0;
+            m_uiGlobalRankBegin = 0;
+            m_tnCoords.clear();
+            m_tnElements.clear();
+            m_uiLocalNodePerm.clear();
+            m_uiBdyNodeIds.clear();
+            m_uiNodesByCoords.clear();
+            m_uiGlobalNodeSz = 0;
+            if (glbEle > 0)
+                par::Mpi_Bcast(&m_uiGlobalNodeSz, 1, 0, m_uiGlobalComm);
+            return;
+        }
 
         // Splitters for distributed exchanges.
         m_treePartFront = inTree[0];
         m_treePartBack = inTree[nEle-1];
 
+        m_tnElements.assign(inTree, inTree + nEle);
+
         // Generate nodes from the tree. First, element-exterior nodes.
+        m_uiConstructTimers.t_extNodes.start();
+        // Nodes shared by sibling elements are generated once, carrying their instance count.
         std::vector<ot::TNPoint<C,dim>> nodeList;
-        for (unsigned int ii = 0; ii < nEle; ii++)
-            ot::Element<C,dim>(inTree[ii]).appendExteriorNodes(order, nodeList);
+        ot::SFC_NodeSort<C,dim>::appendExteriorNodesCanonical(inTree, nEle, order, nodeList);
+        m_uiConstructTimers.t_extNodes.stop();
+
+        // Count unique element-exterior nodes, and meanwhile generate the
+        // element-interior nodes, which are purely local and take no part in the count.
+        // The master thread does the communication, so MPI_THREAD_FUNNELED suffices.
+        // The interior nodes are a task of the whole team, and so are the tasks of the
+        // local count, which the other threads pick up while waiting at the barrier.
+        int threadLevel = MPI_THREAD_SINGLE;
+        MPI_Query_thread(&threadLevel);
+        const bool overlapIntNodes = (threadLevel >= MPI_THREAD_FUNNELED && omp_get_max_threads() > 1);
+
+        std::vector<ot::TNPoint<C,dim>> intNodeList;
+        unsigned int glbExtNodes = 0;
+
+        #pragma omp parallel if (overlapIntNodes)
+        #pragma omp master
+        {
+            #pragma omp task default(shared)
+            {
+                m_uiConstructTimers.t_intNodes.start();
+                intNodeList.reserve(intNodesPerEle * nEle);
+                for (unsigned int ii = 0; ii < nEle; ii++)
+                    ot::Element<C,dim>(inTree[ii]).appendInteriorNodes(order, intNodeList);
+                m_uiConstructTimers.t_intNodes.stop();
+            }
 
-        // Count unique element-exterior nodes.
-        unsigned int glbExtNodes = ot::SFC_NodeSort<C,dim>::dist_countCGNodes(nodeList, order, &m_treePartFront, &m_treePartBack, m_uiActiveComm);
+            m_uiConstructTimers.t_countCGNodes.start();
+            glbExtNodes = ot::SFC_NodeSort<C,dim>::dist_countCGNodes(nodeList, order, &m_treePartFront, &m_treePartBack, m_uiActiveComm);
+            m_uiConstructTimers.t_countCGNodes.stop();
+        }
 
-        // Finish generating nodes from the tree - element-interior nodes.
-        // TODO measure if keeping interior nodes at end of list good/bad for performance.
-        for (unsigned int ii = 0; ii < nEle; ii++)
-            ot::Element<C,dim>(inTree[ii]).appendInteriorNodes(order, nodeList);
+        // Interior nodes stay at the end of the list; see renumberNodesFirstTouch().
+        nodeList.insert(nodeList.end(), intNodeList.begin(), intNodeList.end());
+        intNodeList.clear();
 
-        unsigned int locIntNodes = intNodesPerEle * nEle;
-        unsigned int glbIntNodes = 0;
-        par::Mpi_Allreduce(&locIntNodes, &glbIntNodes, 1, MPI_SUM, m_uiActiveComm);
+        // Every element has the same number of interior nodes, so no reduction is needed.
+        const DendroIntL glbIntNodes = (DendroIntL) intNodesPerEle * glbEle;
 
         m_uiLocalNodalSz = nodeList.size();
         m_uiGlobalNodeSz = glbExtNodes + glbIntNodes;
 
+        m_uiLocalNodePerm.resize(m_uiLocalNodalSz);
+        std::iota(m_uiLocalNodePerm.begin(), m_uiLocalNodePerm.end(), 0);
+
+        // Find offset into the global array. The scan proceeds while the maps are built.
+        unsigned long locSz = m_uiLocalNodalSz;
+        MPI_Request scanRequest;
+        MPI_Iscan(&locSz, &m_uiGlobalRankBegin, 1, MPI_UNSIGNED_LONG, MPI_SUM, m_uiActiveComm, &scanRequest);
+
         // Create scatter/gather maps. Scatter map reflects whatever ordering is in nodeList.
+        m_uiConstructTimers.t_scattermap.start();
         m_sm = ot::SFC_NodeSort<C,dim>::computeScattermap(nodeList, &m_treePartFront, m_uiActiveComm);
+        m_uiConstructTimers.t_scattermap.stop();
+
+        m_uiConstructTimers.t_gathermap.start();
         m_gm = ot::SFC_NodeSort<C,dim>::scatter2gather(m_sm, m_uiLocalNodalSz, m_uiActiveComm);
+        m_uiConstructTimers.t_gathermap.stop();
 
         // Export from gm: dividers between local and ghost segments.
         m_uiTotalNodalSz   = m_gm.m_totalCount;
@@ -123,11 +238,6 @@ namespace ot
         // Note: We will offset the starting address whenever we copy with scattermap.
         // Otherwise we should build-in the offset to the scattermap here.
 
-        // Find offset into the global array.
-        unsigned long locSz = m_uiLocalNodalSz;
-        par::Mpi_Scan(&locSz, &m_uiGlobalRankBegin, 1, MPI_SUM, comm);
-        m_uiGlobalRankBegin -= locSz;
-
         // Create vector of node coordinates, with ghost segments allocated.
         m_tnCoords.resize(m_uiTotalNodalSz);
         for (unsigned int ii = 0; ii < m_uiLocalNodalSz; ii++)
@@ -135,10 +245,15 @@ namespace ot
         nodeList.clear();
 
         // Fill ghost segments of node coordinates vector.
+        m_uiConstructTimers.t_ghostCoords.start();
         std::vector<ot::TreeNode<C,dim>> tmpSendBuf(m_sm.m_map.size());
         ot::SFC_NodeSort<C,dim>::template ghostExchange<ot::TreeNode<C,dim>>(
             &(*m_tnCoords.begin()), &(*tmpSendBuf.begin()), m_sm, m_gm, m_uiActiveComm);
         //TODO transfer ghostExchange into this class, then use new method.
+        m_uiConstructTimers.t_ghostCoords.stop();
+
+        MPI_Wait(&scanRequest, MPI_STATUS_IGNORE);
+        m_uiGlobalRankBegin -= locSz;
 
         // Identify the (local ids of) domain boundary nodes in local vector.
         // To use the ids in the ghosted vector you need to shift by m_uiLocalNodeBegin.
@@ -148,12 +263,238 @@ namespace ot
           if (m_tnCoords[ii + m_uiLocalNodeBegin].isOnDomainBoundary())
             m_uiBdyNodeIds.push_back(ii);
         }
+
+        // Built by the first output or slice that needs it.
+        m_uiNodesByCoords.clear();
+
+        // Inactive procs are waiting to learn the global size.
+        if (m_uiActiveComm != m_uiGlobalComm)
+            par::Mpi_Bcast(&m_uiGlobalNodeSz, 1, 0, m_uiGlobalComm);
+    }
+
+
+    template <unsigned int dim>
+    void DA<dim>::renumberNodesFirstTouch()
+    {
+        if (!m_uiIsActive)
+            return;
+
+        const ot::TreeNode<C,dim> * const localCoords = &m_tnCoords[m_uiLocalNodeBegin];
+
+        // Local node ids sorted by coordinates, then level, to look up the nodes of each element.
+        // Nodes at the same coordinates with different levels (hanging) are distinct.
+        auto sameCoords = [](const ot::TreeNode<C,dim> &a, const ot::TreeNode<C,dim> &b) {
+            for (int d = 0; d < dim; d++)
+                if (a.getX(d) != b.getX(d))
+                    return false;
+            return true;
+        };
+        auto nodeLess = [](const ot::TreeNode<C,dim> &a, const ot::TreeNode<C,dim> &b) {
+            for (int d = 0; d < dim; d++)
+                if (a.getX(d) != b.getX(d))
+                    return a.getX(d) < b.getX(d);
+            return a.getLevel() < b.getLevel();
+        };
+        std::vector<unsigned int> byCoords(m_uiLocalNodalSz);
+        std::iota(byCoords.begin(), byCoords.end(), 0);
+        std::sort(byCoords.begin(), byCoords.end(),
+            [&](unsigned int a, unsigned int b) { return nodeLess(localCoords[a], localCoords[b]); });
+
+        // Number the nodes as the elements are visited. Element nodes that are not
+        // local (ghosts, or hanging nodes that were resolved away) are skipped.
+        const unsigned int unassigned = (unsigned int) -1;
+        std::vector<unsigned int> newId(m_uiLocalNodalSz, unassigned);
+        unsigned int nextId = 0;
+
+        std::vector<ot::TreeNode<C,dim>> eleNodes;
+        for (const ot::TreeNode<C,dim> &ele : m_tnElements)
+        {
+            eleNodes.clear();
+            ot::Element<C,dim>(ele).template appendNodes<ot::TreeNode<C,dim>>(m_uiElementOrder, eleNodes);
+            for (const ot::TreeNode<C,dim> &node : eleNodes)
+            {
+                // The node at the level of the element, else the nearest coarser one.
+                auto it = std::lower_bound(byCoords.begin(), byCoords.end(), node,
+                    [&](unsigned int id, const ot::TreeNode<C,dim> &key) { return nodeLess(localCoords[id], key); });
+                if (it == byCoords.end() || nodeLess(node, localCoords[*it]))
+                {
+                    if (it != byCoords.begin() && sameCoords(node, localCoords[*(it-1)]))
+                        --it;
+                    else
+                        continue;
+                }
+                if (newId[*it] == unassigned)
+                    newId[*it] = nextId++;
+            }
+        }
+        for (unsigned int ii = 0; ii < m_uiLocalNodalSz; ii++)
+            if (newId[ii] == unassigned)
+                newId[ii] = nextId++;
+
+        // Apply the permutation to the coordinates and the construction-order map.
+        std::vector<ot::TreeNode<C,dim>> newCoords(m_uiLocalNodalSz);
+        std::vector<unsigned int> newPerm(m_uiLocalNodalSz);
+        for (unsigned int ii = 0; ii < m_uiLocalNodalSz; ii++)
+        {
+            newCoords[newId[ii]] = localCoords[ii];
+            newPerm[newId[ii]] = m_uiLocalNodePerm[ii];
+        }
+        std::copy(newCoords.begin(), newCoords.end(), m_tnCoords.begin() + m_uiLocalNodeBegin);
+        m_uiLocalNodePerm.swap(newPerm);
+
+        // The scattermap keeps its send order, so the ghost segments of other procs do not change.
+        for (auto &sendId : m_sm.m_map)
+            sendId = newId[sendId];
+        // Likewise the staging map of shared ghost reads, if enabled; its offsets do not change.
+        for (auto &sendId : m_uiShmSendMap)
+            sendId = newId[sendId];
+
+        m_uiBdyNodeIds.clear();
+        for (unsigned int ii = 0; ii < m_uiLocalNodalSz; ii++)
+        {
+          if (m_tnCoords[ii + m_uiLocalNodeBegin].isOnDomainBoundary())
+            m_uiBdyNodeIds.push_back(ii);
+        }
+
+        // The local node ids changed.
+        m_uiNodesByCoords.clear();
+    }
+
+
+    template <unsigned int dim>
+    void DA<dim>::indexNodesByCoords()
+    {
+        if (m_uiNodesByCoords.size() == m_uiTotalNodalSz)
+            return;
+
+        m_uiNodesByCoords.resize(m_uiTotalNodalSz);
+        std::iota(m_uiNodesByCoords.begin(), m_uiNodesByCoords.end(), 0);
+        std::sort(m_uiNodesByCoords.begin(), m_uiNodesByCoords.end(), [this](unsigned int a, unsigned int b) {
+            for (int d = 0; d < dim; d++)
+                if (m_tnCoords[a].getX(d) != m_tnCoords[b].getX(d))
+                    return m_tnCoords[a].getX(d) < m_tnCoords[b].getX(d);
+            return m_tnCoords[a].getLevel() < m_tnCoords[b].getLevel();
+        });
     }
 
 
     template <unsigned int dim>
     DA<dim>::~DA()
     {
+        // MPI handles cannot be released once MPI is finalized.
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (finalized)
+            return;
+
+        disableSharedGhostReads();
+
+        if (m_uiActiveComm != m_uiGlobalComm && m_uiActiveComm != MPI_COMM_NULL)
+            MPI_Comm_free(&m_uiActiveComm);
+    }
+
+
+    template <unsigned int dim>
+    void DA<dim>::enableSharedGhostReads(unsigned int maxDof)
+    {
+        if (!m_uiIsActive || m_uiShmGhostReads)
+            return;
+
+        MPI_Comm_split_type(m_uiActiveComm, MPI_COMM_TYPE_SHARED, m_uiRankActive, MPI_INFO_NULL, &m_uiNodeComm);
+
+        // Find which neighbours share our node.
+        const int nSend = m_sm.m_sendProc.size();
+        const int nRecv = m_gm.m_recvProc.size();
+        std::vector<int> sendNodeRank(nSend);
+        m_uiShmRecvNodeRank.resize(nRecv);
+
+        MPI_Group activeGroup, nodeGroup;
+        MPI_Comm_group(m_uiActiveComm, &activeGroup);
+        MPI_Comm_group(m_uiNodeComm, &nodeGroup);
+        MPI_Group_translate_ranks(activeGroup, nSend, m_sm.m_sendProc.data(), nodeGroup, sendNodeRank.data());
+        MPI_Group_translate_ranks(activeGroup, nRecv, m_gm.m_recvProc.data(), nodeGroup, m_uiShmRecvNodeRank.data());
+        MPI_Group_free(&activeGroup);
+        MPI_Group_free(&nodeGroup);
+
+        // Data for on-node procs is staged contiguously in our shared segment.
+        m_uiShmSendOffsets.assign(nSend, -1);
+        m_uiShmSendMap.clear();
+        for (int sIdx = 0; sIdx < nSend; sIdx++)
+            if (sendNodeRank[sIdx] != MPI_UNDEFINED)
+            {
+                m_uiShmSendOffsets[sIdx] = m_uiShmSendMap.size();
+                m_uiShmSendMap.insert(m_uiShmSendMap.end(),
+                    m_sm.m_map.begin() + m_sm.m_sendOffsets[sIdx],
+                    m_sm.m_map.begin() + m_sm.m_sendOffsets[sIdx] + m_sm.m_sendCounts[sIdx]);
+            }
+        m_uiShmSendSz = m_uiShmSendMap.size();
+
+        // Tell on-node receivers where to find their ghosts.
+        m_uiShmRecvOffsets.assign(nRecv, 0);
+        std::vector<MPI_Request> requests;
+        requests.reserve(nSend + nRecv);
+        for (int rIdx = 0; rIdx < nRecv; rIdx++)
+            if (m_uiShmRecvNodeRank[rIdx] != MPI_UNDEFINED)
+            {
+                requests.emplace_back();
+                par::Mpi_Irecv(&m_uiShmRecvOffsets[rIdx], 1, m_gm.m_recvProc[rIdx], m_uiCommTag, m_uiActiveComm, &requests.back());
+            }
+        for (int sIdx = 0; sIdx < nSend; sIdx++)
+            if (sendNodeRank[sIdx] != MPI_UNDEFINED)
+            {
+                requests.emplace_back();
+                par::Mpi_Isend(&m_uiShmSendOffsets[sIdx], 1, m_sm.m_sendProc[sIdx], m_uiCommTag, m_uiActiveComm, &requests.back());
+            }
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+        m_uiCommTag++;
+
+        m_uiShmRecvBase.assign(nRecv, NULL);
+        allocateShmWindow(sizeof(VECType) * std::max(1u, maxDof));
+
+        m_uiShmGhostReads = true;
+    }
+
+
+    template <unsigned int dim>
+    void DA<dim>::disableSharedGhostReads()
+    {
+        if (!m_uiShmGhostReads)
+            return;
+
+        MPI_Win_unlock_all(m_uiShmWin);
+        MPI_Win_free(&m_uiShmWin);
+        MPI_Comm_free(&m_uiNodeComm);
+
+        m_uiShmSendOffsets.clear();
+        m_uiShmSendMap.clear();
+        m_uiShmRecvNodeRank.clear();
+        m_uiShmRecvOffsets.clear();
+        m_uiShmRecvBase.clear();
+        m_uiShmLocalBase = NULL;
+
+        m_uiShmGhostReads = false;
+    }
+
+
+    template <unsigned int dim>
+    void DA<dim>::allocateShmWindow(size_t entryBytes)
+    {
+        m_uiShmEntryBytes = entryBytes;
+        MPI_Win_allocate_shared(entryBytes * m_uiShmSendSz, 1, MPI_INFO_NULL, m_uiNodeComm, &m_uiShmLocalBase, &m_uiShmWin);
+
+        // One passive epoch for the lifetime of the window;
+        // readFromGhostEnd() separates stores from loads with MPI_Win_sync() and barriers.
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, m_uiShmWin);
+
+        for (unsigned int rIdx = 0; rIdx < m_uiShmRecvNodeRank.size(); rIdx++)
+            if (m_uiShmRecvNodeRank[rIdx] != MPI_UNDEFINED)
+            {
+                MPI_Aint segSz;
+                int dispUnit;
+                void *segBase;
+                MPI_Win_shared_query(m_uiShmWin, m_uiShmRecvNodeRank[rIdx], &segSz, &dispUnit, &segBase);
+                m_uiShmRecvBase[rIdx] = (const char *) segBase;
+            }
     }
 
 
@@ -324,12 +665,12 @@ namespace ot
 
 
     template <unsigned int dim>
-    void DA<dim>::petscVecTopvtu(const Vec& local, const char * fPrefix,char** nodalVarNames,bool isElemental,bool isGhosted,unsigned int dof) 
+    void DA<dim>::petscVecTopvtu(const Vec& local, const char * fPrefix,char** nodalVarNames,bool isElemental,bool isGhosted,unsigned int dof,double sliceCoord) 
     {
         const PetscScalar *arry=NULL;
         VecGetArrayRead(local,&arry);
 
-        vecTopvtu(arry,fPrefix,nodalVarNames,isElemental,isGhosted,dof);
+        vecTopvtu(arry,fPrefix,nodalVarNames,isElemental,isGhosted,dof,sliceCoord);
 
         VecRestoreArrayRead(local,&arry);
     }
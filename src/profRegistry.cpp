@@ -0,0 +1,503 @@
+/**
+ * @file:profRegistry.cpp
+ * @brief: Registry of nested, named timing regions with byte and flop counters.
+ */
+
+#include "profRegistry.h"
+#include "parUtils.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+#ifdef HAVE_PAPI
+#include <papi.h>
+#endif
+
+namespace prof
+{
+namespace
+{
+    struct Region
+    {
+        const char *name;
+        Region *parent;
+        std::vector<std::unique_ptr<Region>> children;
+
+        double seconds = 0.0;
+        long long calls = 0;
+        long long bytes = 0;
+        long long flops = 0;
+        long long papiFlops = 0;
+
+        double startSeconds = 0.0;
+        long long startPapiFlops = 0;
+        long traceArg = -1;
+
+        Region(const char *n, Region *p) : name(n), parent(p) {}
+    };
+
+    struct TraceEvent
+    {
+        const char *name;
+        long arg;
+        double begin;
+        double end;
+    };
+
+    // The regions of one thread. Only the owning thread modifies it.
+    struct ThreadTree
+    {
+        Region root;
+        Region *current;
+        uint32_t threadId;
+
+        std::vector<TraceEvent> events;
+        uint64_t numDropped;
+
+        ThreadTree(uint32_t id) : root("", NULL), current(&root), threadId(id), numDropped(0) {}
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadTree>> registry;
+    thread_local ThreadTree *threadTree = NULL;
+
+    // Trace state, set by traceBegin().
+    std::atomic<bool> traceOn(false);
+    double traceOrigin = 0.0;
+    size_t traceMaxEvents = 0;
+    std::string tracePrefix;
+    int traceRank = 0, traceNpes = 1;
+
+    ThreadTree &getThreadTree()
+    {
+        if (threadTree == NULL)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.emplace_back(new ThreadTree(registry.size()));
+            threadTree = registry.back().get();
+        }
+        return *threadTree;
+    }
+
+    std::string traceFileName(const char *prefix, int rank)
+    {
+        return std::string(prefix) + "." + std::to_string(rank) + ".trace";
+    }
+
+    void makeTraceMagic(char *magic)
+    {
+        memcpy(magic, "DKTTRACE", 8);
+    }
+
+    long long readPapiFlops()
+    {
+#ifdef HAVE_PAPI
+        float rtime, ptime, mflops;
+        long long flpops = 0;
+        PAPI_flops(&rtime, &ptime, &flpops, &mflops);
+        return flpops;
+#else
+        return 0;
+#endif
+    }
+
+    void collect(const Region &region, const std::string &path, std::map<std::string, RegionStats> &stats)
+    {
+        for (const std::unique_ptr<Region> &child : region.children)
+        {
+            const std::string childPath = (path.empty() ? child->name : path + "/" + child->name);
+            RegionStats &s = stats[childPath];
+            s.path = childPath;
+            s.seconds = std::max(s.seconds, child->seconds);
+            s.calls += child->calls;
+            s.bytes += child->bytes;
+            s.flops += child->flops;
+            s.papiFlops += child->papiFlops;
+            collect(*child, childPath, stats);
+        }
+    }
+
+    Region *findChild(Region *parent, const char *name)
+    {
+        for (const std::unique_ptr<Region> &child : parent->children)
+            if (child->name == name || strcmp(child->name, name) == 0)
+                return child.get();
+        parent->children.emplace_back(new Region(name, parent));
+        return parent->children.back().get();
+    }
+
+    void clear(Region &region)
+    {
+        region.seconds = 0.0;
+        region.calls = region.bytes = region.flops = region.papiFlops = 0;
+        for (std::unique_ptr<Region> &child : region.children)
+            clear(*child);
+    }
+}
+
+
+    void beginRegion(const char *name, long arg)
+    {
+        ThreadTree &tree = getThreadTree();
+        Region *region = findChild(tree.current, name);
+
+        tree.current = region;
+        region->traceArg = arg;
+        region->startPapiFlops = readPapiFlops();
+        region->startSeconds = omp_get_wtime();
+    }
+
+
+    void endRegion()
+    {
+        const double seconds = omp_get_wtime();
+        ThreadTree &tree = getThreadTree();
+        Region *region = tree.current;
+        assert(region->parent != NULL);   // Unbalanced endRegion().
+        if (region->parent == NULL)
+            return;
+
+        region->seconds += seconds - region->startSeconds;
+        region->papiFlops += readPapiFlops() - region->startPapiFlops;
+        region->calls++;
+        tree.current = region->parent;
+
+        if (traceOn.load(std::memory_order_relaxed) && region->startSeconds >= traceOrigin)
+        {
+            if (tree.events.size() < traceMaxEvents)
+                tree.events.push_back({region->name, region->traceArg, region->startSeconds, seconds});
+            else
+                tree.numDropped++;
+        }
+    }
+
+
+    void addRegion(const char *name, double seconds, long long calls, long arg)
+    {
+        const double now = omp_get_wtime();
+        ThreadTree &tree = getThreadTree();
+        Region *region = findChild(tree.current, name);
+        region->seconds += seconds;
+        region->calls += calls;
+
+        // The event may not begin before the trace does.
+        if (traceOn.load(std::memory_order_relaxed))
+        {
+            if (tree.events.size() < traceMaxEvents)
+                tree.events.push_back({region->name, arg, std::max(now - seconds, traceOrigin), now});
+            else
+                tree.numDropped++;
+        }
+    }
+
+
+    void addBytes(long long bytes)
+    {
+        getThreadTree().current->bytes += bytes;
+    }
+
+
+    void addFlops(long long flops)
+    {
+        getThreadTree().current->flops += flops;
+    }
+
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (std::unique_ptr<ThreadTree> &tree : registry)
+            clear(tree->root);
+    }
+
+
+    std::vector<RegionStats> getLocalStats()
+    {
+        std::map<std::string, RegionStats> stats;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const std::unique_ptr<ThreadTree> &tree : registry)
+                collect(tree->root, "", stats);
+        }
+
+        std::vector<RegionStats> statsList;
+        for (const auto &s : stats)
+            statsList.push_back(s.second);
+        return statsList;
+    }
+
+
+    bool getLocalStats(const char *path, RegionStats &stats)
+    {
+        for (const RegionStats &s : getLocalStats())
+            if (s.path == path)
+            {
+                stats = s;
+                return true;
+            }
+        return false;
+    }
+
+
+    void report(std::ostream &fout, MPI_Comm comm)
+    {
+        int rank, npes;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &npes);
+
+        const std::vector<RegionStats> localStats = getLocalStats();
+
+        // Union of the paths of all procs; a path may be entered on some procs only.
+        std::string localPaths;
+        for (const RegionStats &s : localStats)
+            localPaths += s.path + '\n';
+        int localLen = localPaths.size();
+        std::vector<int> lens(npes), displs(npes, 0);
+        par::Mpi_Allgather<int>(&localLen, lens.data(), 1, comm);
+        for (int p = 1; p < npes; p++)
+            displs[p] = displs[p-1] + lens[p-1];
+        std::vector<char> allPaths(displs[npes-1] + lens[npes-1] + 1);
+        par::Mpi_Allgatherv<char>(&localPaths[0], localLen, allPaths.data(), lens.data(), displs.data(), comm);
+
+        std::set<std::string> paths;
+        for (size_t begin = 0, end; begin + 1 < allPaths.size(); begin = end + 1)
+        {
+            end = std::find(allPaths.begin() + begin, allPaths.end() - 1, '\n') - allPaths.begin();
+            paths.insert(std::string(allPaths.data() + begin, end - begin));
+        }
+
+        const size_t n = paths.size();
+        std::vector<double> seconds(n, 0.0), secondsMin(n), secondsSum(n), secondsMax(n);
+        std::vector<long long> counts(4*n, 0), countsSum(4*n);
+        size_t ii = 0, jj = 0;
+        for (const std::string &path : paths)
+        {
+            while (jj < localStats.size() && localStats[jj].path < path)
+                jj++;
+            if (jj < localStats.size() && localStats[jj].path == path)
+            {
+                seconds[ii] = localStats[jj].seconds;
+                counts[4*ii + 0] = localStats[jj].calls;
+                counts[4*ii + 1] = localStats[jj].bytes;
+                counts[4*ii + 2] = localStats[jj].flops;
+                counts[4*ii + 3] = localStats[jj].papiFlops;
+            }
+            ii++;
+        }
+
+        if (n > 0)
+        {
+            par::Mpi_Reduce<double>(seconds.data(), secondsMin.data(), n, MPI_MIN, 0, comm);
+            par::Mpi_Reduce<double>(seconds.data(), secondsSum.data(), n, MPI_SUM, 0, comm);
+            par::Mpi_Reduce<double>(seconds.data(), secondsMax.data(), n, MPI_MAX, 0, comm);
+            par::Mpi_Reduce<long long>(counts.data(), countsSum.data(), 4*n, MPI_SUM, 0, comm);
+        }
+
+        if (!rank)
+        {
+            fout << "region\tcalls(mean)\tseconds(min)\tseconds(mean)\tseconds(max)\tbytes(mean)\tflops(mean)";
+#ifdef HAVE_PAPI
+            fout << "\tpapi_flops(mean)";
+#endif
+            fout << std::endl;
+
+            ii = 0;
+            for (const std::string &path : paths)
+            {
+                fout << path << "\t"
+                     << (double) countsSum[4*ii + 0] / npes << "\t"
+                     << secondsMin[ii] << "\t" << secondsSum[ii] / npes << "\t" << secondsMax[ii] << "\t"
+                     << (double) countsSum[4*ii + 1] / npes << "\t"
+                     << (double) countsSum[4*ii + 2] / npes;
+#ifdef HAVE_PAPI
+                fout << "\t" << (double) countsSum[4*ii + 3] / npes;
+#endif
+                fout << std::endl;
+                ii++;
+            }
+        }
+    }
+
+
+
+    void traceBegin(const char *prefix, MPI_Comm comm, size_t maxEventsPerThread)
+    {
+        MPI_Comm_rank(comm, &traceRank);
+        MPI_Comm_size(comm, &traceNpes);
+        tracePrefix = prefix;
+        traceMaxEvents = maxEventsPerThread;
+
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (std::unique_ptr<ThreadTree> &tree : registry)
+            {
+                tree->events.clear();
+                tree->numDropped = 0;
+            }
+        }
+
+        // The procs leave the barrier at about the same time; that is the time origin.
+        MPI_Barrier(comm);
+        traceOrigin = omp_get_wtime();
+        traceOn = true;
+    }
+
+
+    int traceEnd()
+    {
+        if (!traceOn)
+            return 1;
+        traceOn = false;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        TraceFileHeader header;
+        makeTraceMagic(header.m_magic);
+        header.m_version = 1;
+        header.m_rank = traceRank;
+        header.m_npes = traceNpes;
+        header.m_numEvents = 0;
+        header.m_numDropped = 0;
+
+        std::map<std::string, uint32_t> nameIds;
+        std::vector<const std::string *> names;
+        std::vector<TraceRecord> records;
+        for (const std::unique_ptr<ThreadTree> &tree : registry)
+        {
+            header.m_numDropped += tree->numDropped;
+            for (const TraceEvent &e : tree->events)
+            {
+                auto it = nameIds.find(e.name);
+                if (it == nameIds.end())
+                {
+                    it = nameIds.insert(std::make_pair(std::string(e.name), (uint32_t) names.size())).first;
+                    names.push_back(&it->first);
+                }
+                TraceRecord rec;
+                rec.m_name = it->second;
+                rec.m_thread = tree->threadId;
+                rec.m_arg = e.arg;
+                rec.m_begin = (uint64_t) ((e.begin - traceOrigin) * 1e9);
+                rec.m_duration = (uint64_t) ((e.end - e.begin) * 1e9);
+                records.push_back(rec);
+            }
+            tree->events.clear();
+            tree->events.shrink_to_fit();
+        }
+        header.m_numNames = names.size();
+        header.m_numEvents = records.size();
+
+        const std::string fName = traceFileName(tracePrefix.c_str(), traceRank);
+        FILE *outfile = fopen(fName.c_str(), "wb");
+        if (outfile == NULL)
+        {
+            std::cout << fName << " file open failed " << std::endl;
+            return 1;
+        }
+
+        bool ok = (fwrite(&header, sizeof(header), 1, outfile) == 1);
+        for (const std::string *name : names)
+        {
+            const uint32_t len = name->size();
+            ok &= (fwrite(&len, sizeof(len), 1, outfile) == 1);
+            ok &= (fwrite(name->data(), 1, len, outfile) == len);
+        }
+        if (!records.empty())
+            ok &= (fwrite(records.data(), sizeof(TraceRecord), records.size(), outfile) == records.size());
+        ok &= (fclose(outfile) == 0);
+
+        return (ok ? 0 : 1);
+    }
+
+
+    int writeChromeTrace(const char *prefix, const char *jsonName)
+    {
+        FILE *outfile = fopen(jsonName, "w");
+        if (outfile == NULL)
+        {
+            std::cout << jsonName << " file open failed " << std::endl;
+            return 1;
+        }
+        fprintf(outfile, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+        int npes = 1;
+        bool first = true;
+        int numFailed = 0;
+        for (int rank = 0; rank < npes; rank++)
+        {
+            const std::string fName = traceFileName(prefix, rank);
+            FILE *infile = fopen(fName.c_str(), "rb");
+            if (infile == NULL)
+            {
+                std::cout << fName << " file open failed " << std::endl;
+                numFailed++;
+                continue;
+            }
+
+            TraceFileHeader header, magic;
+            makeTraceMagic(magic.m_magic);
+            if (fread(&header, sizeof(header), 1, infile) != 1 || memcmp(header.m_magic, magic.m_magic, sizeof(magic.m_magic)) != 0)
+            {
+                std::cout << fName << " is not a trace file " << std::endl;
+                fclose(infile);
+                numFailed++;
+                continue;
+            }
+            if (rank == 0)
+                npes = header.m_npes;
+            if (header.m_numDropped)
+                std::cout << fName << ": " << header.m_numDropped << " events were dropped " << std::endl;
+
+            std::vector<std::string> names(header.m_numNames);
+            bool ok = true;
+            for (std::string &name : names)
+            {
+                uint32_t len = 0;
+                ok &= (fread(&len, sizeof(len), 1, infile) == 1);
+                name.resize(ok ? len : 0);
+                if (len && ok)
+                    ok &= (fread(&name[0], 1, len, infile) == len);
+            }
+            std::vector<TraceRecord> records(header.m_numEvents);
+            if (ok && !records.empty())
+                ok &= (fread(records.data(), sizeof(TraceRecord), records.size(), infile) == records.size());
+            fclose(infile);
+            if (!ok)
+            {
+                std::cout << fName << " is truncated " << std::endl;
+                numFailed++;
+                continue;
+            }
+
+            fprintf(outfile, "%s{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"name\": \"rank %d\"}},\n",
+                (first ? "" : ",\n"), rank, rank);
+            fprintf(outfile, "{\"name\": \"process_sort_index\", \"ph\": \"M\", \"pid\": %d, \"args\": {\"sort_index\": %d}}", rank, rank);
+            first = false;
+
+            // Complete events, in microseconds.
+            for (const TraceRecord &rec : records)
+            {
+                if (rec.m_name >= names.size())
+                    continue;
+                fprintf(outfile, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f",
+                    names[rec.m_name].c_str(), rank, rec.m_thread, rec.m_begin * 1e-3, rec.m_duration * 1e-3);
+                if (rec.m_arg >= 0)
+                    fprintf(outfile, ", \"args\": {\"arg\": %lld}", (long long) rec.m_arg);
+                fprintf(outfile, "}");
+            }
+        }
+
+        fprintf(outfile, "\n]}\n");
+        numFailed += (fclose(outfile) != 0);
+        return numFailed;
+    }
+
+}// end of namespace prof
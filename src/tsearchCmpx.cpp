@@ -7,6 +7,10 @@
 
 #include "tsearchCmpx.h"
 #include "treeNode.h"
+#include "hcurvedata.h"
+#include "parUtils.h"
+
+#include <algorithm>
 
 namespace ot
 {
@@ -20,6 +24,9 @@ void SFC_Search<T,D>::compressTree(
   if (treeSize == 0)
     return;
 
+  if (outTree.segments.size() == 0)
+    outTree.startRank = startRank;
+
   RankI sampleIdx = 0;
   RankI segIdx = 0;
   RankI tIdx = 0;
@@ -45,4 +52,224 @@ void SFC_Search<T,D>::compressTree(
 }
 
 
+template <typename T, unsigned int D>
+constexpr RankI SFC_Search<T,D>::notFound;
+
+
+template <typename T, unsigned int D>
+bool SFC_Search<T,D>::getSFCDigits(const TreeNode<T,D> &tn, LevI lev, ChildI *digits)
+{
+  constexpr char numChildren = TreeNode<T,D>::numChildren;
+
+  if (tn.getMortonIndex(0) != 0)
+    return false;
+
+  // Level 1 is ordered by the 0th rotation, as in locTreeSort().
+  RotI pRot = 0;
+  for (LevI l = 1; l <= lev; l++)
+  {
+    const ChildI *rot_inv = SFC_Tables<D>::rotInv(pRot);   // child_sfc == rot_inv[child_morton];
+    const ChildI child_m = tn.getMortonIndex(l);
+    digits[l] = rot_inv[child_m];
+    pRot = SFC_Tables<D>::orientLookup(pRot)[child_m];
+  }
+  return true;
+}
+
+
+//
+// Helpers for arithmetic on SFC digit strings, digits[1..lev] in base numChildren.
+//
+namespace
+{
+  /** @brief -1, 0, +1 as the cell of pt at level lev precedes, contains, or follows cell. */
+  inline int compareSFCDigits(const ChildI *ptDigits, const ChildI *cellDigits, LevI lev)
+  {
+    for (LevI l = 1; l <= lev; l++)
+      if (ptDigits[l] != cellDigits[l])
+        return (ptDigits[l] < cellDigits[l] ? -1 : +1);
+    return 0;
+  }
+
+  /**
+   * @brief Number of level-lev cells from cell to the cell containing pt, which must not precede it.
+   * @return The exact offset if it is less than bound, otherwise some value >= bound.
+   */
+  inline RankI offsetSFCDigits(const ChildI *ptDigits, const ChildI *cellDigits, LevI lev, RankI numChildren, RankI bound)
+  {
+    LevI l = 1;
+    while (l <= lev && ptDigits[l] == cellDigits[l])
+      l++;
+
+    // Once the leading difference is positive, the partial offset stays positive
+    // and grows by at least a factor of numChildren, so we can stop at the bound.
+    RankI offset = 0;
+    for ( ; l <= lev && offset < bound; l++)
+      offset = offset * numChildren + (ptDigits[l] - cellDigits[l]);
+    return offset;
+  }
+
+  /** @brief Advances cell by count cells at level lev. Returns false if it falls off the end of the curve. */
+  inline bool advanceSFCDigits(ChildI *cellDigits, LevI lev, RankI numChildren, RankI count)
+  {
+    for (LevI l = lev; l >= 1 && count > 0; l--)
+    {
+      const RankI sum = cellDigits[l] + count;
+      cellDigits[l] = sum % numChildren;
+      count = sum / numChildren;
+    }
+    return count == 0;
+  }
+}
+
+
+template <typename T, unsigned int D>
+void SFC_Search<T,D>::locateLeaves(
+    const CompressedTree<T,D> &cTree,
+    const TreeNode<T,D> *points, RankI numPoints,
+    std::vector<RankI> &outLeafRanks)
+{
+  constexpr char numChildren = TreeNode<T,D>::numChildren;
+  const unsigned int stride = m_uiMaxDepth + 1;
+
+  outLeafRanks.resize(numPoints);
+  if (cTree.samples.size() == 0)
+  {
+    std::fill(outLeafRanks.begin(), outLeafRanks.end(), notFound);
+    return;
+  }
+
+  // The SFC digits of every sample, computed once for the whole batch.
+  const RankI numSamples = cTree.samples.size();
+  std::vector<ChildI> sampleDigits(numSamples * stride);
+  for (RankI s = 0; s < numSamples; s++)
+  {
+    const TreeNode<T,D> &sample = cTree.samples[s].segStartSample;
+    getSFCDigits(sample, sample.getLevel(), &sampleDigits[s * stride]);
+  }
+
+  #pragma omp parallel
+  {
+    std::vector<ChildI> ptDigits(stride), cellDigits(stride);
+
+    #pragma omp for schedule(static)
+    for (RankI ptIdx = 0; ptIdx < numPoints; ptIdx++)
+    {
+      RankI &leafRank = outLeafRanks[ptIdx];
+      leafRank = notFound;
+
+      if (!getSFCDigits(points[ptIdx], m_uiMaxDepth, ptDigits.data()))
+        continue;
+
+      // Coarse: last sample whose segment start does not follow the point.
+      RankI sLo = 0, sHi = numSamples;
+      while (sLo < sHi)
+      {
+        const RankI sMid = sLo + (sHi - sLo) / 2;
+        const LevI sLev = cTree.samples[sMid].segStartSample.getLevel();
+        if (compareSFCDigits(ptDigits.data(), &sampleDigits[sMid * stride], sLev) >= 0)
+          sLo = sMid + 1;
+        else
+          sHi = sMid;
+      }
+      if (sLo == 0)
+        continue;   // Precedes the local range.
+
+      // Exact: step over level segments, keeping the first cell of the current segment.
+      const SegmentSample<T,D> &sample = cTree.samples[sLo - 1];
+      RankI segIdx = sample.segIdx;
+      LevI lev = sample.segStartSample.getLevel();
+      std::copy(&sampleDigits[(sLo-1) * stride], &sampleDigits[(sLo-1) * stride] + lev + 1, cellDigits.begin());
+      RankI segBegin = (segIdx > 0 ? cTree.segments[segIdx-1].endRank : cTree.startRank);
+
+      while (segIdx < cTree.segments.size())
+      {
+        const RankI segLength = cTree.segments[segIdx].endRank - segBegin;
+        const RankI offset = offsetSFCDigits(ptDigits.data(), cellDigits.data(), lev, numChildren, segLength);
+        if (offset < segLength)
+        {
+          leafRank = segBegin + offset;
+          break;
+        }
+
+        if (!advanceSFCDigits(cellDigits.data(), lev, numChildren, segLength))
+          break;
+        segBegin += segLength;
+        segIdx++;
+
+        // A complete tree continues with the first descendant (or an ancestor) of that cell.
+        if (segIdx < cTree.segments.size())
+        {
+          const LevI nextLev = cTree.segments[segIdx].lev;
+          for (LevI l = lev + 1; l <= nextLev; l++)
+            cellDigits[l] = 0;
+          lev = nextLev;
+        }
+      }
+    }
+  }
+}
+
+
+template <typename T, unsigned int D>
+void SFC_Search<T,D>::dist_locateOwners(
+    const CompressedTree<T,D> &localTree,
+    const TreeNode<T,D> *points, RankI numPoints,
+    std::vector<int> &outOwners,
+    MPI_Comm comm)
+{
+  int nProc, rProc;
+  MPI_Comm_rank(comm, &rProc);
+  MPI_Comm_size(comm, &nProc);
+
+  const unsigned int stride = m_uiMaxDepth + 1;
+
+  // Gather the front of every nonempty partition.
+  int isNonEmpty = (localTree.samples.size() > 0);
+  TreeNode<T,D> myFront = (isNonEmpty ? localTree.samples[0].segStartSample : TreeNode<T,D>());
+  std::vector<TreeNode<T,D>> fronts(nProc);
+  std::vector<int> nonEmpty(nProc);
+  par::Mpi_Allgather<TreeNode<T,D>>(&myFront, fronts.data(), 1, comm);
+  par::Mpi_Allgather<int>(&isNonEmpty, nonEmpty.data(), 1, comm);
+
+  std::vector<int> frontProc;
+  std::vector<ChildI> frontDigits;
+  for (int p = 0; p < nProc; p++)
+    if (nonEmpty[p])
+    {
+      frontProc.push_back(p);
+      frontDigits.resize(frontProc.size() * stride);
+      getSFCDigits(fronts[p], fronts[p].getLevel(), &frontDigits[(frontProc.size()-1) * stride]);
+    }
+
+  outOwners.resize(numPoints);
+
+  #pragma omp parallel
+  {
+    std::vector<ChildI> ptDigits(stride);
+
+    #pragma omp for schedule(static)
+    for (RankI ptIdx = 0; ptIdx < numPoints; ptIdx++)
+    {
+      outOwners[ptIdx] = -1;
+      if (!getSFCDigits(points[ptIdx], m_uiMaxDepth, ptDigits.data()))
+        continue;
+
+      // Last partition whose front does not follow the point.
+      size_t lo = 0, hi = frontProc.size();
+      while (lo < hi)
+      {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (compareSFCDigits(ptDigits.data(), &frontDigits[mid * stride], fronts[frontProc[mid]].getLevel()) >= 0)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      if (lo > 0)
+        outOwners[ptIdx] = frontProc[lo - 1];
+    }
+  }
+}
+
+
 }  // namespace ot
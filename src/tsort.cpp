@@ -11,6 +11,11 @@
 
 #include "tsort.h"
 #include "octUtils.h"
+#include "profRegistry.h"
+
+#include <omp.h>
+#include <cstdio>
+#include <numeric>
 
 
 namespace ot
@@ -88,7 +93,7 @@ SFC_Tree<T,D>:: SFC_bucketing(TreeNode<T,D> *points,
 ///   // Logically permute: Scan the bucket-counts in the order of the SFC.
 ///   // Since we want to map [SFC_rank]-->Morton_rank,
 ///   // use the "left" columns of rotations[], aka `rot_perm'.
-///   const ChildI *rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
+///   const ChildI *rot_perm = SFC_Tables<D>::rotPerm(pRot);
 ///   ChildI child_sfc = 0;
 ///   for ( ; child_sfc < numChildren; child_sfc++)
 ///   {
@@ -152,7 +157,6 @@ SFC_Tree<T,D>:: SFC_locateBuckets(const TreeNode<T,D> *points,
 
   using TreeNode = TreeNode<T,D>;
   constexpr char numChildren = TreeNode::numChildren;
-  constexpr char rotOffset = 2*numChildren;  // num columns in rotations[].
 
   //
   // Count the number of points in each bucket,
@@ -184,7 +188,7 @@ SFC_Tree<T,D>:: SFC_locateBuckets(const TreeNode<T,D> *points,
   // Logically permute: Scan the bucket-counts in the order of the SFC.
   // Since we want to map [SFC_rank]-->Morton_rank,
   // use the "left" columns of rotations[], aka `rot_perm'.
-  const ChildI *rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
+  const ChildI *rot_perm = SFC_Tables<D>::rotPerm(pRot);
   ChildI child_sfc = 0;
   for ( ; child_sfc < numChildren; child_sfc++)
   {
@@ -204,6 +208,8 @@ SFC_Tree<T,D>:: distTreeSort(std::vector<TreeNode<T,D>> &points,
                           double loadFlexibility,
                           MPI_Comm comm)
 {
+  DENDRO_PROF_SCOPE("distTreeSort");
+
   int nProc, rProc;
   MPI_Comm_rank(comm, &rProc);
   MPI_Comm_size(comm, &nProc);
@@ -247,6 +253,8 @@ SFC_Tree<T,D>:: distTreePartition(std::vector<TreeNode<T,D>> &points,
   // The second approach is used in Dendro4 par::sfcTreeSort(), so
   // I'm going to assume that linear aux storage is not too much to ask.
 
+  DENDRO_PROF_SCOPE("distTreePartition");
+
   int nProc, rProc;
   MPI_Comm_rank(comm, &rProc);
   MPI_Comm_size(comm, &nProc);
@@ -259,7 +267,6 @@ SFC_Tree<T,D>:: distTreePartition(std::vector<TreeNode<T,D>> &points,
 
   using TreeNode = TreeNode<T,D>;
   constexpr char numChildren = TreeNode::numChildren;
-  constexpr char rotOffset = 2*numChildren;  // num columns in rotations[].
 
   // The outcome of the BFT will be a list of splitters, i.e. refined buckets.
   // As long as there are `pending splitters', we will refine their corresponding buckets.
@@ -339,6 +346,7 @@ SFC_Tree<T,D>:: distTreePartition(std::vector<TreeNode<T,D>> &points,
 
   while(!splitBucketIndex.empty())
   {
+      DENDRO_PROF_SCOPE("partitionRound");
       BarrierQueue<BucketInfo<RankI>> newBftQueue;
       BarrierQueue<BucketInfo<RankI>> newBftMergedQueue;
 
@@ -492,10 +500,13 @@ SFC_Tree<T,D>:: distTreePartition(std::vector<TreeNode<T,D>> &points,
   if (sizeNew > sizeL)
     points.resize(sizeNew);
 
+  DENDRO_PROF_BEGIN("Alltoallv");
+  DENDRO_PROF_BYTES(sizeof(TreeNode) * (sizeL - sendCnt[rProc]));
   par::Mpi_Alltoallv<TreeNode>(
       &(*origPoints.begin()), (int*) &(*sendCnt.begin()), (int*) &(*sendDspl.begin()),
       &(*points.begin()), (int*) &(*recvCnt.begin()), (int*) &(*recvDspl.begin()),
       comm);
+  DENDRO_PROF_END();
 
   points.resize(sizeNew);
 
@@ -520,7 +531,6 @@ SFC_Tree<T,D>:: treeBFTNextLevel(TreeNode<T,D> *points,
 
   using TreeNode = TreeNode<T,D>;
   constexpr char numChildren = TreeNode::numChildren;
-  constexpr char rotOffset = 2*numChildren;  // num columns in rotations[].
 
   while (bftQueue[0].lev == startLev)
   {
@@ -548,12 +558,13 @@ SFC_Tree<T,D>:: treeBFTNextLevel(TreeNode<T,D> *points,
     }
 
     // Enqueue our children in the next level.
-    const ChildI * const rot_perm = &rotations[front.rot_id*rotOffset + 0*numChildren];
-    const RotI * const orientLookup = &HILBERT_TABLE[front.rot_id*numChildren];
+    const ChildI * const rot_perm = SFC_Tables<D>::rotPerm(front.rot_id);
+    const RotI * const orientLookup = SFC_Tables<D>::orientLookup(front.rot_id);
     for (char child_sfc = 0; child_sfc < numChildren; child_sfc++)
     {
       ChildI child = rot_perm[child_sfc];
-      RotI cRot = orientLookup[child];
+      // Level 0 keeps its rotation for level 1, as in locTreeSort().
+      RotI cRot = (front.lev > 0 ? orientLookup[child] : front.rot_id);
       BucketInfo<RankI> childBucket =
           {cRot, front.lev+1, childSplitters[child_sfc+0], childSplitters[child_sfc+1]};
 
@@ -576,13 +587,34 @@ SFC_Tree<T,D>:: locTreeConstruction(TreeNode<T,D> *points,
                                   LevI eLev,
                                   RotI pRot,
                                   TreeNode<T,D> pNode)
+{
+  if (end <= begin) { return; }
+
+  #pragma omp parallel if (!omp_in_parallel() && (end - begin) >= locTreeConstruction_taskGrain)
+  #pragma omp single
+  locTreeConstruction_impl(points, tree, maxPtsPerRegion, begin, end, sLev, eLev, pRot, pNode);
+}
+
+
+//
+// locTreeConstruction_impl()
+//
+template <typename T, unsigned int D>
+void
+SFC_Tree<T,D>:: locTreeConstruction_impl(TreeNode<T,D> *points,
+                                  std::vector<TreeNode<T,D>> &tree,
+                                  RankI maxPtsPerRegion,
+                                  RankI begin, RankI end,
+                                  LevI sLev,
+                                  LevI eLev,
+                                  RotI pRot,
+                                  TreeNode<T,D> pNode)
 {
   // Most of this code is copied from locTreeSort().
 
   if (end <= begin) { return; }
 
   constexpr char numChildren = TreeNode<T,D>::numChildren;
-  constexpr unsigned int rotOffset = 2*numChildren;  // num columns in rotations[].
 
   using TreeNode = TreeNode<T,D>;
 
@@ -594,13 +626,20 @@ SFC_Tree<T,D>:: locTreeConstruction(TreeNode<T,D> *points,
   // beginning, middles, and end of the range of children, and ancestors are in front.
 
   // Lookup tables to apply rotations.
-  const ChildI * const rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-  const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+  const ChildI * const rot_perm = SFC_Tables<D>::rotPerm(pRot);
+  const RotI * const orientLookup = SFC_Tables<D>::orientLookup(pRot);
 
   TreeNode cNode = pNode.getFirstChildMorton();
 
   if (sLev < eLev)  // This means eLev is further from the root level than sLev.
   {
+    // Subtrees built by tasks, and where they belong in `tree'.
+    std::array<std::vector<TreeNode>, numChildren> taskTrees;
+    std::array<size_t, numChildren> taskTreePos;
+    std::array<bool, numChildren> isTask;
+    isTask.fill(false);
+    bool anyTasks = false;
+
     // We satisfy the completeness property because we iterate over
     // all possible children here. For each child, append either
     // a leaf orthant or a non-empty complete subtree.
@@ -614,11 +653,29 @@ SFC_Tree<T,D>:: locTreeConstruction(TreeNode<T,D> *points,
       RotI cRot = orientLookup[child];
       cNode.setMortonIndex(child);
 
-      if (tempSplitters[child_sfc+1] - tempSplitters[child_sfc+0] > maxPtsPerRegion)
+      const RankI childSz = tempSplitters[child_sfc+1] - tempSplitters[child_sfc+0];
+
+      if (childSz >= locTreeConstruction_taskGrain && childSz > maxPtsPerRegion)
+      {
+        // Build the sub-tree on the side and splice it in later.
+        // The point ranges of siblings are disjoint.
+        taskTreePos[child_sfc] = tree.size();
+        isTask[child_sfc] = true;
+        anyTasks = true;
+
+        #pragma omp task default(shared) firstprivate(child_sfc, cRot, cNode)
+        locTreeConstruction_impl(
+            points, taskTrees[child_sfc], maxPtsPerRegion,
+            tempSplitters[child_sfc+0], tempSplitters[child_sfc+1],
+            sLev+1, eLev,
+            cRot,
+            cNode);
+      }
+      else if (childSz > maxPtsPerRegion)
       {
         // Recursively build a complete sub-tree out of this bucket's points.
         // Use the splitters to specify ranges for the next level of recursion.
-        locTreeConstruction(
+        locTreeConstruction_impl(
             points, tree, maxPtsPerRegion,
             tempSplitters[child_sfc+0], tempSplitters[child_sfc+1],
             sLev+1, eLev,
@@ -631,6 +688,32 @@ SFC_Tree<T,D>:: locTreeConstruction(TreeNode<T,D> *points,
         tree.push_back(cNode);
       }
     }
+
+    if (anyTasks)
+    {
+      #pragma omp taskwait
+
+      // Splice the task subtrees in SFC order, from the back,
+      // so that each inline segment is moved exactly once.
+      size_t numSpliced = 0;
+      for (char child_sfc = 0; child_sfc < numChildren; child_sfc++)
+        numSpliced += taskTrees[child_sfc].size();
+
+      size_t srcEnd = tree.size();
+      size_t dstEnd = tree.size() + numSpliced;
+      tree.resize(dstEnd);
+      for (int child_sfc = numChildren - 1; child_sfc >= 0; child_sfc--)
+      {
+        if (!isTask[child_sfc])
+          continue;
+
+        const size_t pos = taskTreePos[child_sfc];
+        std::move_backward(tree.begin() + pos, tree.begin() + srcEnd, tree.begin() + dstEnd);
+        dstEnd -= (srcEnd - pos) + taskTrees[child_sfc].size();
+        std::copy(taskTrees[child_sfc].begin(), taskTrees[child_sfc].end(), tree.begin() + dstEnd);
+        srcEnd = pos;
+      }
+    }
   }
   else   // We have reached eLev. Violate `maxPtsPerRegion' to satisfy completeness.
   {
@@ -653,6 +736,8 @@ SFC_Tree<T,D>:: distTreeConstruction(std::vector<TreeNode<T,D>> &points,
                                    double loadFlexibility,
                                    MPI_Comm comm)
 {
+  DENDRO_PROF_SCOPE("distTreeConstruction");
+
   int nProc, rProc;
   MPI_Comm_rank(comm, &rProc);
   MPI_Comm_size(comm, &nProc);
@@ -715,6 +800,460 @@ SFC_Tree<T,D>:: distTreeConstruction(std::vector<TreeNode<T,D>> &points,
 }
 
 
+//
+// RoundSpill
+//   Points of the streaming distTreeConstruction(), bucketed by round and
+//   spilled in blocks to a temporary file, so that each round reads back
+//   only its own points. There is no fallback to memory, which would break
+//   the memory bound; failures are recorded in m_failed.
+//
+template <typename TN>
+struct RoundSpill
+{
+  struct Block { long offset; RankI size; };
+
+  FILE *m_file;
+  bool m_failed;
+  RankI m_blockSize;
+  long m_numSpilled;
+  std::vector<std::vector<TN>> m_buffers;    // Partial block of each round.
+  std::vector<std::vector<Block>> m_blocks;  // Spilled blocks of each round.
+
+  // The partial blocks hold fewer than numRounds * blockSize points together.
+  RoundSpill(int numRounds, RankI blockSize)
+    : m_file(std::tmpfile()), m_blockSize(std::max<RankI>(blockSize, 1)), m_numSpilled(0),
+      m_buffers(numRounds), m_blocks(numRounds)
+  {
+    m_failed = (m_file == NULL);
+    if (m_failed)
+      std::cout << "Error: RoundSpill: cannot create a temporary file.\n";
+  }
+
+  ~RoundSpill() { if (m_file != NULL) std::fclose(m_file); }
+
+  void push(int round, const TN &pt)
+  {
+    m_buffers[round].push_back(pt);
+    if (m_buffers[round].size() >= m_blockSize)
+      flush(round);
+  }
+
+  void flush(int round)
+  {
+    std::vector<TN> &buffer = m_buffers[round];
+    if (buffer.empty() || m_failed)
+    {
+      buffer.clear();
+      return;
+    }
+    std::fseek(m_file, 0, SEEK_END);
+    if (std::fwrite(buffer.data(), sizeof(TN), buffer.size(), m_file) != buffer.size())
+    {
+      std::cout << "Error: RoundSpill: short write to the temporary file.\n";
+      m_failed = true;
+    }
+    m_blocks[round].push_back({m_numSpilled, (RankI) buffer.size()});
+    m_numSpilled += buffer.size();
+    buffer.clear();
+  }
+
+  void flushAll()
+  {
+    for (int round = 0; round < (int) m_buffers.size(); round++)
+      flush(round);
+  }
+
+  // Reads whole blocks of the round, starting from `nextBlock', up to
+  // maxPoints points (at least one block). Returns how many points were read.
+  RankI read(int round, size_t &nextBlock, std::vector<TN> &out, RankI maxPoints)
+  {
+    const std::vector<Block> &blocks = m_blocks[round];
+    out.clear();
+    while (!m_failed && nextBlock < blocks.size() && (out.empty() || out.size() + blocks[nextBlock].size <= maxPoints))
+    {
+      const Block &block = blocks[nextBlock++];
+      const size_t pos = out.size();
+      out.resize(pos + block.size);
+      std::fseek(m_file, block.offset * (long) sizeof(TN), SEEK_SET);
+      if (std::fread(&out[pos], sizeof(TN), block.size, m_file) != block.size)
+      {
+        std::cout << "Error: RoundSpill: short read from the temporary file.\n";
+        m_failed = true;
+        out.clear();
+      }
+    }
+    return out.size();
+  }
+};
+
+
+//
+// distTreeConstruction() (streaming)
+//
+template <typename T, unsigned int D>
+int
+SFC_Tree<T,D>:: distTreeConstruction(PointStream<T,D> &stream,
+                                   std::vector<TreeNode<T,D>> &tree,
+                                   RankI maxPtsPerRegion,
+                                   RankI chunkSize,
+                                   MPI_Comm comm)
+{
+  using TreeNode = TreeNode<T,D>;
+  constexpr char numChildren = TreeNode::numChildren;
+  const MPI_Datatype rankType = par::Mpi_datatype<RankI>::value();
+
+  DENDRO_PROF_SCOPE("distTreeConstruction");
+
+  int nProc, rProc;
+  MPI_Comm_rank(comm, &rProc);
+  MPI_Comm_size(comm, &nProc);
+
+  tree.clear();
+  chunkSize = std::max<RankI>(chunkSize, 1);
+
+  std::vector<TreeNode> chunk(chunkSize);
+  std::vector<RankI> chunkCells(chunkSize);
+
+  // Coarse complete tree in SFC order, with the SFC orientation of each cell.
+  // Replicated, since every process locates its points in it.
+  std::vector<TreeNode> cells(1, TreeNode());
+  std::vector<RotI> cellRots(1, 0);
+
+  // The cell containing each point is the last cell that does not come after it.
+  const auto locateCells = [&](const TreeNode *points, RankI numPoints)
+  {
+    #pragma omp parallel for
+    for (RankI ii = 0; ii < numPoints; ii++)
+      chunkCells[ii] = (std::upper_bound(cells.begin(), cells.end(), points[ii]) - cells.begin()) - 1;
+  };
+
+  // The histogram is reduced in slices: process r holds the global
+  // counts of cells [sliceBegin[r], sliceBegin[r] + sliceSize[r]).
+  std::vector<RankI> cellCountsL, sliceCounts;
+  std::vector<int> sliceSize(nProc), sliceBegin(nProc);
+  const auto splitSlices = [&]()
+  {
+    for (int r = 0; r < nProc; r++)
+    {
+      sliceBegin[r] = (int) (cells.size() * r / nProc);
+      sliceSize[r] = (int) (cells.size() * (r+1) / nProc) - sliceBegin[r];
+    }
+  };
+
+  //
+  // Pass 1 (repeated): Refine the coarse tree until every cell fits in the bound.
+  //
+  RankI totalPoints = 0;
+  RankI cellLimit = 0;
+  bool refined = true;
+  while (refined)
+  {
+    splitSlices();
+    cellCountsL.assign(cells.size(), 0);
+    sliceCounts.resize(sliceSize[rProc]);
+
+    stream.rewind();
+    RankI numRead;
+    while ((numRead = stream.read(&(*chunk.begin()), chunkSize)) > 0)
+    {
+      locateCells(chunk.data(), numRead);
+      for (RankI ii = 0; ii < numRead; ii++)
+        cellCountsL[chunkCells[ii]]++;
+    }
+    MPI_Reduce_scatter(cellCountsL.data(), sliceCounts.data(), sliceSize.data(), rankType, MPI_SUM, comm);
+
+    if (cells.size() == 1)
+    {
+      RankI sliceTotal = std::accumulate(sliceCounts.begin(), sliceCounts.end(), RankI(0));
+      par::Mpi_Allreduce<RankI>(&sliceTotal, &totalPoints, 1, MPI_SUM, comm);
+      cellLimit = std::max<RankI>(maxPtsPerRegion,
+          std::min<RankI>(chunkSize, std::max<RankI>(1, totalPoints / (4*nProc))));
+    }
+
+    // Each process decides for its slice; only the decisions are replicated.
+    // The root is always split, as in distTreeConstruction().
+    std::vector<char> sliceSplit(sliceSize[rProc]), split(cells.size());
+    for (int ii = 0; ii < sliceSize[rProc]; ii++)
+    {
+      const TreeNode &cell = cells[sliceBegin[rProc] + ii];
+      sliceSplit[ii] = (sliceCounts[ii] > cellLimit || cell.getLevel() == 0) && cell.getLevel() < m_uiMaxDepth;
+    }
+    MPI_Allgatherv(sliceSplit.data(), sliceSize[rProc], MPI_CHAR,
+                   split.data(), sliceSize.data(), sliceBegin.data(), MPI_CHAR, comm);
+
+    std::vector<TreeNode> newCells;
+    std::vector<RotI> newRots;
+    refined = false;
+    for (size_t c = 0; c < cells.size(); c++)
+    {
+      if (split[c])
+      {
+        const ChildI * const rot_perm = SFC_Tables<D>::rotPerm(cellRots[c]);
+        const RotI * const orientLookup = SFC_Tables<D>::orientLookup(cellRots[c]);
+        TreeNode cNode = cells[c].getFirstChildMorton();
+        for (char child_sfc = 0; child_sfc < numChildren; child_sfc++)
+        {
+          ChildI child = rot_perm[child_sfc];
+          cNode.setMortonIndex(child);
+          newCells.push_back(cNode);
+          newRots.push_back(orientLookup[child]);
+        }
+        refined = true;
+      }
+      else
+      {
+        newCells.push_back(cells[c]);
+        newRots.push_back(cellRots[c]);
+      }
+    }
+    if (refined)
+    {
+      cells.swap(newCells);
+      cellRots.swap(newRots);
+    }
+  }
+
+  //
+  // Each process owns a contiguous range of cells, balanced by points:
+  // process r owns cells [ownerBegin[r], ownerBegin[r+1]).
+  //
+  std::vector<RankI> ownerBegin(nProc + 1, 0);
+  {
+    RankI sliceTotal = std::accumulate(sliceCounts.begin(), sliceCounts.end(), RankI(0));
+    RankI scan = 0;
+    par::Mpi_Scan<RankI>(&sliceTotal, &scan, 1, MPI_SUM, comm);
+    scan -= sliceTotal;
+
+    std::vector<RankI> ownerCellsL(nProc, 0), ownerCellsG(nProc, 0);
+    for (int ii = 0; ii < sliceSize[rProc]; ii++)
+    {
+      const double mid = scan + 0.5 * sliceCounts[ii];
+      ownerCellsL[totalPoints > 0 ? std::min(nProc - 1, (int) (mid * nProc / totalPoints)) : 0]++;
+      scan += sliceCounts[ii];
+    }
+    par::Mpi_Allreduce<RankI>(ownerCellsL.data(), ownerCellsG.data(), nProc, MPI_SUM, comm);
+    for (int r = 0; r < nProc; r++)
+      ownerBegin[r+1] = ownerBegin[r] + ownerCellsG[r];
+  }
+
+  // The owner collects the counts of its cells from the overlapping slices.
+  const RankI ownBegin = ownerBegin[rProc], ownEnd = ownerBegin[rProc+1];
+  std::vector<RankI> ownCounts(ownEnd - ownBegin);
+  {
+    std::vector<MPI_Request> requests;
+    for (int r = 0; r < nProc; r++)
+    {
+      const RankI rSliceBegin = sliceBegin[r], rSliceEnd = sliceBegin[r] + sliceSize[r];
+      const RankI recvBegin = std::max(ownBegin, rSliceBegin), recvEnd = std::min(ownEnd, rSliceEnd);
+      const RankI sendBegin = std::max(ownerBegin[r], (RankI) sliceBegin[rProc]);
+      const RankI sendEnd = std::min(ownerBegin[r+1], (RankI) sliceBegin[rProc] + sliceSize[rProc]);
+
+      if (r == rProc && recvBegin < recvEnd)
+        std::copy(sliceCounts.begin() + (recvBegin - rSliceBegin), sliceCounts.begin() + (recvEnd - rSliceBegin),
+                  ownCounts.begin() + (recvBegin - ownBegin));
+      else
+      {
+        if (recvBegin < recvEnd)
+        {
+          requests.emplace_back();
+          par::Mpi_Irecv<RankI>(&ownCounts[recvBegin - ownBegin], (int) (recvEnd - recvBegin), r, 0, comm, &requests.back());
+        }
+        if (sendBegin < sendEnd)
+        {
+          requests.emplace_back();
+          par::Mpi_Isend<RankI>(&sliceCounts[sendBegin - sliceBegin[rProc]], (int) (sendEnd - sendBegin), r, 0, comm, &requests.back());
+        }
+      }
+    }
+    MPI_Waitall((int) requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+  }
+
+  // The owner processes its cells in batches of at most chunkSize points.
+  // The first cell of every batch is replicated, to route points to batches.
+  std::vector<RankI> ownBatchBegin;
+  {
+    RankI batchLoad = 0;
+    for (RankI c = ownBegin; c < ownEnd; c++)
+    {
+      const RankI count = ownCounts[c - ownBegin];
+      if (c == ownBegin || (batchLoad > 0 && batchLoad + count > chunkSize))
+      {
+        ownBatchBegin.push_back(c);
+        batchLoad = 0;
+      }
+      batchLoad += count;
+    }
+  }
+
+  int numOwnBatches = (int) ownBatchBegin.size();
+  std::vector<int> numBatches(nProc), batchDispl(nProc + 1, 0);
+  par::Mpi_Allgather<int>(&numOwnBatches, numBatches.data(), 1, comm);
+  for (int r = 0; r < nProc; r++)
+    batchDispl[r+1] = batchDispl[r] + numBatches[r];
+
+  std::vector<RankI> batchBegin(batchDispl[nProc]);
+  par::Mpi_Allgatherv<RankI>(ownBatchBegin.data(), numOwnBatches,
+                             batchBegin.data(), numBatches.data(), batchDispl.data(), comm);
+
+  int numRounds = *std::max_element(numBatches.begin(), numBatches.end());
+  std::vector<int> batchOwner(batchBegin.size()), batchRound(batchBegin.size());
+  for (int r = 0; r < nProc; r++)
+    for (int b = batchDispl[r]; b < batchDispl[r+1]; b++)
+    {
+      batchOwner[b] = r;
+      batchRound[b] = b - batchDispl[r];
+    }
+
+  const auto locateBatches = [&](RankI numPoints)
+  {
+    #pragma omp parallel for
+    for (RankI ii = 0; ii < numPoints; ii++)
+      chunkCells[ii] = (std::upper_bound(batchBegin.begin(), batchBegin.end(), chunkCells[ii]) - batchBegin.begin()) - 1;
+  };
+
+  //
+  // Pass 2 (once): Bucket the points by round and spill them, so that
+  // each round reads back only its own points.
+  //
+  // Blocks are at most chunkSize / numRounds points, so the partial blocks of all
+  // rounds fit in chunkSize points; with more rounds than that, points go straight out.
+  RoundSpill<TreeNode> spill(numRounds, chunkSize / std::max(numRounds, 1));
+  {
+    stream.rewind();
+    RankI numRead;
+    while (!spill.m_failed && (numRead = stream.read(&(*chunk.begin()), chunkSize)) > 0)
+    {
+      locateCells(chunk.data(), numRead);
+      locateBatches(numRead);
+      for (RankI ii = 0; ii < numRead; ii++)
+        spill.push(batchRound[chunkCells[ii]], chunk[ii]);
+    }
+    spill.flushAll();
+  }
+
+  //
+  // One round per batch. Send the points of the round to their owners,
+  // chunk by chunk, with sparse exchanges, then build the subtrees.
+  //
+  std::vector<TreeNode> owned, roundPts, sendBuf;
+  std::vector<int> sendProc, recvProc;
+  std::vector<RankI> sendCounts, recvCounts;
+  std::vector<RankI> order;
+  std::vector<MPI_Request> requests;
+  for (int round = 0; round < numRounds; round++)
+  {
+    owned.clear();
+    size_t nextBlock = 0;
+    while (true)
+    {
+      const RankI numRead = spill.read(round, nextBlock, roundPts, chunkSize);
+
+      // Every process takes part in each exchange until all are done with the round.
+      // A spill failure on any process ends the construction on all of them.
+      int status[2] = {(numRead > 0), spill.m_failed}, statusG[2] = {0, 0};
+      par::Mpi_Allreduce<int>(status, statusG, 2, MPI_MAX, comm);
+      if (statusG[1])
+      {
+        tree.clear();
+        return 1;
+      }
+      if (!statusG[0])
+        break;
+
+      locateCells(roundPts.data(), numRead);
+      locateBatches(numRead);
+      order.resize(numRead);
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+          [&](RankI a, RankI b) { return batchOwner[chunkCells[a]] < batchOwner[chunkCells[b]]; });
+
+      // Our own points stay; the rest go out grouped by owner.
+      sendProc.clear();
+      sendCounts.clear();
+      sendBuf.clear();
+      for (RankI ii = 0; ii < numRead; ii++)
+      {
+        const int owner = batchOwner[chunkCells[order[ii]]];
+        if (owner == rProc)
+          owned.push_back(roundPts[order[ii]]);
+        else
+        {
+          if (sendProc.empty() || sendProc.back() != owner)
+          {
+            sendProc.push_back(owner);
+            sendCounts.push_back(0);
+          }
+          sendCounts.back()++;
+          sendBuf.push_back(roundPts[order[ii]]);
+        }
+      }
+
+      // Tag 1 keeps the counts apart from the points (tag 0) that follow.
+      par::Mpi_Alltoall_NBX<RankI>(sendProc.data(), sendCounts.data(), (int) sendProc.size(),
+                                   recvProc, recvCounts, 1, comm);
+
+      DENDRO_PROF_BEGIN("pointExchange");
+      DENDRO_PROF_BYTES(sizeof(TreeNode) * sendBuf.size());
+      requests.resize(sendProc.size() + recvProc.size());
+      RankI offset = owned.size();
+      owned.resize(owned.size() + std::accumulate(recvCounts.begin(), recvCounts.end(), RankI(0)));
+      for (size_t r = 0; r < recvProc.size(); r++)
+      {
+        par::Mpi_Irecv<TreeNode>(&owned[offset], (int) recvCounts[r], recvProc[r], 0, comm, &requests[r]);
+        offset += recvCounts[r];
+      }
+      offset = 0;
+      for (size_t s = 0; s < sendProc.size(); s++)
+      {
+        par::Mpi_Isend<TreeNode>(&sendBuf[offset], (int) sendCounts[s], sendProc[s], 0, comm, &requests[recvProc.size() + s]);
+        offset += sendCounts[s];
+      }
+      MPI_Waitall((int) requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+      DENDRO_PROF_END();
+    }
+
+    if (round >= numOwnBatches)
+      continue;
+
+    // The cells of this batch are contiguous. Group the points by cell.
+    const size_t batchCellBegin = ownBatchBegin[round];
+    const size_t batchCellEnd = (round + 1 < numOwnBatches ? ownBatchBegin[round + 1] : ownEnd);
+
+    std::vector<RankI> ownedCells(owned.size());
+    for (size_t ii = 0; ii < owned.size(); ii++)
+      ownedCells[ii] = (std::upper_bound(cells.begin() + batchCellBegin, cells.begin() + batchCellEnd, owned[ii])
+                        - cells.begin()) - 1 - batchCellBegin;
+
+    std::vector<RankI> cellOffsets(batchCellEnd - batchCellBegin + 1, 0);
+    for (RankI c : ownedCells)
+      cellOffsets[c+1]++;
+    for (size_t c = 1; c < cellOffsets.size(); c++)
+      cellOffsets[c] += cellOffsets[c-1];
+
+    std::vector<TreeNode> grouped(owned.size());
+    std::vector<RankI> cellPos(cellOffsets.begin(), cellOffsets.end() - 1);
+    for (size_t ii = 0; ii < owned.size(); ii++)
+      grouped[cellPos[ownedCells[ii]]++] = owned[ii];
+    owned.clear();
+
+    for (size_t c = batchCellBegin; c < batchCellEnd; c++)
+    {
+      const RankI begin = cellOffsets[c - batchCellBegin];
+      const RankI end = cellOffsets[c - batchCellBegin + 1];
+      if (end - begin <= maxPtsPerRegion || cells[c].getLevel() >= m_uiMaxDepth)
+        tree.push_back(cells[c]);
+      else
+        locTreeConstruction(&(*grouped.begin()), tree, maxPtsPerRegion,
+                            begin, end,
+                            cells[c].getLevel() + 1, m_uiMaxDepth,
+                            cellRots[c], cells[c]);
+    }
+  }
+
+  return 0;
+}
+
+
 template <typename T, unsigned int D>
 void
 SFC_Tree<T,D>:: locRemoveDuplicates(std::vector<TreeNode<T,D>> &tnodes)
@@ -865,6 +1404,8 @@ SFC_Tree<T,D>:: distTreeBalancing(std::vector<TreeNode<T,D>> &points,
                                    double loadFlexibility,
                                    MPI_Comm comm)
 {
+  DENDRO_PROF_SCOPE("distTreeBalancing");
+
   int nProc, rProc;
   MPI_Comm_rank(comm, &rProc);
   MPI_Comm_size(comm, &nProc);
@@ -927,10 +1468,9 @@ SFC_Tree<T,D>:: getContainingBlocks(TreeNode<T,D> *points,
   // If a bucket contains points and splitters, divide and conquer by refining the bucket and recursing.
   // In an ancestor or leaf bucket, contained splitters and points are equal, so splitter <= point.
   constexpr ChildI numChildren = TreeNode<T,D>::numChildren;
-  constexpr char rotOffset = 2*numChildren;  // num columns in rotations[].
-  const ChildI *rot_perm = &rotations[pRot*rotOffset + 0*numChildren];
-  const ChildI *rot_inv = &rotations[pRot*rotOffset + 1*numChildren];
-  const RotI * const orientLookup = &HILBERT_TABLE[pRot*numChildren];
+  const ChildI *rot_perm = SFC_Tables<D>::rotPerm(pRot);
+  const ChildI *rot_inv = SFC_Tables<D>::rotInv(pRot);
+  const RotI * const orientLookup = SFC_Tables<D>::orientLookup(pRot);
 
   // Bucket points.
   std::array<RankI, 1+numChildren> pointBuckets;
@@ -0,0 +1,167 @@
+/*
+ * testActiveComm.cpp
+ *   Test a DA shrunk onto fewer active procs than the global comm (grainSz):
+ *   the active comm, ghost reads on it, and activeToFullNodalVec() /
+ *   fullToActiveNodalVec() between the active and the full layouts.
+ *   The grain size is also passed on rank 0 only (the DA reduces it), and an
+ *   empty tree must give an empty DA.
+ *   Run with more procs than the number of active procs (np >= 3).
+ */
+
+#include "oda.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <vector>
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+
+
+//------------------------
+// test_activeComm()
+//------------------------
+template <unsigned int dim>
+int test_activeComm(unsigned int numPts, unsigned int numActive, bool rootGrainOnly, MPI_Comm comm)
+{
+  using T = unsigned int;
+  const unsigned int dof = 2;
+
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+
+  // Choose the grain size so that numActive procs stay active.
+  DendroIntL locEle = tree.size(), glbEle = 0;
+  par::Mpi_Allreduce<DendroIntL>(&locEle, &glbEle, 1, MPI_SUM, comm);
+  const unsigned int grainSz = (rank == 0 || !rootGrainOnly ? glbEle / numActive : 0);
+
+  ot::DA<dim> da(tree.data(), tree.size(), comm, 1, grainSz);
+
+  DendroIntL numFailed = 0;
+  numFailed += (da.getNpesAll() != (unsigned int) npes);
+  numFailed += (da.getNpesActive() != (da.isActive() ? numActive : 0));
+  numFailed += (da.isActive() != (rank < (int) numActive));
+  if (da.isActive())
+  {
+    int activeNpes;
+    MPI_Comm_size(da.getCommActive(), &activeNpes);
+    numFailed += (activeNpes != (int) numActive);
+    numFailed += (da.getRankActive() != (unsigned int) rank);
+  }
+  else
+    numFailed += (da.getLocalNodalSz() != 0);
+
+  // Ghost reads on the active comm; the inactive procs take part as no-ops.
+  auto func = [](const ot::TreeNode<T,dim> &tn, unsigned int v) {
+    double u = v + 1.0;
+    for (int d = 0; d < dim; d++)
+      u += (d + 1.0) * tn.getX(d);
+    return u;
+  };
+  std::vector<double> ghosted;
+  da.createVector(ghosted, false, true, dof);
+  std::fill(ghosted.begin(), ghosted.end(), -1.0);
+  const ot::TreeNode<T,dim> *tnCoords = da.getTNCoords();
+  for (size_t ii = da.getLocalNodeBegin(); ii < da.getLocalNodeBegin() + da.getLocalNodalSz(); ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      ghosted[dof * ii + v] = func(tnCoords[ii], v);
+  da.readFromGhostBegin(ghosted.data(), dof);
+  da.readFromGhostEnd(ghosted.data(), dof);
+  for (size_t ii = 0; ii < da.getTotalNodalSz(); ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      numFailed += (ghosted[dof * ii + v] != func(tnCoords[ii], v));
+
+  // Active layout -> full layout: every proc gets an even share of the global node order.
+  std::vector<double> active(dof * da.getLocalNodalSz());
+  for (size_t ii = 0; ii < da.getLocalNodalSz(); ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      active[dof * ii + v] = dof * (da.getGlobalRankBegin() + ii) + v;
+
+  double *full = NULL;
+  da.activeToFullNodalVec(active.data(), full, false, dof);
+  const DendroIntL globNodes = da.getGlobalNodeSz();
+  const DendroIntL fullBegin = (globNodes / npes) * rank + std::min<DendroIntL>(rank, globNodes % npes);
+  DendroIntL fullSz = da.getFullNodalSz(), globFullSz = 0;
+  par::Mpi_Allreduce<DendroIntL>(&fullSz, &globFullSz, 1, MPI_SUM, comm);
+  numFailed += (globFullSz != globNodes);
+  numFailed += (fullSz < globNodes / npes);
+  for (DendroIntL ii = 0; ii < fullSz; ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      numFailed += (full[dof * ii + v] != dof * (fullBegin + ii) + v);
+
+  // Full layout -> active layout, back to the original.
+  std::vector<double> roundTrip(dof * da.getLocalNodalSz(), -1.0);
+  double *roundTripPtr = roundTrip.data();
+  da.fullToActiveNodalVec(full, roundTripPtr, true, dof);
+  numFailed += (roundTrip != active);
+  delete [] full;
+
+  DendroIntL globFailed = 0;
+  par::Mpi_Allreduce<DendroIntL>(&numFailed, &globFailed, 1, MPI_SUM, comm);
+
+  if (!rank)
+  {
+    printf("dim %u: %lld elements, %u of %d procs active%s, %lld nodes, %s\n",
+        dim, (long long) glbEle, numActive, npes, (rootGrainOnly ? " (grain on rank 0)" : ""), (long long) globNodes,
+        (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+//------------------------
+// test_emptyTree()
+//------------------------
+template <unsigned int dim>
+int test_emptyTree(unsigned int grainSz, MPI_Comm comm)
+{
+  using T = unsigned int;
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::DA<dim> da(tree.data(), 0, comm, 1, grainSz);
+
+  int numFailed = 0, globFailed = 0;
+  numFailed += (da.getGlobalNodeSz() != 0);
+  numFailed += (da.getLocalNodalSz() != 0 || da.getTotalNodalSz() != 0);
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+
+  if (!rank)
+    printf("dim %u: empty tree, grainSz %u, %s\n", dim, grainSz, (globFailed ? "FAILED" : "succeeded"));
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int npes;
+  MPI_Comm_size(comm, &npes);
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(3);
+  numFailed += test_activeComm<3>(200, std::max(1, npes - 1), false, comm);
+  numFailed += test_activeComm<3>(200, std::max(1, npes / 2), false, comm);
+  numFailed += test_activeComm<3>(200, 1, false, comm);
+  numFailed += test_activeComm<3>(200, std::max(1, npes / 2), true, comm);
+  numFailed += test_emptyTree<3>(0, comm);
+  numFailed += test_emptyTree<3>(100, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
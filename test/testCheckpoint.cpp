@@ -0,0 +1,252 @@
+/*
+ * testCheckpoint.cpp
+ *   Test io::checkpoint: write a tree and a DA nodal vector to one shared file,
+ *   then restart on all procs and on half of the procs.
+ *   The file is written synchronously or with staged (asynchronous) sections.
+ *   The file is also checked through the memory-mapped views, on one proc.
+ */
+
+#include "checkpointIO.h"
+#include "checkpointView.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+#include "oda.h"
+
+#include <vector>
+#include <algorithm>
+#include <mpi.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+
+//------------------------
+// gatherTree()
+//   All TreeNodes of a distributed tree, on every proc, in SFC order.
+//   (Compared as sets: the partition and order are up to distTreeSort().)
+//------------------------
+template <typename T, unsigned int dim>
+std::vector<ot::TreeNode<T,dim>> gatherTree(const std::vector<ot::TreeNode<T,dim>> &tree, MPI_Comm comm)
+{
+  int npes;
+  MPI_Comm_size(comm, &npes);
+
+  int localBytes = tree.size() * sizeof(ot::TreeNode<T,dim>);
+  std::vector<int> counts(npes), displs(npes, 0);
+  par::Mpi_Allgather<int>(&localBytes, counts.data(), 1, comm);
+  for (int p = 1; p < npes; p++)
+    displs[p] = displs[p-1] + counts[p-1];
+
+  std::vector<ot::TreeNode<T,dim>> all((displs[npes-1] + counts[npes-1]) / sizeof(ot::TreeNode<T,dim>));
+  std::vector<char> local(localBytes);
+  if (localBytes)
+    memcpy(local.data(), tree.data(), localBytes);
+  par::Mpi_Allgatherv<char>(local.data(), localBytes, (char *) all.data(), counts.data(), displs.data(), comm);
+
+  ot::SFC_Tree<T,dim>::locTreeSort(all.data(), 0, all.size(), 1, m_uiMaxDepth, 0);
+  return all;
+}
+
+
+//------------------------
+// restart()
+//   Reads the checkpoint on comm and compares against the tree
+//   and the function the nodal vector was set by.
+//------------------------
+template <unsigned int dim>
+int restart(const char *fName, const std::vector<ot::TreeNode<unsigned int,dim>> &treeExpected, unsigned int order, unsigned int dof,
+            std::function<void(const double *, double *)> func, MPI_Comm comm)
+{
+  using T = unsigned int;
+  int numFailed = 0;
+
+  io::checkpoint::CheckpointFile file(fName, io::checkpoint::CheckpointFile::READ, comm);
+
+  std::vector<ot::TreeNode<T,dim>> tree;
+  numFailed += (io::checkpoint::readTree<T,dim>(file, tree) != 0);
+  numFailed += (gatherTree<T,dim>(tree, comm) != treeExpected);
+
+  ot::DA<dim> da(tree.data(), tree.size(), comm, order);
+
+  std::vector<double> vec, vecExpected;
+  da.createVector(vec, false, false, dof);
+  da.createVector(vecExpected, false, false, dof);
+  da.setVectorByFunction(vecExpected.data(), func, false, false, dof);
+
+  numFailed += (io::checkpoint::readNodalVec<dim,double>(file, da, vec.data(), dof) != 0);
+  numFailed += (vec != vecExpected);
+
+  int globFailed = 0;
+  par::Mpi_Allreduce<int>(&numFailed, &globFailed, 1, MPI_SUM, comm);
+  return globFailed;
+}
+
+
+//------------------------
+// view()
+//   Checks the file through CheckpointMap, serially.
+//------------------------
+template <unsigned int dim>
+int view(const char *fName, const std::vector<ot::TreeNode<unsigned int,dim>> &treeExpected, unsigned int dof,
+         DendroIntL numNodesExpected, std::function<void(const double *, double *)> func)
+{
+  using T = unsigned int;
+  int numFailed = 0;
+
+  io::checkpoint::CheckpointMap map(fName);
+  numFailed += (map.getNumSections() != 2);
+  map.advise(io::checkpoint::CheckpointMap::SEQUENTIAL);
+
+  const io::checkpoint::TreeView<T,dim> tree(map, map.findSection(io::checkpoint::SECTION_TREE, "tree"));
+  numFailed += !tree.isValid();
+  numFailed += !std::equal(tree.begin(), tree.end(), treeExpected.begin()) || tree.size() != treeExpected.size();
+
+  // Leaves overlapping the parent of a leaf, or a descendant of it.
+  for (size_t ii = 0; ii < treeExpected.size(); ii += 1 + treeExpected.size() / 7)
+  {
+    const ot::TreeNode<T,dim> leaf = treeExpected[ii];
+    const ot::TreeNode<T,dim> regions[2] = {(leaf.getLevel() > 0 ? leaf.getParent() : leaf),
+                                            (leaf.getLevel() < m_uiMaxDepth ? leaf.getFirstChildMorton() : leaf)};
+    for (const ot::TreeNode<T,dim> &region : regions)
+    {
+      const std::pair<size_t, size_t> range = tree.overlapping(region);
+      size_t first = treeExpected.size(), last = 0;
+      for (size_t jj = 0; jj < treeExpected.size(); jj++)
+        if (treeExpected[jj] == region || region.isAncestor(treeExpected[jj]) || treeExpected[jj].isAncestor(region))
+        {
+          first = std::min(first, jj);
+          last = jj + 1;
+        }
+      numFailed += (range != std::make_pair(first, last));
+    }
+  }
+
+  const io::checkpoint::NodalVecView<dim,double> nodes(map, map.findSection(io::checkpoint::SECTION_NODAL_VEC, "u"));
+  numFailed += !nodes.isValid() || nodes.getDof() != dof || (DendroIntL) nodes.size() != numNodesExpected;
+
+  // Same evaluation as DA::setVectorByFunction().
+  const double scale = 1.0 / (1u << m_uiMaxDepth);
+  std::vector<double> values(dof), expected(dof);
+  for (size_t ii = 0; ii < nodes.size(); ii++)
+  {
+    double x[3] = {0, 0, 0};
+    const ot::TreeNode<T,dim> node = nodes.getNode(ii);
+    for (unsigned int d = 0; d < dim && d < 3; d++)
+      x[d] = scale * node.getX(d);
+    func(x, expected.data());
+    nodes.getValues(ii, values.data());
+    numFailed += (values != expected) || (nodes.getValue(ii, dof-1) != expected[dof-1]);
+  }
+
+  return numFailed;
+}
+
+
+//------------------------
+// test_checkpoint()
+//   maxPending: 0 writes synchronously, otherwise the bound on staged sections.
+//------------------------
+template <unsigned int dim>
+int test_checkpoint(unsigned int numPts, unsigned int order, unsigned int maxPending, MPI_Comm comm)
+{
+  using T = unsigned int;
+  const char *fName = "tstCheckpoint.bin";
+  const unsigned int dof = 2;
+
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  std::function<void(const double *, double *)> func = [](const double *x, double *var) {
+    var[0] = sin(x[0]) + x[1]*x[1];
+    var[1] = cos(x[(dim < 3 ? dim : 3) - 1]) - x[0];
+  };
+
+  int writeFailed = 0;
+  DendroIntL numNodes = 0;
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+  ot::SFC_Tree<T,dim>::distTreeSort(tree, 0.3, comm);   // Same order as after restart.
+  const std::vector<ot::TreeNode<T,dim>> treeExpected = gatherTree<T,dim>(tree, comm);
+
+  // Write.
+  {
+    ot::DA<dim> da(tree.data(), tree.size(), comm, order);
+    numNodes = da.getGlobalNodeSz();
+    std::vector<double> vec;
+    da.createVector(vec, false, false, dof);
+    da.setVectorByFunction(vec.data(), func, false, false, dof);
+
+    io::checkpoint::CheckpointFile file(fName, io::checkpoint::CheckpointFile::WRITE, comm);
+    file.setMaxPending(maxPending);
+    io::checkpoint::writeTree<T,dim>(file, tree.data(), tree.size(), "tree");
+    io::checkpoint::writeNodalVec<dim,double>(file, da, vec.data(), dof, false, "u");
+
+    // The staged values are a snapshot.
+    std::fill(vec.begin(), vec.end(), -1.0);
+    writeFailed = file.flush();
+  }
+
+  int result[2] = {writeFailed, 0};
+
+  if (!rank)
+    result[0] += view<dim>(fName, treeExpected, dof, numNodes, func);
+  par::Mpi_Bcast<int>(&result[0], 1, 0, comm);
+
+  // Restart on the same procs.
+  result[0] += restart<dim>(fName, treeExpected, order, dof, func, comm);
+
+  // Restart on half of the procs.
+  MPI_Comm halfComm;
+  MPI_Comm_split(comm, (rank < (npes+1)/2 ? 0 : MPI_UNDEFINED), rank, &halfComm);
+  if (halfComm != MPI_COMM_NULL)
+  {
+    result[1] = restart<dim>(fName, treeExpected, order, dof, func, halfComm);
+    MPI_Comm_free(&halfComm);
+  }
+  par::Mpi_Bcast<int>(&result[1], 1, 0, comm);
+
+  if (!rank)
+  {
+    printf("dim %u order %u %s: restart (%d procs) %s, restart (%d procs) %s\n",
+        dim, order, (maxPending ? "async" : "sync"),
+        npes, (result[0] ? "FAILED" : "succeeded"),
+        (npes+1)/2, (result[1] ? "FAILED" : "succeeded"));
+    MPI_File_delete(fName, MPI_INFO_NULL);
+  }
+
+  return result[0] + result[1];
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  int rank;
+  MPI_Comm comm = MPI_COMM_WORLD;
+  MPI_Comm_rank(comm, &rank);
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(2);
+  numFailed += test_checkpoint<2>(200, 1, 0, comm);
+  numFailed += test_checkpoint<2>(200, 1, 1, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(3);
+  numFailed += test_checkpoint<3>(200, 1, 2, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(4);
+  numFailed += test_checkpoint<4>(100, 1, 0, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
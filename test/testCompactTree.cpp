@@ -0,0 +1,159 @@
+/*
+ * testCompactTree.cpp
+ *   Test io::checkpoint::CompactTreeIO: write a balanced tree and an
+ *   incomplete tree with MPI-IO and with stdio, read them back and compare.
+ */
+
+#include "compactTreeIO.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <vector>
+#include <mpi.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+
+//------------------------
+// gatherTree()
+//   All TreeNodes of a distributed tree, on every proc, in SFC order.
+//------------------------
+template <typename T, unsigned int dim>
+std::vector<ot::TreeNode<T,dim>> gatherTree(const std::vector<ot::TreeNode<T,dim>> &tree, MPI_Comm comm)
+{
+  int npes;
+  MPI_Comm_size(comm, &npes);
+
+  int localBytes = tree.size() * sizeof(ot::TreeNode<T,dim>);
+  std::vector<int> counts(npes), displs(npes, 0);
+  par::Mpi_Allgather<int>(&localBytes, counts.data(), 1, comm);
+  for (int p = 1; p < npes; p++)
+    displs[p] = displs[p-1] + counts[p-1];
+
+  std::vector<ot::TreeNode<T,dim>> all((displs[npes-1] + counts[npes-1]) / sizeof(ot::TreeNode<T,dim>));
+  std::vector<char> local(localBytes);
+  if (localBytes)
+    memcpy(local.data(), tree.data(), localBytes);
+  par::Mpi_Allgatherv<char>(local.data(), localBytes, (char *) all.data(), counts.data(), displs.data(), comm);
+
+  ot::SFC_Tree<T,dim>::locTreeSort(all.data(), 0, all.size(), 1, m_uiMaxDepth, 0);
+  return all;
+}
+
+
+//------------------------
+// test_compactTree()
+//   dropEvery: 0 keeps the balanced (complete) tree, k > 0 drops every k-th leaf.
+//------------------------
+template <unsigned int dim>
+int test_compactTree(unsigned int numPts, unsigned int dropEvery, MPI_Comm comm)
+{
+  using T = unsigned int;
+  using CTIO = io::checkpoint::CompactTreeIO<T,dim>;
+  const char *fName = "tstCompactTree.bin";
+
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+  ot::SFC_Tree<T,dim>::distTreeSort(tree, 0.3, comm);
+  if (dropEvery)
+  {
+    std::vector<ot::TreeNode<T,dim>> kept;
+    for (size_t ii = 0; ii < tree.size(); ii++)
+      if (ii % dropEvery != 0)
+        kept.push_back(tree[ii]);
+    tree.swap(kept);
+  }
+  const std::vector<ot::TreeNode<T,dim>> treeExpected = gatherTree<T,dim>(tree, comm);
+
+  int numFailed = 0;
+
+  // MPI-IO, small blocks so that procs get several.
+  numFailed += (CTIO::dist_write(fName, tree.data(), tree.size(), comm, 64) != 0);
+  std::vector<ot::TreeNode<T,dim>> treeRead;
+  numFailed += (CTIO::dist_read(fName, treeRead, comm) != 0);
+  numFailed += (gatherTree<T,dim>(treeRead, comm) != treeExpected);
+
+  // stdio, the whole tree.
+  long fileBytes = 0;
+  if (!rank)
+  {
+    numFailed += (CTIO::write(fName, treeExpected.data(), treeExpected.size()) != 0);
+    FILE *f = fopen(fName, "rb");
+    if (f != NULL)
+    {
+      fseek(f, 0, SEEK_END);
+      fileBytes = ftell(f);
+      fclose(f);
+    }
+    numFailed += (CTIO::read(fName, treeRead) != 0);
+    numFailed += (treeRead != treeExpected);
+
+    // A file of the other curve must be rejected.
+    f = fopen(fName, "r+b");
+    if (f != NULL)
+    {
+      uint32_t curve;
+      fseek(f, offsetof(io::checkpoint::CompactTreeHeader, m_curve), SEEK_SET);
+      numFailed += (fread(&curve, sizeof(curve), 1, f) != 1);
+      numFailed += (curve != io::checkpoint::CompactCurveMorton && curve != io::checkpoint::CompactCurveHilbert);
+      curve = (curve == io::checkpoint::CompactCurveMorton ? io::checkpoint::CompactCurveHilbert : io::checkpoint::CompactCurveMorton);
+      fseek(f, offsetof(io::checkpoint::CompactTreeHeader, m_curve), SEEK_SET);
+      fwrite(&curve, sizeof(curve), 1, f);
+      fclose(f);
+      numFailed += (CTIO::read(fName, treeRead) == 0);
+    }
+    remove(fName);
+  }
+
+  int globFailed = 0;
+  par::Mpi_Allreduce<int>(&numFailed, &globFailed, 1, MPI_SUM, comm);
+
+  if (!rank)
+  {
+    printf("dim %u %s tree of %lu leaves: %ld bytes (%.1f bytes/leaf, %lu raw), %s\n",
+        dim, (dropEvery ? "incomplete" : "complete"),
+        (unsigned long) treeExpected.size(), fileBytes,
+        (treeExpected.size() ? (double) fileBytes / treeExpected.size() : 0.0),
+        (unsigned long) sizeof(ot::TreeNode<T,dim>),
+        (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return globFailed;
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 8;
+  int numFailed = 0;
+
+  _InitializeHcurve(2);
+  numFailed += test_compactTree<2>(1000, 0, comm);
+  numFailed += test_compactTree<2>(1000, 7, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(3);
+  numFailed += test_compactTree<3>(1000, 0, comm);
+  numFailed += test_compactTree<3>(1000, 7, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(4);
+  numFailed += test_compactTree<4>(300, 0, comm);
+  numFailed += test_compactTree<4>(300, 7, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
@@ -0,0 +1,123 @@
+/*
+ * testCountThreads.cpp
+ *   Test that the node count does not depend on the number of OpenMP threads:
+ *   SFC_NodeSort::countCGNodes() with one thread, with a team of its own, and
+ *   called from the master thread of an enclosing team (as in DA::construct());
+ *   and the global node count of a DA with one thread and with many.
+ */
+
+#include "oda.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "nsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <algorithm>
+#include <vector>
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+
+
+//------------------------
+// countSelected()
+//------------------------
+template <unsigned int dim>
+ot::RankI countSelected(const std::vector<ot::TNPoint<unsigned int,dim>> &nodes)
+{
+  return std::count_if(nodes.begin(), nodes.end(),
+      [](const ot::TNPoint<unsigned int,dim> &pt) { return pt.get_isSelected() == ot::TNPoint<unsigned int,dim>::Yes; });
+}
+
+
+//------------------------
+// test_countThreads()
+//------------------------
+template <unsigned int dim>
+int test_countThreads(unsigned int numPts, unsigned int order, int numThreads, MPI_Comm comm)
+{
+  using T = unsigned int;
+  using TNP = ot::TNPoint<T,dim>;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+
+  // Local count of the exterior nodes of the local elements.
+  std::vector<TNP> nodes;
+  for (const ot::TreeNode<T,dim> &tn : tree)
+    ot::Element<T,dim>(tn).appendExteriorNodes(order, nodes);
+
+  std::vector<TNP> serialNodes = nodes, teamNodes = nodes, nestedNodes = nodes;
+  ot::RankI serialCount, teamCount, nestedCount;
+
+  omp_set_num_threads(1);
+  serialCount = ot::SFC_NodeSort<T,dim>::countCGNodes(serialNodes.data(), serialNodes.data() + serialNodes.size(), order);
+
+  omp_set_num_threads(numThreads);
+  teamCount = ot::SFC_NodeSort<T,dim>::countCGNodes(teamNodes.data(), teamNodes.data() + teamNodes.size(), order);
+
+  int teamSize = 0;
+  #pragma omp parallel
+  #pragma omp master
+  {
+    teamSize = omp_get_num_threads();
+    nestedCount = ot::SFC_NodeSort<T,dim>::countCGNodes(nestedNodes.data(), nestedNodes.data() + nestedNodes.size(), order);
+  }
+
+  int numFailed = 0;
+  numFailed += (teamSize != numThreads);
+  numFailed += (teamCount != serialCount || nestedCount != serialCount);
+  numFailed += (countSelected<dim>(teamNodes) != countSelected<dim>(serialNodes));
+  numFailed += (countSelected<dim>(nestedNodes) != countSelected<dim>(serialNodes));
+
+  // Global count of a DA.
+  omp_set_num_threads(1);
+  const unsigned int serialGlobNodes = ot::DA<dim>(tree.data(), tree.size(), comm, order).getGlobalNodeSz();
+  omp_set_num_threads(numThreads);
+  const unsigned int teamGlobNodes = ot::DA<dim>(tree.data(), tree.size(), comm, order).getGlobalNodeSz();
+  numFailed += (teamGlobNodes != serialGlobNodes);
+
+  int globFailed = 0;
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+
+  if (!rank)
+  {
+    printf("dim %u order %u: %llu local nodes, %u global nodes, 1 vs %d threads, %s\n",
+        dim, order, (unsigned long long) serialCount, serialGlobNodes, numThreads,
+        (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  // FUNNELED, so that DA::construct() overlaps the count with other work.
+  int threadLevel;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &threadLevel);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 6;
+  const int numThreads = std::max(4, omp_get_max_threads());
+  int numFailed = 0;
+
+  _InitializeHcurve(2);
+  numFailed += test_countThreads<2>(2000, 1, numThreads, comm);
+  numFailed += test_countThreads<2>(2000, 3, numThreads, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(3);
+  numFailed += test_countThreads<3>(2000, 1, numThreads, comm);
+  numFailed += test_countThreads<3>(1000, 2, numThreads, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
@@ -0,0 +1,118 @@
+/*
+ * testExteriorCanonical.cpp
+ *   Test that SFC_NodeSort::appendExteriorNodesCanonical() gives the same nodes,
+ *   with the same instance counts, as Element::appendExteriorNodes() on every element
+ *   followed by a count of literal duplicates; and, for orders 1 and 2, the same
+ *   countCGNodes() result. Adaptive 2D and 3D trees, several orders.
+ */
+
+#include "treeNode.h"
+#include "tsort.h"
+#include "nsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+#include <stdio.h>
+
+
+//------------------------
+// instanceCounts()
+//   Total instances of every (coordinates, level).
+//------------------------
+template <unsigned int dim>
+std::map<std::pair<std::array<unsigned int,dim>, unsigned int>, unsigned int>
+instanceCounts(const std::vector<ot::TNPoint<unsigned int,dim>> &nodes)
+{
+  std::map<std::pair<std::array<unsigned int,dim>, unsigned int>, unsigned int> counts;
+  for (const ot::TNPoint<unsigned int,dim> &pt : nodes)
+  {
+    std::array<unsigned int,dim> coords;
+    for (unsigned int d = 0; d < dim; d++)
+      coords[d] = pt.getX(d);
+    counts[std::make_pair(coords, (unsigned int) pt.getLevel())] += pt.get_numInstances();
+  }
+  return counts;
+}
+
+
+//------------------------
+// test_exteriorCanonical()
+//------------------------
+template <unsigned int dim>
+int test_exteriorCanonical(unsigned int numPts, unsigned int order, MPI_Comm comm)
+{
+  using T = unsigned int;
+  using TNP = ot::TNPoint<T,dim>;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+
+  std::vector<TNP> perElement, canonical;
+  for (const ot::TreeNode<T,dim> &tn : tree)
+    ot::Element<T,dim>(tn).appendExteriorNodes(order, perElement);
+  ot::SFC_NodeSort<T,dim>::appendExteriorNodesCanonical(tree.data(), tree.size(), order, canonical);
+
+  int numFailed = 0;
+
+  // Same nodes and instance counts. Shared nodes are generated only once.
+  numFailed += (instanceCounts<dim>(perElement) != instanceCounts<dim>(canonical));
+  numFailed += (canonical.size() > perElement.size());
+
+  // Same local count of unique nodes. Only for order <= 2: the high-order resolver
+  // depends on the order of the input among coincident points, not only on the counts.
+  if (order <= 2)
+  {
+    const ot::RankI perElementCount = ot::SFC_NodeSort<T,dim>::countCGNodes(perElement.data(), perElement.data() + perElement.size(), order);
+    const ot::RankI canonicalCount = ot::SFC_NodeSort<T,dim>::countCGNodes(canonical.data(), canonical.data() + canonical.size(), order);
+    numFailed += (perElementCount != canonicalCount);
+  }
+
+  unsigned long long numGenerated[2] = {perElement.size(), canonical.size()}, globGenerated[2];
+  MPI_Reduce(numGenerated, globGenerated, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, comm);
+
+  int globFailed = 0;
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+
+  if (!rank)
+  {
+    printf("dim %u order %u: %llu nodes per element, %llu canonical, %s\n",
+        dim, order, globGenerated[0], globGenerated[1], (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(2);
+  numFailed += test_exteriorCanonical<2>(1000, 1, comm);
+  numFailed += test_exteriorCanonical<2>(1000, 2, comm);
+  numFailed += test_exteriorCanonical<2>(1000, 3, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(3);
+  numFailed += test_exteriorCanonical<3>(1000, 1, comm);
+  numFailed += test_exteriorCanonical<3>(1000, 2, comm);
+  numFailed += test_exteriorCanonical<3>(500, 3, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
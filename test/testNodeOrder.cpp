@@ -0,0 +1,167 @@
+/*
+ * testNodeOrder.cpp
+ *   Test DA::renumberNodesFirstTouch(): the local nodes are numbered in the order
+ *   the elements first touch them (nodes matched by coordinates and level), and
+ *   vectors round-trip through constructionOrderToNodalVec() / nodalVecToConstructionOrder().
+ */
+
+#include "oda.h"
+#include "nsort.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <array>
+#include <numeric>
+#include <vector>
+#include <mpi.h>
+#include <stdio.h>
+
+
+//------------------------
+// test_nodeOrder()
+//------------------------
+template <unsigned int dim>
+int test_nodeOrder(unsigned int numPts, unsigned int order, MPI_Comm comm)
+{
+  using T = unsigned int;
+  using TN = ot::TreeNode<T,dim>;
+  const unsigned int dof = 2;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Build the tree one level coarser than m_uiMaxDepth, so that the
+  // nodes of higher order elements have integer coordinates.
+  m_uiMaxDepth--;
+  std::vector<TN> points = ot::getPts<T,dim>(numPts);
+  std::vector<TN> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+  ot::SFC_Tree<T,dim>::distTreeSort(tree, 0.3, comm);
+  m_uiMaxDepth++;
+  for (TN &leaf : tree)
+  {
+    std::array<T,dim> coords;
+    for (int d = 0; d < dim; d++)
+      coords[d] = leaf.getX(d) << 1;
+    leaf = TN(coords, leaf.getLevel());
+  }
+
+  // No shrinking, so that the local elements of the DA are the local tree.
+  ot::DA<dim> da(tree.data(), tree.size(), comm, order, 1);
+
+  auto func = [](const TN &tn, unsigned int v) {
+    double u = 100.0 * v + tn.getLevel();
+    for (int d = 0; d < dim; d++)
+      u += (d + 1.0) * tn.getX(d);
+    return u;
+  };
+
+  int numFailed = 0;
+  const unsigned int nLocal = da.getLocalNodalSz();
+
+  std::vector<double> constrVec(dof * nLocal);
+  for (unsigned int ii = 0; ii < nLocal; ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      constrVec[dof * ii + v] = func(da.getTNCoords()[da.getLocalNodeBegin() + ii], v);
+
+  da.renumberNodesFirstTouch();
+  const TN *localCoords = da.getTNCoords() + da.getLocalNodeBegin();
+
+  // The permutation is a bijection.
+  std::vector<char> seen(nLocal, 0);
+  for (unsigned int p : da.getLocalNodePermutation())
+    numFailed += (p >= nLocal || seen[p]++);
+
+  // Round trip.
+  std::vector<double> curVec(dof * nLocal), backVec(dof * nLocal);
+  da.constructionOrderToNodalVec(constrVec.data(), curVec.data(), dof);
+  for (unsigned int ii = 0; ii < nLocal; ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      numFailed += (curVec[dof * ii + v] != func(localCoords[ii], v));
+  da.nodalVecToConstructionOrder(curVec.data(), backVec.data(), dof);
+  numFailed += (backVec != constrVec);
+
+  // First touch: walking the elements, each new node has the next id.
+  // An element node is the local node at its level, else the nearest coarser one.
+  std::vector<unsigned int> byNode(nLocal);
+  std::iota(byNode.begin(), byNode.end(), 0);
+  auto nodeLess = [](const TN &a, const TN &b) {
+    for (int d = 0; d < dim; d++)
+      if (a.getX(d) != b.getX(d))
+        return a.getX(d) < b.getX(d);
+    return a.getLevel() < b.getLevel();
+  };
+  std::sort(byNode.begin(), byNode.end(),
+      [&](unsigned int a, unsigned int b) { return nodeLess(localCoords[a], localCoords[b]); });
+
+  std::vector<char> touched(nLocal, 0);
+  unsigned int numTouched = 0, numHanging = 0;
+  std::vector<TN> eleNodes;
+  for (const TN &ele : tree)
+  {
+    eleNodes.clear();
+    ot::Element<T,dim>(ele).template appendNodes<TN>(order, eleNodes);
+    for (const TN &node : eleNodes)
+    {
+      auto it = std::upper_bound(byNode.begin(), byNode.end(), node,
+          [&](const TN &key, unsigned int id) { return nodeLess(key, localCoords[id]); });
+      if (it == byNode.begin())
+        continue;
+      --it;
+      bool same = true;
+      for (int d = 0; d < dim; d++)
+        same &= (localCoords[*it].getX(d) == node.getX(d));
+      if (!same)
+        continue;
+      numHanging += (localCoords[*it].getLevel() != node.getLevel());
+      if (!touched[*it]++)
+        numFailed += (*it != numTouched++);
+    }
+  }
+
+  // Ghost reads still agree with the renumbered coordinates.
+  std::vector<double> ghosted;
+  da.createVector(ghosted, false, true, dof);
+  std::copy(curVec.begin(), curVec.end(), ghosted.begin() + dof * da.getLocalNodeBegin());
+  da.readFromGhostBegin(ghosted.data(), dof);
+  da.readFromGhostEnd(ghosted.data(), dof);
+  for (unsigned int ii = 0; ii < da.getTotalNodalSz(); ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      numFailed += (ghosted[dof * ii + v] != func(da.getTNCoords()[ii], v));
+
+  int globFailed = 0;
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+
+  if (!rank)
+  {
+    printf("dim %u order %u: %u of %u local nodes touched (%u matched coarser), %s\n",
+        dim, order, numTouched, nLocal, numHanging, (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(3);
+  numFailed += test_nodeOrder<3>(200, 1, comm);
+  numFailed += test_nodeOrder<3>(200, 2, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(4);
+  numFailed += test_nodeOrder<4>(100, 1, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
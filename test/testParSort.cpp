@@ -0,0 +1,225 @@
+/*
+ * testParSort.cpp
+ *   Test par::sampleSort() and par::HykSort() on keys with and without Mpi_datatype.
+ */
+
+#include "parUtils.h"
+#include "treeNode.h"
+#include "octUtils.h"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <mpi.h>
+#include <stdio.h>
+
+// A record without an Mpi_datatype, sorted by key only.
+struct Particle
+{
+  unsigned int key;
+  unsigned int id;
+  double mass;
+};
+
+struct ParticleLess
+{
+  bool operator()(const Particle &a, const Particle &b) const { return a.key < b.key; }
+};
+
+
+//------------------------
+// check_sorted()
+//   Counts violations of global order and of conservation (by size and checksum).
+//------------------------
+template <typename T, class Compare, class Checksum>
+int check_sorted(const std::vector<T> &before, const std::vector<T> &after,
+                 Compare comp, Checksum checksum, MPI_Comm comm)
+{
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  int numFailed = 0;
+
+  // Locally sorted.
+  for (size_t ii = 1; ii < after.size(); ii++)
+    numFailed += comp(after[ii], after[ii-1]);
+
+  // Sorted across processes: the last element of each nonempty process
+  // does not exceed the first element of any later nonempty process.
+  std::vector<char> ends(2*sizeof(T), 0);
+  std::vector<char> allEnds(npes * 2*sizeof(T));
+  int nonempty = !after.empty();
+  std::vector<int> allNonempty(npes);
+  if (nonempty)
+  {
+    memcpy(&ends[0], &after.front(), sizeof(T));
+    memcpy(&ends[sizeof(T)], &after.back(), sizeof(T));
+  }
+  par::Mpi_Allgather<char>(ends.data(), allEnds.data(), 2*sizeof(T), comm);
+  par::Mpi_Allgather<int>(&nonempty, allNonempty.data(), 1, comm);
+  const T *endsPtr = reinterpret_cast<const T *>(allEnds.data());
+  int prev = -1;
+  for (int r = 0; r < npes; r++)
+    if (allNonempty[r])
+    {
+      if (prev >= 0 && !rank)
+        numFailed += comp(endsPtr[2*r], endsPtr[2*prev + 1]);
+      prev = r;
+    }
+
+  // Same global size and checksum.
+  long long sizes[2] = {(long long) before.size(), (long long) after.size()};
+  long long sums[2] = {0, 0};
+  for (const T &x : before)  sums[0] += checksum(x);
+  for (const T &x : after)   sums[1] += checksum(x);
+  long long glbSizes[2], glbSums[2];
+  par::Mpi_Allreduce<long long>(sizes, glbSizes, 2, MPI_SUM, comm);
+  par::Mpi_Allreduce<long long>(sums, glbSums, 2, MPI_SUM, comm);
+  numFailed += (glbSizes[0] != glbSizes[1]);
+  numFailed += (glbSums[0] != glbSums[1]);
+
+  int glbFailed = 0;
+  par::Mpi_Allreduce<int>(&numFailed, &glbFailed, 1, MPI_SUM, comm);
+  return glbFailed;
+}
+
+
+//------------------------
+// test_sortInts()
+//------------------------
+int test_sortInts(int numPerProc, unsigned int keyRange, unsigned int kway, MPI_Comm comm)
+{
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  // Uneven input sizes, including empty processes.
+  std::mt19937 gen(1 + rank);
+  std::uniform_int_distribution<unsigned int> dist(0, keyRange - 1);
+  std::vector<unsigned int> input((rank % 3 == 1) ? 0 : numPerProc * (1 + rank % 2));
+  for (unsigned int &x : input)
+    x = dist(gen);
+
+  std::vector<unsigned int> sorted = input;
+  if (kway)
+    par::HykSort(sorted, kway, comm);
+  else
+    par::sampleSort(sorted, comm);
+
+  int numFailed = check_sorted(input, sorted, std::less<unsigned int>(),
+      [](unsigned int x) { return (long long) x; }, comm);
+
+  // Balance of sampleSort(): each splitter is within max(1, N/(64 npes)) of its target rank,
+  // so no process receives more than N/npes plus twice that (and a few duplicate keys).
+  // Not checked when duplicate keys dominate, nor for HykSort(), whose groups can differ in size.
+  long long maxLocal = sorted.size(), glbMaxLocal = 0, glbN = 0, locN = sorted.size();
+  par::Mpi_Allreduce<long long>(&maxLocal, &glbMaxLocal, 1, MPI_MAX, comm);
+  par::Mpi_Allreduce<long long>(&locN, &glbN, 1, MPI_SUM, comm);
+  const long long tolerance = std::max<long long>(1, glbN / (npes * 64));
+  const long long maxBalanced = (glbN + npes - 1) / npes + 2 * tolerance + 2;
+  const bool checkBalance = (kway == 0 && keyRange >= glbN);
+  const bool balanced = (!checkBalance || glbMaxLocal <= maxBalanced);
+  numFailed += !balanced;
+
+  if (!rank)
+    printf("[kway==%u] sort ints (range %u): %lld total, max local %lld%s, %s (%d mismatches)\n",
+        kway, keyRange, glbN, glbMaxLocal, (checkBalance ? (balanced ? " (balanced)" : " (UNBALANCED)") : ""),
+        (numFailed ? "FAILED" : "success"), numFailed);
+
+  return numFailed;
+}
+
+
+//------------------------
+// test_sortParticles()
+//------------------------
+int test_sortParticles(int numPerProc, unsigned int kway, MPI_Comm comm)
+{
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  std::mt19937 gen(100 + rank);
+  std::uniform_int_distribution<unsigned int> dist(0, 1u << 30);
+  std::vector<Particle> input(numPerProc);
+  for (size_t ii = 0; ii < input.size(); ii++)
+    input[ii] = {dist(gen), (unsigned int) (rank * numPerProc + ii), 1.0};
+
+  std::vector<Particle> sorted = input;
+  if (kway)
+    par::HykSort(sorted, kway, comm, ParticleLess());
+  else
+    par::sampleSort(sorted, comm, ParticleLess());
+
+  int numFailed = check_sorted(input, sorted, ParticleLess(),
+      [](const Particle &p) { return (long long) p.id + (long long) p.key; }, comm);
+
+  if (!rank)
+    printf("[kway==%u] sort particles: %s (%d mismatches)\n",
+        kway, (numFailed ? "FAILED" : "success"), numFailed);
+
+  return numFailed;
+}
+
+
+//------------------------
+// test_sortTreeNodes()
+//------------------------
+template <unsigned int dim>
+int test_sortTreeNodes(int numPerProc, MPI_Comm comm)
+{
+  using T = unsigned int;
+  using TreeNode = ot::TreeNode<T,dim>;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  _InitializeHcurve(dim);
+
+  std::vector<TreeNode> input = ot::getPts<T,dim>(numPerProc);
+  std::vector<TreeNode> sorted = input;
+  par::sampleSort(sorted, comm);
+
+  int numFailed = check_sorted(input, sorted, std::less<TreeNode>(),
+      [](const TreeNode &tn) { return (long long) tn.getX(0) + (long long) tn.getLevel(); }, comm);
+
+  if (!rank)
+    printf("[dim==%u] sort TreeNodes: %s (%d mismatches)\n",
+        dim, (numFailed ? "FAILED" : "success"), numFailed);
+
+  _DestroyHcurve();
+
+  return numFailed;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int numPerProc = 1000;
+  if (argc > 1)
+    numPerProc = strtol(argv[1], NULL, 0);
+
+  int numFailed = 0;
+
+  // kway==0 means sampleSort().
+  for (unsigned int kway : {0u, 2u, 3u})
+  {
+    numFailed += test_sortInts(numPerProc, 1u << 30, kway, comm);
+    numFailed += test_sortInts(numPerProc, 5, kway, comm);
+    numFailed += test_sortParticles(numPerProc, kway, comm);
+  }
+
+  numFailed += test_sortTreeNodes<2>(numPerProc, comm);
+  numFailed += test_sortTreeNodes<3>(numPerProc, comm);
+  numFailed += test_sortTreeNodes<4>(numPerProc, comm);
+
+  MPI_Finalize();
+
+  return (numFailed != 0);
+}
@@ -0,0 +1,113 @@
+/*
+ * testProcNeighbours.cpp
+ *   Test SFC_NodeSort::getProcNeighboursBatch() against per-node getProcNeighbours(),
+ *   for every block of a split tree, on the nodes of all elements, including the
+ *   nodes on the domain boundary (the early-out of markInteriorHosts()).
+ */
+
+#include "treeNode.h"
+#include "tsort.h"
+#include "nsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <algorithm>
+#include <vector>
+#include <mpi.h>
+#include <stdio.h>
+
+
+//------------------------
+// test_procNeighbours()
+//------------------------
+template <unsigned int dim>
+int test_procNeighbours(unsigned int numPts, int numBlocks, unsigned int order)
+{
+  using T = unsigned int;
+  using TN = ot::TreeNode<T,dim>;
+
+  // A local tree, split into numBlocks consecutive blocks.
+  std::vector<TN> points = ot::getPts<T,dim>(numPts);
+  std::vector<TN> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, MPI_COMM_SELF);
+
+  std::vector<TN> splitters;
+  for (int b = 0; b < numBlocks; b++)
+    splitters.push_back(tree[(size_t) b * tree.size() / numBlocks]);
+
+  int numFailed = 0;
+  long numNodes = 0, numBoundary = 0, numShared = 0;
+  std::vector<int> batchList, numBatch, singleList;
+  for (int rProc = 0; rProc < numBlocks; rProc++)
+  {
+    const size_t eleBegin = (size_t) rProc * tree.size() / numBlocks;
+    const size_t eleEnd = (size_t) (rProc + 1) * tree.size() / numBlocks;
+
+    std::vector<ot::TNPoint<T,dim>> nodes;
+    for (size_t e = eleBegin; e < eleEnd; e++)
+      ot::Element<T,dim>(tree[e]).appendExteriorNodes(order, nodes);
+    ot::SFC_Tree<T,dim>::locTreeSort(nodes.data(), 0, (ot::RankI) nodes.size(), 1, m_uiMaxDepth, 0);
+
+    batchList.clear();
+    ot::SFC_NodeSort<T,dim>::getProcNeighboursBatch(nodes.data(), nodes.size(),
+        splitters.data(), numBlocks, rProc, batchList, numBatch, order);
+    numFailed += (numBatch.size() != nodes.size());
+
+    const int *batchPtr = batchList.data();
+    for (size_t ii = 0; ii < nodes.size() && ii < numBatch.size(); ii++)
+    {
+      singleList.clear();
+      ot::SFC_NodeSort<T,dim>::getProcNeighbours(nodes[ii], splitters.data(), numBlocks, singleList, order);
+      std::sort(singleList.begin(), singleList.end());
+      singleList.erase(std::unique(singleList.begin(), singleList.end()), singleList.end());
+
+      numFailed += !(singleList.size() == numBatch[ii] && std::equal(singleList.begin(), singleList.end(), batchPtr));
+      batchPtr += numBatch[ii];
+
+      numNodes++;
+      numShared += (numBatch[ii] > 1);
+      bool onBoundary = false;
+      for (int d = 0; d < dim; d++)
+        onBoundary |= (nodes[ii].getX(d) == 0 || nodes[ii].getX(d) == (1u << m_uiMaxDepth));
+      numBoundary += onBoundary;
+    }
+  }
+
+  printf("dim %u order %u, %d blocks: %ld nodes (%ld on the domain boundary, %ld shared), %s\n",
+      dim, order, numBlocks, numNodes, numBoundary, numShared, (numFailed ? "FAILED" : "succeeded"));
+
+  return (numFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  // Serial test; only rank 0 runs it.
+  if (!rank)
+  {
+    _InitializeHcurve(2);
+    numFailed += test_procNeighbours<2>(300, 1, 1);
+    numFailed += test_procNeighbours<2>(300, 5, 1);
+    _DestroyHcurve();
+
+    _InitializeHcurve(3);
+    numFailed += test_procNeighbours<3>(300, 4, 1);
+    numFailed += test_procNeighbours<3>(300, 7, 2);
+    _DestroyHcurve();
+
+    _InitializeHcurve(4);
+    numFailed += test_procNeighbours<4>(100, 3, 1);
+    _DestroyHcurve();
+  }
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
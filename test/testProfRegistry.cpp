@@ -0,0 +1,131 @@
+/*
+ * testProfRegistry.cpp
+ *   Test the profiled region registry (profRegistry.h): nesting, per-thread
+ *   accumulation, counters, time added by the caller, reset(), the report over procs, and the
+ *   trace files merged into a Chrome trace.
+ */
+
+#include "profRegistry.h"
+
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+void work(int rank)
+{
+  prof::ScopedRegion outer("outer");
+  for (int ii = 0; ii < 3; ii++)
+  {
+    prof::beginRegion("inner");
+    prof::addBytes(100);
+    prof::addFlops(10);
+    prof::endRegion();
+  }
+  prof::addRegion("summed", 0.25, 4, 2);
+
+  // Only some procs enter this region.
+  if (rank % 2 == 1)
+  {
+    prof::ScopedRegion odd("odd");
+  }
+
+  #pragma omp parallel num_threads(4)
+  {
+    prof::ScopedRegion threads("threads");
+    prof::addBytes(1);
+  }
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int rank, npes;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &npes);
+
+  int numFailed = 0;
+  prof::RegionStats stats;
+
+  work(rank);
+  prof::reset();
+  numFailed += !(prof::getLocalStats("outer/inner", stats) && stats.calls == 0 && stats.bytes == 0);
+
+  work(rank);
+  work(rank);
+
+  numFailed += !(prof::getLocalStats("outer", stats) && stats.calls == 2);
+  numFailed += !(prof::getLocalStats("outer/inner", stats) &&
+                 stats.calls == 6 && stats.bytes == 600 && stats.flops == 60);
+  numFailed += (prof::getLocalStats("inner", stats));
+  numFailed += !(prof::getLocalStats("outer/summed", stats) && stats.calls == 8 && stats.seconds == 0.5);
+  numFailed += (prof::getLocalStats("outer/odd", stats) != (rank % 2 == 1));
+
+  // The master thread nests under "outer"; other threads have their own trees.
+  long long threadCalls = 0, threadBytes = 0;
+  if (prof::getLocalStats("outer/threads", stats))
+  {
+    threadCalls += stats.calls;
+    threadBytes += stats.bytes;
+  }
+  if (prof::getLocalStats("threads", stats))
+  {
+    threadCalls += stats.calls;
+    threadBytes += stats.bytes;
+  }
+  numFailed += (threadCalls != 2 * 4);
+  numFailed += (threadBytes != threadCalls);
+
+  std::ostringstream report;
+  prof::report(report, comm);
+  if (!rank)
+  {
+    const std::string table = report.str();
+    numFailed += (table.find("outer/inner\t6\t") == std::string::npos);
+    numFailed += (npes > 1 && table.find("outer/odd\t") == std::string::npos);
+    printf("%s", table.c_str());
+  }
+
+  // Trace one more round of work and merge the traces of all procs.
+  const char *tracePrefix = "tstProfTrace";
+  prof::traceBegin(tracePrefix, comm);
+  work(rank);
+  {
+    prof::ScopedRegion level("level", 3);
+  }
+  numFailed += (prof::traceEnd() != 0);
+  MPI_Barrier(comm);
+  if (!rank)
+  {
+    numFailed += (prof::writeChromeTrace(tracePrefix, "tstProfTrace.json") != 0);
+    std::ifstream jsonFile("tstProfTrace.json");
+    std::stringstream json;
+    json << jsonFile.rdbuf();
+    const std::string trace = json.str();
+
+    numFailed += (trace.find("\"traceEvents\"") == std::string::npos);
+    numFailed += (trace.find("\"args\": {\"arg\": 3}") == std::string::npos);
+    for (int r = 0; r < npes; r++)
+    {
+      const std::string pid = "\"pid\": " + std::to_string(r) + ", ";
+      for (const char *name : {"outer", "inner", "summed", "threads", "level"})
+        numFailed += (trace.find("{\"name\": \"" + std::string(name) + "\", \"ph\": \"X\", " + pid) == std::string::npos);
+      remove((std::string(tracePrefix) + "." + std::to_string(r) + ".trace").c_str());
+    }
+    remove("tstProfTrace.json");
+  }
+
+  int globFailed = 0;
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+  if (!rank)
+    printf("testProfRegistry %s\n", (globFailed ? "FAILED" : "succeeded"));
+
+  MPI_Finalize();
+  return (globFailed != 0);
+}
@@ -0,0 +1,94 @@
+/*
+ * testSFCKey.cpp
+ *   Test precomputed SFC keys against TreeNode and locTreeSort().
+ */
+
+#include "sfcKey.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <vector>
+#include <unordered_set>
+#include <set>
+#include <mpi.h>
+#include <stdio.h>
+
+//------------------------
+// test_sfcKey()
+//------------------------
+template <unsigned int dim, typename UInt>
+void test_sfcKey(int numPoints, const char *keyName)
+{
+  using T = unsigned int;
+  using TreeNode = ot::TreeNode<T,dim>;
+  using Key = ot::SFC_Key<T,dim,UInt>;
+
+  if (!Key::fits())
+  {
+    printf("[dim==%u] %s: m_uiMaxDepth==%u does not fit, skipped.\n", dim, keyName, m_uiMaxDepth);
+    return;
+  }
+
+  _InitializeHcurve(dim);
+
+  // Cells inside the domain at all levels, including ancestors of each other.
+  std::vector<TreeNode> tnodes;
+  for (const TreeNode &pt : ot::getPts<T,dim>(numPoints))
+    if (pt.getMortonIndex(0) == 0)
+      for (unsigned int lev = 0; lev <= m_uiMaxDepth; lev += 1 + pt.getX(0) % 3)
+        tnodes.push_back(pt.getAncestor(lev));
+
+  ot::SFC_Tree<T,dim>::locTreeSort(&(*tnodes.begin()), 0, tnodes.size(), 1, m_uiMaxDepth, 0);
+
+  std::vector<Key> keys;
+  Key::makeKeys(&(*tnodes.begin()), tnodes.size(), keys);
+
+  int numFailed = 0;
+  for (size_t ii = 0; ii < tnodes.size(); ii++)
+  {
+    numFailed += (keys[ii].toTreeNode() != tnodes[ii]);
+    numFailed += (keys[ii].getLevel() != tnodes[ii].getLevel());
+    if (ii > 0)
+    {
+      numFailed += (keys[ii] < keys[ii-1]);
+      numFailed += ((keys[ii-1] < keys[ii]) != (tnodes[ii-1] < tnodes[ii]));
+      numFailed += (keys[ii-1].isAncestor(keys[ii]) != tnodes[ii-1].isAncestor(tnodes[ii]));
+    }
+  }
+
+  // Hashing agrees with equality.
+  std::unordered_set<Key> keySet(keys.begin(), keys.end());
+  std::set<TreeNode> tnSet(tnodes.begin(), tnodes.end());
+  numFailed += (keySet.size() != tnSet.size());
+
+  printf("[dim==%u] %s: %d cells, %d unique, %s (%d mismatches)\n",
+      dim, keyName, (int) tnodes.size(), (int) keySet.size(), (numFailed ? "FAILED" : "success"), numFailed);
+
+  _DestroyHcurve();
+}
+
+
+
+int main(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  int numPoints = 500;
+  if (argc > 1)
+    numPoints = strtol(argv[1], NULL, 0);
+
+  test_sfcKey<2, ot::SFC_UInt128>(numPoints, "SFC_Key128");
+  test_sfcKey<3, ot::SFC_UInt128>(numPoints, "SFC_Key128");
+  test_sfcKey<4, ot::SFC_UInt128>(numPoints, "SFC_Key128");
+
+  m_uiMaxDepth = 14;
+  test_sfcKey<2, uint64_t>(numPoints, "SFC_Key64");
+  test_sfcKey<3, uint64_t>(numPoints, "SFC_Key64");
+  test_sfcKey<4, uint64_t>(numPoints, "SFC_Key64");
+
+  MPI_Finalize();
+
+  return 0;
+}
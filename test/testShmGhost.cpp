@@ -0,0 +1,136 @@
+/*
+ * testShmGhost.cpp
+ *   Test ghost reads through the shared-memory window (enableSharedGhostReads())
+ *   against the message path, for several dofs, including nodes wider than
+ *   the window, which fall back to messages, and after renumberNodesFirstTouch()
+ *   while shared reads are enabled. Run with np >= 2.
+ */
+
+#include "oda.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <vector>
+#include <mpi.h>
+#include <stdio.h>
+
+
+//------------------------
+// nodeValue()
+//------------------------
+template <unsigned int dim>
+double nodeValue(const ot::TreeNode<unsigned int,dim> &tn, unsigned int v, int round)
+{
+  double u = round + 10.0 * v + tn.getLevel();
+  for (int d = 0; d < dim; d++)
+    u += (d + 1.0) * tn.getX(d);
+  return u;
+}
+
+
+//------------------------
+// readGhosts()
+//------------------------
+template <unsigned int dim>
+std::vector<double> readGhosts(ot::DA<dim> &da, unsigned int dof, int round)
+{
+  using T = unsigned int;
+  std::vector<double> ghosted;
+  da.createVector(ghosted, false, true, dof);
+  std::fill(ghosted.begin(), ghosted.end(), -1.0);
+
+  const ot::TreeNode<T,dim> *tnCoords = da.getTNCoords();
+  for (size_t ii = da.getLocalNodeBegin(); ii < da.getLocalNodeBegin() + da.getLocalNodalSz(); ii++)
+    for (unsigned int v = 0; v < dof; v++)
+      ghosted[dof * ii + v] = nodeValue<dim>(tnCoords[ii], v, round);
+
+  da.readFromGhostBegin(ghosted.data(), dof);
+  da.readFromGhostEnd(ghosted.data(), dof);
+  return ghosted;
+}
+
+
+//------------------------
+// test_shmGhost()
+//------------------------
+template <unsigned int dim>
+int test_shmGhost(unsigned int numPts, unsigned int order, MPI_Comm comm)
+{
+  using T = unsigned int;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+
+  ot::DA<dim> da(tree.data(), tree.size(), comm, order);
+
+  const unsigned int maxDof = 3;
+  const unsigned int dofs[] = {1, 3, 5};
+
+  std::vector<std::vector<double>> expected;
+  for (unsigned int dof : dofs)
+    expected.push_back(readGhosts(da, dof, 0));
+
+  int numFailed = 0;
+  da.enableSharedGhostReads(maxDof);
+  numFailed += (da.isActive() && !da.isSharedGhostReads());
+
+  // Several rounds, so that restaging is separated from the previous reads.
+  for (int round = 0; round < 3; round++)
+    for (int ii = 0; ii < sizeof(dofs) / sizeof(dofs[0]); ii++)
+    {
+      std::vector<double> ghosted = readGhosts(da, dofs[ii], round);
+      for (size_t jj = 0; jj < ghosted.size(); jj++)
+        numFailed += (ghosted[jj] != expected[ii][jj] + round);
+    }
+
+  da.disableSharedGhostReads();
+  numFailed += (da.isSharedGhostReads());
+  numFailed += (readGhosts(da, maxDof, 0) != expected[1]);
+
+  // Renumbering while shared reads are enabled; every node must carry the value of its coordinates.
+  da.enableSharedGhostReads(maxDof);
+  da.renumberNodesFirstTouch();
+  for (unsigned int dof : dofs)
+  {
+    std::vector<double> ghosted = readGhosts(da, dof, 1);
+    for (size_t ii = 0; ii < da.getTotalNodalSz(); ii++)
+      for (unsigned int v = 0; v < dof; v++)
+        numFailed += (ghosted[dof * ii + v] != nodeValue<dim>(da.getTNCoords()[ii], v, 1));
+  }
+  da.disableSharedGhostReads();
+
+  int globFailed = 0;
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+
+  if (!rank)
+  {
+    printf("dim %u order %u: %s\n", dim, order, (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(3);
+  numFailed += test_shmGhost<3>(200, 1, comm);
+  numFailed += test_shmGhost<3>(200, 2, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
@@ -0,0 +1,157 @@
+/*
+ * testSlice.cpp
+ *   Test ot::DA::extractSlice(): slice a 4D nodal vector of a linear function
+ *   at fixed t and at fixed x, and compare the slice values and the slice volume.
+ *   Optionally slice once before DA::renumberNodesFirstTouch(), so that the
+ *   node index of the first slice must be rebuilt for the second.
+ */
+
+#include "oda.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+
+#include <array>
+#include <vector>
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+
+
+//------------------------
+// test_slice()
+//------------------------
+template <unsigned int dim>
+int test_slice(unsigned int numPts, unsigned int order, unsigned int sliceDim, double sliceCoord, bool renumber, MPI_Comm comm)
+{
+  using T = unsigned int;
+  const unsigned int dof = 2;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Build the tree one level coarser than m_uiMaxDepth, so that the
+  // nodes of higher order elements have integer coordinates.
+  m_uiMaxDepth--;
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+  ot::SFC_Tree<T,dim>::distTreeSort(tree, 0.3, comm);
+  m_uiMaxDepth++;
+  for (ot::TreeNode<T,dim> &leaf : tree)
+  {
+    std::array<T,dim> coords;
+    for (int d = 0; d < dim; d++)
+      coords[d] = leaf.getX(d) << 1;
+    leaf = ot::TreeNode<T,dim>(coords, leaf.getLevel());
+  }
+
+  ot::DA<dim> da(tree.data(), tree.size(), comm, order);
+
+  std::vector<ot::TreeNode<T,dim-1>> sliceTree;
+  std::vector<double> sliceValues;
+  if (renumber)
+  {
+    std::vector<double> zero;
+    da.createVector(zero, false, false, dof);
+    da.extractSlice(zero.data(), sliceDim, sliceCoord, sliceTree, sliceValues, false, dof);
+    da.renumberNodesFirstTouch();
+  }
+
+  // Linear in every coordinate, so that the slice values are exact.
+  auto func = [](const double *x, double *u) {
+    u[0] = 1.0 + x[0] + 2.0*x[1] - 3.0*x[2] + 4.0*x[dim-1];
+    u[1] = 0.5 - x[dim-1] + 0.25*x[0];
+  };
+
+  // setVectorByFunction() only passes three coordinates, so set the vector from the nodes.
+  const double scale = 1.0 / (1u << m_uiMaxDepth);
+  std::vector<double> vec;
+  da.createVector(vec, false, false, dof);
+  const ot::TreeNode<T,dim> *tnCoords = da.getTNCoords() + da.getLocalNodeBegin();
+  for (size_t ii = 0; ii < da.getLocalNodalSz(); ii++)
+  {
+    double x[dim];
+    for (int d = 0; d < dim; d++)
+      x[d] = scale * tnCoords[ii].getX(d);
+    func(x, &vec[dof * ii]);
+  }
+
+  DendroIntL numFailed = da.extractSlice(vec.data(), sliceDim, sliceCoord, sliceTree, sliceValues, false, dof);
+
+  const unsigned int sliceNpe = (unsigned int) intPow(order + 1, dim - 1);
+  numFailed += (sliceValues.size() != sliceTree.size() * sliceNpe * dof);
+
+  double volume = 0.0;
+  for (size_t ii = 0; ii < sliceTree.size() && !numFailed; ii++)
+  {
+    const double len = scale * (1u << (m_uiMaxDepth - sliceTree[ii].getLevel()));
+    volume += pow(len, dim - 1);
+
+    for (unsigned int m = 0; m < sliceNpe; m++)
+    {
+      double x[dim], u[dof];
+      unsigned int rem = m;
+      for (unsigned int d = 0, sd = 0; d < dim; d++)
+      {
+        if (d == sliceDim)
+        {
+          x[d] = sliceCoord;
+          continue;
+        }
+        x[d] = scale * sliceTree[ii].getX(sd++) + len * (rem % (order + 1)) / order;
+        rem /= (order + 1);
+      }
+      func(x, u);
+      for (unsigned int v = 0; v < dof; v++)
+        numFailed += (fabs(sliceValues[(m * dof) + v + ii * sliceNpe * dof] - u[v]) > 1e-10);
+    }
+  }
+
+  DendroIntL globFailed = 0;
+  double globVolume = 0.0;
+  DendroIntL numLeaves = sliceTree.size(), globLeaves = 0;
+  par::Mpi_Allreduce<DendroIntL>(&numFailed, &globFailed, 1, MPI_SUM, comm);
+  par::Mpi_Allreduce<double>(&volume, &globVolume, 1, MPI_SUM, comm);
+  par::Mpi_Allreduce<DendroIntL>(&numLeaves, &globLeaves, 1, MPI_SUM, comm);
+  globFailed += (fabs(globVolume - 1.0) > 1e-12);
+
+  if (!rank)
+  {
+    printf("dim %u order %u slice x[%u]=%.3f%s: %lld elements, volume %f, %s\n",
+        dim, order, sliceDim, sliceCoord, (renumber ? " renumbered" : ""), (long long) globLeaves, globVolume,
+        (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(4);
+  for (unsigned int order : {1, 2})
+  {
+    numFailed += test_slice<4>(200, order, 3, 0.3, false, comm);
+    numFailed += test_slice<4>(200, order, 3, 1.0, false, comm);
+    numFailed += test_slice<4>(200, order, 0, 0.5, false, comm);
+  }
+  numFailed += test_slice<4>(200, 2, 3, 0.3, true, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(3);
+  numFailed += test_slice<3>(500, 1, 2, 0.55, false, comm);
+  numFailed += test_slice<3>(500, 1, 2, 0.55, true, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}
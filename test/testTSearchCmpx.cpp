@@ -18,6 +18,7 @@
 #include <iostream>
 #include <fstream>
 #include <stdio.h>
+#include <random>
 
 //------------------------
 // test_locTSearch()
@@ -80,6 +81,134 @@ void test_locTSearch(int numPoints)
 
 
 
+//------------------------
+// getUniformQueryPts()
+//------------------------
+template <unsigned int dim>
+std::vector<ot::TreeNode<unsigned int, dim>> getUniformQueryPts(int numPoints, unsigned int seed)
+{
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<unsigned int> distCoord(0, (1u << m_uiMaxDepth) - 1);
+
+  std::vector<ot::TreeNode<unsigned int, dim>> points;
+  std::array<unsigned int, dim> uiCoords;
+  for (int ii = 0; ii < numPoints; ii++)
+  {
+    for (unsigned int &u : uiCoords)
+      u = distCoord(gen);
+    points.push_back(ot::TreeNode<unsigned int, dim>(uiCoords, m_uiMaxDepth));
+  }
+  return points;
+}
+
+
+//------------------------
+// test_locateLeaves()
+//------------------------
+template <unsigned int dim>
+void test_locateLeaves(int numPoints, int numQueries)
+{
+  using T = unsigned int;
+  using TreeNode = ot::TreeNode<T,dim>;
+
+  _InitializeHcurve(dim);
+
+  std::vector<TreeNode> points = ot::getPts<T,dim>(numPoints);
+  std::vector<TreeNode> tree;
+  ot::SFC_Tree<T,dim>::locTreeBalancing(points, tree, 1);
+
+  // Pretend the local tree is a middle part of a bigger one.
+  const ot::RankI startRank = 100;
+  const ot::RankI treeBegin = tree.size() / 4;
+  const ot::RankI treeEnd = tree.size() - tree.size() / 4;
+
+  std::vector<TreeNode> queries = getUniformQueryPts<dim>(numQueries, 42);
+
+  // Reference: linear scan.
+  std::vector<ot::RankI> expected(numQueries, ot::SFC_Search<T,dim>::notFound);
+  for (int q = 0; q < numQueries; q++)
+    for (ot::RankI ii = treeBegin; ii < treeEnd; ii++)
+      if (queries[q].getAncestor(tree[ii].getLevel()) == tree[ii])
+        expected[q] = startRank + ii - treeBegin;
+
+  int numFailed = 0;
+  for (ot::RankI numSamples : {1, 4, 32})
+  {
+    ot::CompressedTree<T,dim> treeCmpx;
+    ot::SFC_Search<T,dim>::compressTree(&tree[treeBegin], treeEnd - treeBegin, numSamples, startRank, treeCmpx);
+
+    std::vector<ot::RankI> found;
+    ot::SFC_Search<T,dim>::locateLeaves(treeCmpx, &(*queries.begin()), queries.size(), found);
+    for (int q = 0; q < numQueries; q++)
+      numFailed += (found[q] != expected[q]);
+  }
+
+  int numContained = 0;
+  for (ot::RankI r : expected)
+    numContained += (r != ot::SFC_Search<T,dim>::notFound);
+
+  printf("[dim==%u] locateLeaves: %d leaves, %d/%d queries contained, %s (%d mismatches)\n",
+      dim, (int) (treeEnd - treeBegin), numContained, numQueries, (numFailed ? "FAILED" : "success"), numFailed);
+
+  _DestroyHcurve();
+}
+
+
+//------------------------
+// test_distLocateOwners()
+//------------------------
+template <unsigned int dim>
+void test_distLocateOwners(int numPoints, int numQueries, MPI_Comm comm)
+{
+  using T = unsigned int;
+  using TreeNode = ot::TreeNode<T,dim>;
+
+  int nProc, rProc;
+  MPI_Comm_size(comm, &nProc);
+  MPI_Comm_rank(comm, &rProc);
+
+  _InitializeHcurve(dim);
+
+  std::vector<TreeNode> points = ot::getPts<T,dim>(numPoints);
+  std::vector<TreeNode> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+
+  ot::CompressedTree<T,dim> treeCmpx;
+  ot::SFC_Search<T,dim>::compressTree(&(*tree.begin()), tree.size(), 8, 0, treeCmpx);
+
+  // Every process asks about the same points.
+  std::vector<TreeNode> queries = getUniformQueryPts<dim>(numQueries, 7);
+
+  std::vector<int> owners;
+  ot::SFC_Search<T,dim>::dist_locateOwners(treeCmpx, &(*queries.begin()), queries.size(), owners, comm);
+
+  // The owner must be the only process that finds the point locally.
+  std::vector<ot::RankI> found;
+  ot::SFC_Search<T,dim>::locateLeaves(treeCmpx, &(*queries.begin()), queries.size(), found);
+  std::vector<int> finders(numQueries), numFinders(numQueries), glbFinders(numQueries), glbNumFinders(numQueries);
+  for (int q = 0; q < numQueries; q++)
+  {
+    numFinders[q] = (found[q] != ot::SFC_Search<T,dim>::notFound);
+    finders[q] = (numFinders[q] ? rProc : -1);
+  }
+  par::Mpi_Allreduce(&(*finders.begin()), &(*glbFinders.begin()), numQueries, MPI_MAX, comm);
+  par::Mpi_Allreduce(&(*numFinders.begin()), &(*glbNumFinders.begin()), numQueries, MPI_SUM, comm);
+
+  int numFailed = 0;
+  for (int q = 0; q < numQueries; q++)
+    numFailed += (glbNumFinders[q] != 1 || glbFinders[q] != owners[q]);
+
+  int glbNumFailed = 0;
+  par::Mpi_Allreduce(&numFailed, &glbNumFailed, 1, MPI_SUM, comm);
+  if (!rProc)
+    printf("[dim==%u] dist_locateOwners: %d procs, %s (%d mismatches)\n",
+        dim, nProc, (glbNumFailed ? "FAILED" : "success"), glbNumFailed);
+
+  _DestroyHcurve();
+}
+
+
+
 int main(int argc, char* argv[])
 {
   MPI_Init(&argc, &argv);
@@ -92,6 +221,19 @@ int main(int argc, char* argv[])
   /// test_locTSearch<3>(ptsPerProc);
   test_locTSearch<4>(ptsPerProc);
 
+  int rProc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rProc);
+  if (!rProc)
+  {
+    test_locateLeaves<2>(ptsPerProc, 1000);
+    test_locateLeaves<3>(ptsPerProc, 1000);
+    test_locateLeaves<4>(ptsPerProc, 1000);
+  }
+
+  test_distLocateOwners<2>(ptsPerProc, 1000, MPI_COMM_WORLD);
+  test_distLocateOwners<3>(ptsPerProc, 1000, MPI_COMM_WORLD);
+  test_distLocateOwners<4>(ptsPerProc, 1000, MPI_COMM_WORLD);
+
   MPI_Finalize();
 
   return 0;
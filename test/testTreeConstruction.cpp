@@ -16,6 +16,8 @@
 #include <vector>
 
 #include <assert.h>
+#include <omp.h>
+#include <stdio.h>
 #include <mpi.h>
 
 // ...........................................................................
@@ -62,6 +64,108 @@ void test_locTreeConstruction(int numPoints)
 }
 
 
+//------------------------
+// test_locTreeConstructionThreads()
+//
+// Notes:
+//   - The tree built with OpenMP tasks must equal the tree built on one thread.
+//------------------------
+template <unsigned int dim>
+void test_locTreeConstructionThreads(int numPoints)
+{
+  using T = unsigned int;
+  using TreeNode = ot::TreeNode<T,dim>;
+
+  _InitializeHcurve(dim);
+
+  const std::vector<TreeNode> points = ot::getPts<T,dim>(numPoints);
+  const unsigned int maxPtsPerRegion = 1;
+
+  std::vector<TreeNode> trees[2];
+  const int maxThreads = omp_get_max_threads();
+  const int numThreads[2] = {1, std::max(4, maxThreads)};
+  for (int trial = 0; trial < 2; trial++)
+  {
+    omp_set_num_threads(numThreads[trial]);
+    std::vector<TreeNode> pointsCopy = points;
+    ot::SFC_Tree<T,dim>::locTreeConstruction(
+        &(*pointsCopy.begin()), trees[trial],
+        maxPtsPerRegion,
+        0, (ot::RankI) pointsCopy.size(),
+        1, m_uiMaxDepth,
+        0,
+        TreeNode());
+  }
+  omp_set_num_threads(maxThreads);
+
+  const bool success = (trees[0] == trees[1]);
+  printf("[dim==%u] locTreeConstruction %d threads vs 1: %d leaves, %s\n",
+      dim, numThreads[1], (int) trees[1].size(), (success ? "success" : "FAILED"));
+
+  _DestroyHcurve();
+}
+
+
+//------------------------
+// test_distTreeConstructionStreamed()
+//
+// Notes:
+//   - The streaming construction must produce the same leaves as
+//     locTreeConstruction() over the union of all points, for any chunk size.
+//------------------------
+template <unsigned int dim>
+void test_distTreeConstructionStreamed(int numPoints, ot::RankI chunkSize, MPI_Comm comm = MPI_COMM_WORLD)
+{
+  using T = unsigned int;
+  using TreeNode = ot::TreeNode<T,dim>;
+
+  int nProc, rProc;
+  MPI_Comm_size(comm, &nProc);
+  MPI_Comm_rank(comm, &rProc);
+
+  _InitializeHcurve(dim);
+
+  std::vector<TreeNode> points = ot::getPts<T,dim>(numPoints);
+  const unsigned int maxPtsPerRegion = 4;
+
+  std::vector<TreeNode> tree;
+  ot::PointStream<T,dim> stream = ot::PointStream<T,dim>::fromArray(&(*points.begin()), points.size());
+  const int err = ot::SFC_Tree<T,dim>::distTreeConstruction(stream, tree, maxPtsPerRegion, chunkSize, comm);
+
+  // Gather the points and the tree.
+  std::vector<TreeNode> globalPoints, globalTree;
+  std::vector<TreeNode> *local[2] = {&points, &tree};
+  std::vector<TreeNode> *global[2] = {&globalPoints, &globalTree};
+  for (int t = 0; t < 2; t++)
+  {
+    int localSize = local[t]->size();
+    std::vector<int> sizes(nProc), displs(nProc, 0);
+    par::Mpi_Allgather<int>(&localSize, &(*sizes.begin()), 1, comm);
+    for (int r = 1; r < nProc; r++)
+      displs[r] = displs[r-1] + sizes[r-1];
+    global[t]->resize(displs[nProc-1] + sizes[nProc-1]);
+    par::Mpi_Allgatherv<TreeNode>(local[t]->data(), localSize,
+        global[t]->data(), &(*sizes.begin()), &(*displs.begin()), comm);
+  }
+
+  std::vector<TreeNode> serialTree;
+  ot::SFC_Tree<T,dim>::locTreeConstruction(
+      &(*globalPoints.begin()), serialTree,
+      maxPtsPerRegion,
+      0, (ot::RankI) globalPoints.size(),
+      1, m_uiMaxDepth,
+      0,
+      TreeNode());
+
+  const bool success = (!err && serialTree == globalTree);
+  if (!rProc)
+    printf("[dim==%u] streamed distTreeConstruction (chunk %u): %d leaves, %s\n",
+        dim, (unsigned int) chunkSize, (int) globalTree.size(), (success ? "success" : "FAILED"));
+
+  _DestroyHcurve();
+}
+
+
 //------------------------
 // test_distTreeConstruction()
 //
@@ -347,8 +451,22 @@ int main(int argc, char* argv[])
     ptsPerProc = strtol(argv[1], NULL, 0);
 
   //test_locTreeConstruction(ptsPerProc);
+  int rProc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rProc);
+  if (!rProc)
+  {
+    test_locTreeConstructionThreads<2>(50 * ptsPerProc);
+    test_locTreeConstructionThreads<3>(50 * ptsPerProc);
+    test_locTreeConstructionThreads<4>(50 * ptsPerProc);
+  }
   test_distTreeConstruction(ptsPerProc, MPI_COMM_WORLD);  // Expected results: See note at definition.
 
+  test_distTreeConstructionStreamed<2>(ptsPerProc, 37);
+  test_distTreeConstructionStreamed<3>(ptsPerProc, 37);
+  test_distTreeConstructionStreamed<4>(ptsPerProc, 37);
+  test_distTreeConstructionStreamed<3>(ptsPerProc, 5);   // More rounds than chunk points.
+  test_distTreeConstructionStreamed<4>(ptsPerProc, 100 * ptsPerProc);
+
   MPI_Finalize();
 
   return 0;
@@ -104,6 +104,20 @@ void test_locTreeSort()
   std::cout << "-----------------------------\n"
       << (success ? "Success: No losses." : "FAILURE: Lost some TreeNodes.")
       << '\n';
+
+  // The comparators must agree with the sorted order.
+  int numMisordered = 0;
+  for (size_t ii = 0; ii + 1 < sortedPoints.size(); ii++)
+  {
+    const ot::SFC_CachedKey<T,dim> key(sortedPoints[ii+1]);
+    numMisordered += (sortedPoints[ii+1] < sortedPoints[ii])
+                   || (key.compare(sortedPoints[ii]) > 0)
+                   || ((sortedPoints[ii] < sortedPoints[ii+1]) != (key.compare(sortedPoints[ii]) < 0))
+                   || (key.lowerBound(sortedPoints.data(), sortedPoints.data() + sortedPoints.size())
+                       != &(*std::lower_bound(sortedPoints.begin(), sortedPoints.end(), sortedPoints[ii+1])));
+  }
+  std::cout << (numMisordered ? "FAILURE: Comparators disagree with locTreeSort()." : "Success: Comparators agree with locTreeSort().")
+      << " (" << numMisordered << ")\n";
 }
 //------------------------
 
@@ -337,6 +351,35 @@ void test_locTreeConstruction(int numPoints)
 
 
 
+//------------------------
+// test_firstDiffLevel()
+//------------------------
+template <typename T>
+void test_firstDiffLevel()
+{
+  const unsigned int dim = 3;
+  using TreeNode = ot::TreeNode<T,dim>;
+
+  // Points that first differ at each level, in each coordinate.
+  int numWrong = 0;
+  for (unsigned int lev = 1; lev <= m_uiMaxDepth; lev++)
+    for (int d = 0; d < dim; d++)
+    {
+      std::array<T,dim> coordsA, coordsB;
+      coordsA.fill(0);
+      coordsB.fill(0);
+      coordsB[d] = (T) 1 << (m_uiMaxDepth - lev);
+      const TreeNode a(coordsA, m_uiMaxDepth), b(coordsB, m_uiMaxDepth);
+      numWrong += (a.getFirstDiffLevel(b) != lev) + (b.getFirstDiffLevel(a) != lev);
+    }
+  numWrong += (TreeNode().getFirstDiffLevel(TreeNode()) != m_uiMaxDepth + 1);
+
+  std::cout << (numWrong ? "FAILURE: " : "Success: ") << "getFirstDiffLevel() with "
+      << 8*sizeof(T) << "-bit coordinates (" << numWrong << ")\n";
+}
+//------------------------
+
+
 int main(int argc, char* argv[])
 {
   MPI_Init(&argc, &argv);
@@ -347,6 +390,10 @@ int main(int argc, char* argv[])
 
   test_locTreeSort();
 
+  test_firstDiffLevel<unsigned int>();
+  test_firstDiffLevel<unsigned long>();
+  test_firstDiffLevel<uint64_t>();
+
   //test_distTreeSort(ptsPerProc, MPI_COMM_WORLD);
 
   //test_locTreeConstruction(ptsPerProc);
@@ -0,0 +1,266 @@
+/*
+ * testVtu.cpp
+ *   Test DA::vecTopvtu() and DA::vecToSingleFile() (io::vtk::cells2vtu(), io::vtk::cells2mpiio()).
+ *   A linear field is written in 2D, 3D and a 4D slice, and read back from the
+ *   appended data of each vtu piece and from the .bin file at the offsets listed
+ *   in the .json descriptor. Linear fields are exact on hanging nodes and slices.
+ */
+
+#include "oda.h"
+#include "treeNode.h"
+#include "tsort.h"
+#include "octUtils.h"
+#include "hcurvedata.h"
+#include "json.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+//------------------------
+// linearField()
+//------------------------
+double linearField(const double *x, unsigned int dim, unsigned int v)
+{
+  double u = 1.0 + v;
+  for (unsigned int d = 0; d < dim; d++)
+    u += (d + 1.0) * (v + 1.0) * x[d];
+  return u;
+}
+
+
+//------------------------
+// checkCells()
+//   Cells of level l span 2^-l; the point data is the field at the positions
+//   (4D: at x[3]==sliceCoord).
+//------------------------
+int checkCells(unsigned int dim, unsigned int cellDim, size_t numCells, double sliceCoord,
+               const double *positions, const unsigned int *levels, unsigned int dof, const double * const *values)
+{
+  const unsigned int numCorners = 1u << cellDim;
+  int numFailed = 0;
+  for (size_t c = 0; c < numCells; c++)
+  {
+    double lo = positions[3 * c * numCorners], hi = lo;
+    for (unsigned int k = 0; k < numCorners; k++)
+    {
+      const size_t pt = c * numCorners + k;
+      lo = fmin(lo, positions[3 * pt]);
+      hi = fmax(hi, positions[3 * pt]);
+
+      double x[4] = {positions[3 * pt + 0], positions[3 * pt + 1], positions[3 * pt + 2], sliceCoord};
+      for (unsigned int v = 0; v < dof; v++)
+        numFailed += (fabs(values[v][pt] - linearField(x, dim, v)) > 1e-10);
+    }
+    numFailed += (fabs((hi - lo) - ldexp(1.0, -(int) levels[c])) > 1e-12);
+  }
+  return numFailed;
+}
+
+
+//------------------------
+// readVtuArray()
+//   Raw appended data: a 32-bit byte count, then the bytes.
+//------------------------
+template <typename T>
+bool readVtuArray(const std::string &vtu, const std::string &name, std::vector<T> &out)
+{
+  const size_t arrayPos = vtu.find("Name=\"" + name + "\"");
+  const size_t dataPos = vtu.find("<AppendedData");
+  if (arrayPos == std::string::npos || dataPos == std::string::npos)
+    return false;
+  const long offset = strtol(vtu.c_str() + vtu.find("offset=\"", arrayPos) + 8, NULL, 10);
+  const size_t begin = vtu.find('_', dataPos) + 1 + offset;
+
+  uint32_t numBytes;
+  memcpy(&numBytes, vtu.data() + begin, sizeof(numBytes));
+  out.resize(numBytes / sizeof(T));
+  memcpy(out.data(), vtu.data() + begin + sizeof(numBytes), numBytes);
+  return true;
+}
+
+
+//------------------------
+// test_vtu()
+//------------------------
+template <unsigned int dim>
+int test_vtu(unsigned int numPts, double sliceCoord, MPI_Comm comm)
+{
+  using T = unsigned int;
+  constexpr unsigned int cellDim = (dim < 3 ? dim : 3);
+  constexpr unsigned int numCorners = 1u << cellDim;
+  const unsigned int dof = 2;
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<ot::TreeNode<T,dim>> points = ot::getPts<T,dim>(numPts);
+  std::vector<ot::TreeNode<T,dim>> tree;
+  ot::SFC_Tree<T,dim>::distTreeBalancing(points, tree, 1, 0.3, comm);
+
+  ot::DA<dim> da(tree.data(), tree.size(), comm, 1);
+
+  std::vector<double> local(dof * da.getLocalNodalSz());
+  const double domainScale = 1.0 / (1u << m_uiMaxDepth);
+  for (size_t ii = 0; ii < da.getLocalNodalSz(); ii++)
+  {
+    const ot::TreeNode<T,dim> &node = da.getTNCoords()[da.getLocalNodeBegin() + ii];
+    double x[dim];
+    for (unsigned int d = 0; d < dim; d++)
+      x[d] = domainScale * node.getX(d);
+    for (unsigned int v = 0; v < dof; v++)
+      local[dof * ii + v] = linearField(x, dim, v);
+  }
+
+  char name0[] = "u", name1[] = "w";
+  char *names[] = {name0, name1};
+  const std::string prefix = "tstVtu_" + std::to_string(dim) + "D";
+  const std::string singlePrefix = prefix + "_single";
+
+  int numFailed = 0;
+  unsigned long long numCells = 0, globCells = 0;
+
+  // vtu: each rank reads back its own piece.
+  da.vecTopvtu(local.data(), prefix.c_str(), names, false, false, dof, sliceCoord);
+  const std::string vtuName = prefix + "_" + std::to_string(da.getRankActive()) + "_" + std::to_string(da.getNpesActive()) + ".vtu";
+  if (da.isActive())
+  {
+    std::ifstream vtuFile(vtuName, std::ios::binary);
+    std::stringstream vtuStream;
+    vtuStream << vtuFile.rdbuf();
+    const std::string vtu = vtuStream.str();
+
+    const size_t piecePos = vtu.find("<Piece ");
+    numFailed += (piecePos == std::string::npos);
+    const unsigned long long numPoints = strtoull(vtu.c_str() + vtu.find("NumberOfPoints=\"", piecePos) + 16, NULL, 10);
+    numCells = strtoull(vtu.c_str() + vtu.find("NumberOfCells=\"", piecePos) + 15, NULL, 10);
+    numFailed += (numPoints != numCells * numCorners);
+
+#ifndef DENDRO_VTU_ZLIB
+    std::vector<double> positions, u, w;
+    std::vector<unsigned int> levels;
+    numFailed += !readVtuArray(vtu, "Position", positions);
+    numFailed += !readVtuArray(vtu, "cell_level", levels);
+    numFailed += !readVtuArray(vtu, "u", u);
+    numFailed += !readVtuArray(vtu, "w", w);
+    numFailed += (positions.size() != 3 * numPoints || levels.size() != numCells);
+    numFailed += (u.size() != numPoints || w.size() != numPoints);
+    if (!numFailed)
+    {
+      const double *values[] = {u.data(), w.data()};
+      numFailed += checkCells(dim, cellDim, numCells, sliceCoord, positions.data(), levels.data(), dof, values);
+    }
+#endif
+  }
+  MPI_Allreduce(&numCells, &globCells, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+
+  // Every element is a cell, except in 4D, where only the elements cut by the slice are.
+  unsigned long long numElements = tree.size(), globElements = 0;
+  MPI_Allreduce(&numElements, &globElements, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+  numFailed += (dim < 4 ? globCells != globElements : globCells == 0 || globCells >= globElements);
+
+  // Single file: rank 0 reads everything back through the json offsets.
+  numFailed += (da.vecToSingleFile(local.data(), singlePrefix.c_str(), names, false, false, dof, sliceCoord) != 0);
+  if (!rank)
+  {
+    std::ifstream jsonFile(singlePrefix + ".json");
+    nlohmann::json desc;
+    jsonFile >> desc;
+    numFailed += (desc["num_cells"].get<unsigned long long>() != globCells);
+    numFailed += (desc["num_points"].get<unsigned long long>() != globCells * numCorners);
+    unsigned long long sumRankCells = 0;
+    for (const auto &rankCells : desc["rank_cells"])
+      sumRankCells += rankCells.get<unsigned long long>();
+    numFailed += (sumRankCells != globCells);
+
+    FILE *bin = fopen((singlePrefix + ".bin").c_str(), "rb");
+    numFailed += (bin == NULL);
+    auto readArray = [&](const std::string &name, size_t entryBytes, std::vector<char> &out) {
+      for (const auto &array : desc["arrays"])
+        if (array["name"] == name)
+        {
+          const size_t numEntries = array["shape"][0].get<size_t>() * array["shape"][1].get<size_t>();
+          out.resize(numEntries * entryBytes);
+          fseek(bin, array["offset"].get<long>(), SEEK_SET);
+          return fread(out.data(), entryBytes, numEntries, bin) == numEntries;
+        }
+      return false;
+    };
+
+    if (bin != NULL)
+    {
+      std::vector<char> positions, connectivity, levels, u, w;
+      numFailed += !readArray("Position", sizeof(double), positions);
+      numFailed += !readArray("connectivity", sizeof(uint64_t), connectivity);
+      numFailed += !readArray("cell_level", sizeof(unsigned int), levels);
+      numFailed += !readArray("u", sizeof(double), u);
+      numFailed += !readArray("w", sizeof(double), w);
+      fclose(bin);
+
+      const size_t numPoints = globCells * numCorners;
+      numFailed += (positions.size() != 3 * numPoints * sizeof(double));
+      numFailed += (connectivity.size() != numPoints * sizeof(uint64_t));
+      numFailed += (levels.size() != globCells * sizeof(unsigned int));
+      numFailed += (u.size() != numPoints * sizeof(double) || w.size() != numPoints * sizeof(double));
+      if (!numFailed)
+      {
+        for (size_t ii = 0; ii < numPoints; ii++)
+          numFailed += (((const uint64_t *) connectivity.data())[ii] != ii);
+        const double *values[] = {(const double *) u.data(), (const double *) w.data()};
+        numFailed += checkCells(dim, cellDim, globCells, sliceCoord,
+            (const double *) positions.data(), (const unsigned int *) levels.data(), dof, values);
+      }
+    }
+  }
+
+  int globFailed = 0;
+  MPI_Allreduce(&numFailed, &globFailed, 1, MPI_INT, MPI_SUM, comm);
+
+  // Clean up.
+  remove(vtuName.c_str());
+  MPI_Barrier(comm);
+  if (!rank)
+  {
+    remove((prefix + ".pvtu").c_str());
+    for (const char *ext : {".bin", ".json", ".xmf"})
+      remove((singlePrefix + ext).c_str());
+
+    printf("dim %u (slice %.2f): %llu cells of %llu elements, %s\n",
+        dim, sliceCoord, globCells, globElements, (globFailed ? "FAILED" : "succeeded"));
+  }
+
+  return (globFailed != 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  m_uiMaxDepth = 6;
+  int numFailed = 0;
+
+  _InitializeHcurve(2);
+  numFailed += test_vtu<2>(200, 0.0, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(3);
+  numFailed += test_vtu<3>(200, 0.0, comm);
+  _DestroyHcurve();
+
+  _InitializeHcurve(4);
+  numFailed += test_vtu<4>(100, 0.3, comm);
+  numFailed += test_vtu<4>(100, 1.0, comm);
+  _DestroyHcurve();
+
+  MPI_Finalize();
+  return (numFailed != 0);
+}